@@ -0,0 +1,128 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fcli/progress.hpp"
+#include "harness.hpp"
+
+using namespace fcli;
+using namespace std;
+using namespace chrono;
+
+namespace {
+  // Each N-th operation is timed to keep the clock overhead low.
+  constexpr size_t SAMPLE_PERIOD = 8U;
+
+  /*
+   * Threads update a progress that is drawn by its own thread until
+   * min_time passes. Operation time is the wall time divided by number of
+   * operations of one thread, so it grows with contention.
+   */
+  auto run_threads(string t_name, unsigned t_threads,
+      const function<void(Progress&, size_t)>& t_operation) -> bench::Result {
+    bench::CountingBuf buffer;
+    ostream stream(&buffer);
+    Progress progress("Contention", true, stream);
+    progress.show();
+
+    atomic<bool> stop{};
+    atomic<size_t> operations{};
+    // Threads share the default capacity.
+    vector<bench::Samples> samples;
+    samples.reserve(t_threads);
+    for (unsigned i = 0U; i != t_threads; ++i) {
+      samples.emplace_back(bench::Samples::DEFAULT_CAPACITY / t_threads);
+    }
+    vector<thread> threads;
+
+    const auto allocations_before = bench::allocations.load();
+    const auto start = steady_clock::now();
+    for (unsigned i = 0U; i != t_threads; ++i) {
+      threads.emplace_back([&, i] {
+        size_t count = 0U;
+        for (; !stop.load(memory_order_relaxed); ++count) {
+          if (count % SAMPLE_PERIOD != 0U) {
+            t_operation(progress, count);
+            continue;
+          }
+          const auto operation_start = steady_clock::now();
+          t_operation(progress, count);
+          samples[i].add(static_cast<double>(duration_cast<nanoseconds>(
+              steady_clock::now() - operation_start).count()));
+        }
+        operations += count;
+      });
+    }
+
+    this_thread::sleep_for(bench::min_time);
+    stop = true;
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    const auto elapsed = steady_clock::now() - start;
+    const auto allocations = bench::allocations.load() - allocations_before;
+    progress.hide();
+
+    vector<double> all_samples;
+    for (auto& thread_samples : samples) {
+      all_samples.insert(all_samples.end(),
+          thread_samples.get().cbegin(), thread_samples.get().cend());
+    }
+    const auto count = static_cast<double>(operations.load());
+    bench::Result result{move(t_name),
+        static_cast<double>(duration_cast<nanoseconds>(elapsed).count()) *
+        t_threads / count, static_cast<double>(allocations) / count, {}};
+    result.metrics["threads"] = t_threads;
+    result.metrics["ops_per_second"] =
+        count / duration<double>(elapsed).count();
+    result.metrics["p50_ns"] = bench::percentile(all_samples, 50.0);
+    result.metrics["p99_ns"] = bench::percentile(all_samples, 99.0);
+    return result;
+  }
+} // Namespace.
+
+void bench::run_contention(vector<Result>& t_results) {
+  for (const unsigned threads : {1U, 2U, 4U, 8U, 16U, 32U, 64U}) {
+    const auto suffix = "/threads:" + to_string(threads);
+
+    if (const auto name = "progress/contention/set_percents" + suffix;
+        is_selected(name)) {
+      t_results.push_back(run_threads(name, threads,
+          [] (Progress& t_progress, size_t t_count) {
+            t_progress.set_percents(static_cast<double>(t_count % 100U));
+          }));
+    }
+    if (const auto name = "progress/contention/increment" + suffix;
+        is_selected(name)) {
+      t_results.push_back(run_threads(name, threads,
+          [] (Progress& t_progress, size_t t_count) {
+            if (t_count % 100U == 0U) {
+              t_progress = 0.0;
+            } else {
+              ++t_progress;
+            }
+          }));
+    }
+  }
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "fcli/fuzzy_matcher.hpp"
+#include "harness.hpp"
+
+using namespace fcli;
+using namespace std;
+using namespace chrono;
+
+namespace {
+  constexpr size_t CANDIDATES_COUNT = 1'000'000U;
+
+  // Host names with a pseudo-random number.
+  auto make_candidates() {
+    vector<string> candidates;
+    candidates.reserve(CANDIDATES_COUNT);
+    for (size_t i = 0U; i != CANDIDATES_COUNT; ++i) {
+      candidates.push_back("host-" + to_string(i * 7919U % 1'000'003U) +
+          ".region-" + to_string(i % 17U) + ".example.com");
+    }
+    return candidates;
+  }
+} // Namespace.
+
+void bench::run_fuzzy(vector<Result>& t_results) {
+  const string names[] = {"fuzzy/query/fresh", "fuzzy/query/append"};
+  if (!is_selected(names[0]) && !is_selected(names[1])) {
+    return;
+  }
+  FuzzyMatcher matcher(make_candidates());
+
+  // Each query is unrelated to the previous one, so all candidates are
+  // scored.
+  if (is_selected(names[0])) {
+    size_t i = 0U;
+    t_results.push_back(measure_latency(names[0], [&matcher, &i] {
+      matcher.set_query(++i % 2U == 0U ? "h12" : "x4");
+    }));
+  }
+
+  // Typing of a query, each keystroke checks the previous matches only.
+  if (is_selected(names[1])) {
+    constexpr string_view QUERY = "h12r7ex";
+    Samples samples;
+    auto result = measure(names[1], [&matcher, &samples, QUERY] {
+      matcher.set_query({});
+      for (size_t length = 1U; length <= QUERY.size(); ++length) {
+        const auto start = steady_clock::now();
+        matcher.set_query(QUERY.substr(0U, length));
+        samples.add(static_cast<double>(
+            duration_cast<nanoseconds>(steady_clock::now() - start).count()));
+      }
+    });
+    result.ns_per_op /= static_cast<double>(QUERY.size());
+    result.metrics["p50_ns"] = percentile(samples.get(), 50.0);
+    result.metrics["p99_ns"] = percentile(samples.get(), 99.0);
+    result.metrics["candidates"] = static_cast<double>(CANDIDATES_COUNT);
+    t_results.push_back(result);
+  }
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal benchmark harness without dependencies.
+namespace bench {
+  struct Result {
+    std::string name;
+    double ns_per_op{};
+    double allocs_per_op{};
+    // Additional metrics, for example, latency percentiles or throughput.
+    std::map<std::string, double> metrics;
+  };
+
+  // Counted by the replaced global operator new.
+  inline std::atomic<std::size_t> allocations;
+  // Each measurement runs at least this time.
+  inline std::chrono::milliseconds min_time{200};
+  // Only benchmarks whose names contain it are run.
+  inline std::string filter;
+
+  [[nodiscard]] inline auto is_selected(const std::string& name)
+      { return name.find(filter) != std::string::npos; }
+
+  // Stream buffer that discards output and counts its bytes.
+  class CountingBuf: public std::streambuf {
+  public:
+    [[nodiscard]] inline auto get_bytes() const { return m_bytes; }
+
+  protected:
+    inline auto overflow(int_type c) -> int_type override {
+      ++m_bytes;
+      return traits_type::not_eof(c);
+    }
+    inline auto xsputn(const char_type*, std::streamsize size)
+        -> std::streamsize override {
+      m_bytes += static_cast<std::size_t>(size);
+      return size;
+    }
+
+  private:
+    std::size_t m_bytes{};
+  };
+
+  // Value at the percentile (from 0 to 100) of unsorted samples.
+  [[nodiscard]] inline auto percentile(std::vector<double>& samples,
+      double percents) -> double {
+    if (samples.empty()) {
+      return 0.0;
+    }
+    const auto index = std::min(samples.size() - 1U, static_cast<std::size_t>(
+        static_cast<double>(samples.size()) * percents / 100.0));
+    std::nth_element(samples.begin(), samples.begin() +
+        static_cast<std::ptrdiff_t>(index), samples.end());
+    return samples[index];
+  }
+
+  /*
+   * Latency samples allocated before a measurement, so adding them isn't
+   * counted or timed. When it's full, the oldest samples are replaced.
+   */
+  class Samples {
+  public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 1024U * 1024U;
+
+    explicit Samples(std::size_t capacity = DEFAULT_CAPACITY):
+        m_capacity(std::max<std::size_t>(capacity, 1U))
+        { m_samples.reserve(m_capacity); }
+
+    inline void add(double sample) {
+      if (m_samples.size() != m_capacity) {
+        m_samples.push_back(sample);
+      } else {
+        m_samples[m_next++ % m_capacity] = sample;
+      }
+    }
+    [[nodiscard]] inline auto get() -> std::vector<double>&
+        { return m_samples; }
+
+  private:
+    std::size_t m_capacity, m_next{};
+    std::vector<double> m_samples;
+  };
+
+  /*
+   * Runs the function with doubling number of iterations until a run takes
+   * at least min_time. Result is taken from the last run.
+   */
+  template<class Function>
+  auto measure(std::string name, Function&& function) -> Result {
+    using namespace std::chrono;
+    for (std::size_t iterations = 1U;; iterations *= 2U) {
+      const auto allocations_before = allocations.load();
+      const auto start = steady_clock::now();
+      for (std::size_t i = 0U; i != iterations; ++i) {
+        function();
+      }
+      const auto elapsed = steady_clock::now() - start;
+
+      if (elapsed >= min_time) {
+        const auto count = static_cast<double>(iterations);
+        return {std::move(name),
+            static_cast<double>(duration_cast<nanoseconds>(elapsed).count()) /
+            count,
+            static_cast<double>(allocations.load() - allocations_before) /
+            count, {}};
+      }
+    }
+  }
+
+  /*
+   * Same as measure, but also times each call separately and
+   * adds p50 and p99 latencies (in nanoseconds) to metrics.
+   */
+  template<class Function>
+  auto measure_latency(std::string name, Function&& function) -> Result {
+    using namespace std::chrono;
+    Samples samples;
+    auto result = measure(std::move(name), [&function, &samples] {
+      const auto start = steady_clock::now();
+      function();
+      samples.add(static_cast<double>(
+          duration_cast<nanoseconds>(steady_clock::now() - start).count()));
+    });
+    result.metrics["p50_ns"] = percentile(samples.get(), 50.0);
+    result.metrics["p99_ns"] = percentile(samples.get(), 99.0);
+    return result;
+  }
+
+  // Each group appends its results.
+  void run_text(std::vector<Result>&);
+  void run_progress(std::vector<Result>&);
+  void run_contention(std::vector<Result>&);
+  void run_fuzzy(std::vector<Result>&);
+  void run_table(std::vector<Result>&);
+} // Namespace bench.
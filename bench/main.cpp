@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Runs benchmarks and prints results in JSON.
+ * Usage: bench [--quick] [FILTER]
+ * Only benchmarks whose names contain the filter are run. The --quick
+ * option shortens measurements for smoke runs.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string_view>
+
+#include "harness.hpp"
+
+using namespace std;
+
+/*
+ * Allocations counting.
+ */
+
+auto operator new(size_t t_size) -> void* {
+  ++bench::allocations;
+  if (void* pointer = malloc(t_size == 0U ? 1U : t_size)) {
+    return pointer;
+  }
+  throw bad_alloc();
+}
+
+auto operator new[](size_t t_size) -> void* {
+  return operator new(t_size);
+}
+
+void operator delete(void* t_pointer) noexcept {
+  free(t_pointer);
+}
+
+void operator delete[](void* t_pointer) noexcept {
+  free(t_pointer);
+}
+
+void operator delete(void* t_pointer, size_t /* Unused. */) noexcept {
+  free(t_pointer);
+}
+
+void operator delete[](void* t_pointer, size_t /* Unused. */) noexcept {
+  free(t_pointer);
+}
+
+// Used for over-aligned types, e.g. workers aligned to cache lines.
+auto operator new(size_t t_size, align_val_t t_alignment) -> void* {
+  ++bench::allocations;
+  const auto alignment = static_cast<size_t>(t_alignment);
+  // Size must be a multiple of the alignment.
+  const auto size = (max<size_t>(t_size, 1U) + alignment - 1U) /
+      alignment * alignment;
+  if (void* pointer = aligned_alloc(alignment, size)) {
+    return pointer;
+  }
+  throw bad_alloc();
+}
+
+auto operator new[](size_t t_size, align_val_t t_alignment) -> void* {
+  return operator new(t_size, t_alignment);
+}
+
+void operator delete(void* t_pointer, align_val_t /* Unused. */) noexcept {
+  free(t_pointer);
+}
+
+void operator delete[](void* t_pointer, align_val_t /* Unused. */) noexcept {
+  free(t_pointer);
+}
+
+void operator delete(void* t_pointer, size_t /* Unused. */,
+    align_val_t /* Unused. */) noexcept {
+  free(t_pointer);
+}
+
+void operator delete[](void* t_pointer, size_t /* Unused. */,
+    align_val_t /* Unused. */) noexcept {
+  free(t_pointer);
+}
+
+namespace {
+  void print_json(const vector<bench::Result>& t_results) {
+    cout << "{\n  \"benchmarks\": [";
+    bool first = true;
+    for (const auto& result : t_results) {
+      cout << (first ? "" : ",") << "\n    {\"name\": \"" << result.name
+          << "\", \"ns_per_op\": " << result.ns_per_op
+          << ", \"allocs_per_op\": " << result.allocs_per_op;
+      for (const auto& [name, value] : result.metrics) {
+        cout << ", \"" << name << "\": " << value;
+      }
+      cout << '}';
+      first = false;
+    }
+    cout << "\n  ]\n}" << endl;
+  }
+} // Namespace.
+
+auto main(int t_argc, char* t_argv[]) -> int {
+  using namespace chrono_literals;
+
+  for (int i = 1; i < t_argc; ++i) {
+    const string_view arg = t_argv[i];
+    if (arg == "--quick") {
+      bench::min_time = 10ms;
+    } else {
+      bench::filter = arg;
+    }
+  }
+
+  vector<bench::Result> results;
+  bench::run_text(results);
+  bench::run_progress(results);
+  bench::run_contention(results);
+  bench::run_fuzzy(results);
+  bench::run_table(results);
+  print_json(results);
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ostream>
+#include <string>
+
+#include "fcli/progress.hpp"
+#include "fcli/virtual_clock.hpp"
+#include "harness.hpp"
+
+using namespace fcli;
+using namespace std;
+using namespace chrono_literals;
+
+void bench::run_progress(vector<Result>& t_results) {
+  constexpr unsigned short WIDTH = 80U;
+
+  for (const bool determined : {true, false}) {
+    const auto name = string("progress/build_frame/") +
+        (determined ? "determined" : "undetermined");
+    if (!is_selected(name)) {
+      continue;
+    }
+
+    CountingBuf buffer;
+    ostream stream(&buffer);
+    VirtualClock clock;
+    Progress progress("Building frames of the progress", determined, stream);
+    progress.set_width(WIDTH);
+    progress.set_clock(clock.get_function());
+
+    double percents = 0.0;
+    t_results.push_back(measure_latency(name, [&] {
+      clock.advance(50ms);
+      progress = percents = percents >= 100.0 ? 0.0 : percents + 0.1;
+      auto frame = progress.render_frame();
+    }));
+  }
+
+  // Frames printed by the external driver, including erasing.
+  if (const string name = "progress/render/determined"; is_selected(name)) {
+    CountingBuf buffer;
+    ostream stream(&buffer);
+    VirtualClock clock;
+    Progress progress("Printing frames of the progress", true, stream);
+    progress.set_width(WIDTH);
+    progress.set_clock(clock.get_function());
+    progress.set_driver(Progress::Driver::EXTERNAL);
+    progress.show();
+
+    size_t frames = 0U;
+    double percents = 0.0;
+    auto result = measure(name, [&] {
+      clock.advance(50ms);
+      progress = percents = percents >= 100.0 ? 0.0 : percents + 0.1;
+      frames += progress.step(clock.now()) ? 1U : 0U;
+    });
+    progress.hide();
+
+    const auto bytes_per_frame = static_cast<double>(buffer.get_bytes()) /
+        static_cast<double>(frames);
+    result.metrics["bytes_per_frame"] = bytes_per_frame;
+    result.metrics["bytes_per_second"] =
+        bytes_per_frame / result.ns_per_op * 1e9;
+    t_results.push_back(result);
+  }
+}
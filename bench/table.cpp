@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ostream>
+#include <string>
+
+#include "fcli/table.hpp"
+#include "harness.hpp"
+
+using namespace fcli;
+using namespace std;
+
+void bench::run_table(vector<Result>& t_results) {
+  // Plain cells and cells with a style of the column.
+  for (const bool styled : {false, true}) {
+    const auto name = "table/row/styled:" + to_string(styled);
+    if (!is_selected(name)) {
+      continue;
+    }
+    CountingBuf buf;
+    ostream stream(&buf);
+    Table table({
+      {"Host", styled ? "~c~" : "", Table::Alignment::LEFT, 0U, 0U},
+      {"Requests", {}, Table::Alignment::RIGHT, 0U, 0U},
+      {"State", styled ? "<b>" : "", Table::Alignment::CENTER, 0U, 0U}
+    }, stream, Terminal::ColorsSupport::HAS_256_COLORS);
+
+    size_t i = 0U;
+    auto result = measure(name, [&table, &i] {
+      ++i;
+      table.add_row({"host-42.example.com", i % 7U == 0U ? "1024" : "7",
+          i % 10U == 0U ? "failed" : "ok"});
+    });
+    table.flush();
+    result.metrics["bytes_per_row"] =
+        static_cast<double>(buf.get_bytes()) / static_cast<double>(i);
+    t_results.push_back(result);
+  }
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include "fcli/text.hpp"
+#include "harness.hpp"
+
+using namespace fcli;
+using namespace std;
+
+namespace {
+  /*
+   * Words of the given total size, each word after the specifier period
+   * is wrapped in a style specifier. Zero period means no specifiers.
+   */
+  auto make_input(size_t t_size, size_t t_specifier_period) -> string {
+    string result;
+    for (size_t word = 0U; result.size() < t_size; ++word) {
+      if (t_specifier_period != 0U && word % t_specifier_period == 0U) {
+        result += "<b>word~r~ ";
+      } else {
+        result += "word ";
+      }
+    }
+    result.resize(t_size);
+    return result;
+  }
+} // Namespace.
+
+void bench::run_text(vector<Result>& t_results) {
+  for (const size_t size : {64U, 1024U, 16U * 1024U}) {
+    // No specifiers, each tenth word and each second word.
+    for (const size_t period : {0U, 10U, 2U}) {
+      const auto name = "text/format/size:" + to_string(size) +
+          "/specifier_period:" + to_string(period);
+      if (!is_selected(name)) {
+        continue;
+      }
+      const auto input = make_input(size, period);
+      auto result = measure(name, [&input] {
+        auto copy = Text::format_copy(input,
+            Terminal::ColorsSupport::HAS_256_COLORS);
+      });
+      result.metrics["bytes_per_second"] =
+          static_cast<double>(size) / result.ns_per_op * 1e9;
+      t_results.push_back(result);
+    }
+  }
+
+  for (const auto& [label, input] : {pair<string, string>{"ascii",
+      string(1024U, 'a')}, {"unicode", make_input(256U, 0U) +
+      "中文 é\U0001F600 \033[1mbold\033[0m"}}) {
+    const auto name = "text/visible_width/" + label;
+    if (!is_selected(name)) {
+      continue;
+    }
+    auto result = measure(name, [&input = input] {
+      volatile auto width = Text::visible_width(input);
+      (void)width;
+    });
+    result.metrics["bytes_per_second"] =
+        static_cast<double>(input.size()) / result.ns_per_op * 1e9;
+    t_results.push_back(result);
+  }
+}
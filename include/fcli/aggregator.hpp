@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "internal/live_area.hpp"
+#include "progress.hpp"
+
+namespace fcli {
+  /*
+   * Displays progresses of other processes (see RemoteProgress) that are
+   * received through pipes or sockets. Reads are batched using epoll and
+   * progresses are redrawn no more often than RENDER_INTERVAL, so even a lot
+   * of updates per second are cheap. Active progresses are displayed at the
+   * bottom of the output and results are printed above them.
+   *
+   * Not thread-safe: all functions should be called from the same thread.
+   */
+  class Aggregator {
+  public:
+    explicit Aggregator(unsigned short width, std::ostream& = std::cout);
+    // Closes all sources and erases progresses.
+    ~Aggregator();
+
+    Aggregator(const Aggregator&) = delete;
+    auto operator=(const Aggregator&) -> Aggregator& = delete;
+    Aggregator(Aggregator&&) = delete;
+    auto operator=(Aggregator&&) -> Aggregator& = delete;
+
+    /*
+     * Pass OPENED file descriptor of the reading side. It's switched to the
+     * non-blocking mode and closed when the writing side is closed.
+     * Unfinished progresses of a closed source are considered failed.
+     */
+    void add_source(int in_file_desc);
+    /*
+     * Waits for updates no longer than the timeout, applies them and redraws
+     * progresses if needed. Returns false if there are no sources left.
+     */
+    auto poll(std::chrono::milliseconds timeout) -> bool;
+    // Polls until all sources are closed.
+    void run();
+
+    // Called for each new progress, for example, to change its styles.
+    inline void set_create_handler(std::function<void(Progress&)> handler)
+        { m_create_handler = std::move(handler); }
+    [[nodiscard]] inline auto get_sources_count() const
+        { return m_sources.size(); }
+    [[nodiscard]] inline auto get_progresses_count() const
+        { return m_progresses.size(); }
+
+  private:
+    // Returns false if source is closed.
+    auto read_source(int file_desc, std::string& buffer) -> bool;
+    void apply_messages(int file_desc, std::string& buffer);
+    void close_source(int file_desc);
+    void draw();
+
+    unsigned short m_width;
+    std::ostream& m_ostream;
+    int m_epoll_file_desc;
+
+    // Unparsed data of each source.
+    std::map<int, std::string> m_sources;
+    // Key is source descriptor and process and progress identifiers.
+    std::map<std::pair<int, std::uint64_t>, std::unique_ptr<Progress>>
+        m_progresses;
+    // Formatted results that are not printed yet.
+    std::vector<std::string> m_results;
+    std::function<void(Progress&)> m_create_handler;
+
+    std::vector<char> m_read_buffer;
+    internal::LiveArea m_live_area;
+    std::chrono::steady_clock::time_point m_next_draw{};
+    bool m_draw_requested{};
+
+    static constexpr std::chrono::milliseconds RENDER_INTERVAL{50};
+    static constexpr std::size_t READ_BUFFER_SIZE = 64U * 1024U;
+    static constexpr int MAX_EVENTS = 64;
+  };
+} // Namespace fcli.
@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+#include "progress.hpp"
+
+namespace fcli {
+  /*
+   * Publishes attached progresses into a memory-mapped file, so they can be
+   * watched from another process (for example, by the fcli-top tool). Each
+   * progress has its own slot that is updated on every frame using a
+   * seqlock: writers never wait for readers.
+   */
+  class Exporter {
+  public:
+    // Published information about a progress.
+    struct Record {
+      pid_t pid;
+      std::string text;
+      double percents;
+      bool determined;
+      // Percents per second.
+      double rate;
+      Progress::State state;
+      // Time of the last update since the epoch of the system clock.
+      std::chrono::milliseconds updated;
+    };
+
+    class format_error : public std::exception {
+    public:
+      [[nodiscard]] inline auto what() const noexcept -> const char* override
+          { return "invalid format of the exported progresses file"; }
+    };
+
+    // File is created or truncated. It's removed by the destructor.
+    explicit Exporter(std::string path = get_default_path(),
+        std::size_t slots = DEFAULT_SLOTS);
+    // Attached progresses must be detached or destroyed before.
+    ~Exporter();
+
+    Exporter(const Exporter&) = delete;
+    auto operator=(const Exporter&) -> Exporter& = delete;
+    Exporter(Exporter&&) = delete;
+    auto operator=(Exporter&&) -> Exporter& = delete;
+
+    // Throws out_of_range if all slots are used.
+    void attach(Progress&);
+    void detach(Progress&);
+
+    [[nodiscard]] inline auto get_path() const { return m_path; }
+
+    // Reads all used slots of a file. Never waits for writers.
+    [[nodiscard]] static auto read(const std::string& path) ->
+        std::vector<Record>;
+    // File in the shared memory directory with the process identifier.
+    [[nodiscard]] static auto get_default_path() -> std::string;
+    // Prefix of default paths, used to find files of all processes.
+    static constexpr std::string_view DEFAULT_PATH_PREFIX = "/dev/shm/fcli-";
+    static constexpr std::size_t DEFAULT_SLOTS = 64U;
+
+  private:
+    static constexpr std::size_t MAX_TEXT_SIZE = 255U;
+
+    struct Header {
+      std::uint32_t magic;
+      std::uint32_t version;
+      std::uint32_t slots;
+      std::uint32_t slot_size;
+    };
+
+    struct Slot {
+      // Odd while the slot is being written.
+      std::atomic<std::uint32_t> sequence;
+      std::uint32_t used;
+      std::int32_t pid;
+      std::uint32_t state;
+      std::uint32_t determined;
+      std::uint32_t text_size;
+      double percents;
+      double rate;
+      std::int64_t updated_ms;
+      char text[MAX_TEXT_SIZE];
+    };
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+        "atomics in the shared memory must be lock-free");
+
+    // Writer-side state of an attached progress.
+    struct Entry {
+      Slot* slot;
+      std::size_t handler_id;
+      // Used to calculate rate.
+      double rate_percents;
+      std::chrono::steady_clock::time_point rate_time;
+      double rate;
+    };
+
+    void publish(Entry&, const Progress::Snapshot&);
+    [[nodiscard]] auto get_slot(std::size_t index) const -> Slot*;
+
+    std::string m_path;
+    std::size_t m_slots;
+    std::size_t m_size;
+    void* m_data;
+
+    // Guards entries and slot allocation.
+    std::mutex m_mut;
+    std::map<const Progress*, Entry> m_entries;
+
+    // "FCLI" in little-endian.
+    static constexpr std::uint32_t MAGIC = 0x494C4346U;
+    static constexpr std::uint32_t VERSION = 1U;
+    // Minimum time between rate calculations.
+    static constexpr std::chrono::milliseconds RATE_INTERVAL{250};
+    // Weight of a new rate sample.
+    static constexpr double RATE_SMOOTHING = 0.3;
+  };
+} // Namespace fcli.
@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fcli {
+  /*
+   * Fuzzy matching of a query against a large list of candidates: query
+   * characters should appear in a candidate in the same order. Candidates
+   * are scored by matches at word boundaries, consecutive matches and gaps.
+   * Query is case-insensitive unless it contains uppercase letters.
+   *
+   * Each candidate has a bitmask of its characters, so most candidates are
+   * rejected without scanning. If the query extends the previous one, only
+   * the previous matches are checked. Large lists are scored on all cores,
+   * each chunk keeps a heap of its best matches, so only the top is sorted.
+   */
+  class FuzzyMatcher {
+  public:
+    struct Match {
+      std::size_t index;
+      int score;
+    };
+
+    explicit FuzzyMatcher(const std::vector<std::string>& candidates);
+
+    void set_query(std::string_view);
+    /*
+     * Returns positions of the matched bytes in the candidate, which are
+     * empty if it doesn't match the query.
+     */
+    [[nodiscard]] auto get_positions(std::size_t index) const ->
+        std::vector<std::size_t>;
+
+    /*
+     * Getters / setters.
+     */
+
+    [[nodiscard]] inline auto get_query() const -> const std::string&
+        { return m_query; }
+    [[nodiscard]] inline auto get_candidates_count() const
+        { return m_offsets.size() - 1U; }
+    [[nodiscard]] inline auto get_candidate(std::size_t index) const {
+      return std::string_view(m_data).substr(m_offsets[index],
+          m_offsets[index + 1U] - m_offsets[index]);
+    }
+    [[nodiscard]] inline auto get_matches_count() const
+        { return m_query.empty() ? get_candidates_count() : m_matches.size(); }
+    /*
+     * Best matches from the best one. Ties are ordered by length of
+     * candidates and their indices. For the empty query, candidates go in
+     * the original order.
+     */
+    [[nodiscard]] inline auto get_top() const -> const std::vector<Match>&
+        { return m_top; }
+
+    [[nodiscard]] inline auto get_top_count() const { return m_top_count; }
+    void set_top_count(std::size_t);
+
+    static constexpr std::size_t DEFAULT_TOP_COUNT = 100U;
+
+  private:
+    // Returns false if the candidate doesn't match the query.
+    auto score(std::size_t index, int& score,
+        std::vector<std::size_t>* positions = nullptr) const -> bool;
+    // Whether the first match should be shown above the second one.
+    [[nodiscard]] auto is_better(const Match&, const Match&) const -> bool;
+    void push_top(std::vector<Match>& heap, const Match&) const;
+    void select_top();
+    // Sorts the best matches of chunks and keeps the top of them.
+    void merge_tops(const std::vector<std::vector<Match>>& chunk_tops);
+
+    // Candidates are stored contiguously, also in lowercase to search query
+    // characters with memchr.
+    std::string m_data, m_folded_data;
+    std::vector<std::size_t> m_offsets{0U};
+    std::vector<std::uint64_t> m_masks;
+
+    std::string m_query;
+    // Lowercase, if the query is case-insensitive.
+    std::string m_folded_query;
+    std::uint64_t m_query_mask{};
+    bool m_case_sensitive{};
+
+    // Indices of matches of the non-empty query in ascending order.
+    std::vector<std::uint32_t> m_matches;
+    std::vector<Match> m_top;
+    std::size_t m_top_count{DEFAULT_TOP_COUNT};
+
+    // Smaller lists are scored on the calling thread.
+    static constexpr std::size_t PARALLEL_THRESHOLD = 32U * 1024U;
+  };
+} // Namespace fcli.
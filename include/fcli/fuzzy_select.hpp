@@ -0,0 +1,95 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fuzzy_matcher.hpp"
+#include "input.hpp"
+#include "palette.hpp"
+#include "screen.hpp"
+#include "terminal.hpp"
+#include "theme.hpp"
+
+namespace fcli {
+  /*
+   * Interactive prompt to choose one of candidates by typing a part of it
+   * (see FuzzyMatcher). The query is on the first row of a screen, the
+   * number of matches is on the second one and the best matches fill the
+   * rest, so only the visible ones are sorted and highlighted.
+   *
+   * Keys: arrows, Ctrl+P / Ctrl+N and page keys move the selection, Ctrl+U
+   * clears the query, Enter chooses, Escape and Ctrl+C cancel.
+   */
+  class FuzzySelect {
+  public:
+    explicit FuzzySelect(const std::vector<std::string>& candidates,
+        const std::optional<Terminal::ColorsSupport>& =
+            Terminal::get_cached_colors_support(),
+        const Palette& = Theme::get_palette());
+
+    /*
+     * Handles events of the input and redraws the screen until a candidate
+     * is chosen or the prompt is cancelled (also by Input::stop). Returns
+     * index of the chosen candidate.
+     */
+    auto run(Input&, Screen&) -> std::optional<std::size_t>;
+    // Returns false if a candidate is chosen or the prompt is cancelled.
+    auto handle(const Input::Event&) -> bool;
+    // Draws the whole screen, call Screen::present after it.
+    void draw(Screen&);
+
+    /*
+     * Getters / setters.
+     */
+
+    // Index of the selected candidate, if there are matches.
+    [[nodiscard]] auto get_selected() const -> std::optional<std::size_t>;
+    [[nodiscard]] inline auto is_chosen() const { return m_chosen; }
+    [[nodiscard]] inline auto is_cancelled() const { return m_cancelled; }
+
+    [[nodiscard]] inline auto get_query() const -> const std::string&
+        { return m_matcher.get_query(); }
+    void set_query(std::string_view);
+
+    [[nodiscard]] inline auto get_prompt() const { return m_prompt; }
+    inline void set_prompt(std::string_view prompt) { m_prompt = prompt; }
+
+    [[nodiscard]] inline auto get_matcher() const -> const FuzzyMatcher&
+        { return m_matcher; }
+
+  private:
+    void move_selection(long offset);
+    // Extends the top of the matcher to the visible matches.
+    void extend_top();
+
+    FuzzyMatcher m_matcher;
+    std::string m_prompt{"> "};
+    // Position of the selected match and the first visible one in the top.
+    std::size_t m_selection{}, m_offset{};
+    // Rows of matches on the last drawn screen.
+    unsigned short m_rows{1U};
+    bool m_chosen{}, m_cancelled{};
+
+    std::string m_match_style, m_selection_style, m_info_style, m_reset_style;
+  };
+} // Namespace fcli.
@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <termios.h>
+#include <unistd.h>
+
+#include "terminal.hpp"
+
+namespace fcli {
+  namespace internal {
+    class InputDecoder;
+  } // Namespace internal.
+
+  /*
+   * Reads keys, pasted text and mouse events from a terminal. The terminal
+   * is switched to the raw mode while an instance exists, so signals aren't
+   * generated by keys (Ctrl+C is delivered as an event) and input isn't
+   * echoed. Waiting is done with epoll, so there is no busy polling.
+   *
+   * Not thread-safe, except the stop function.
+   */
+  class Input {
+  public:
+    enum class Key {
+      CHARACTER, ENTER, TAB, BACKSPACE, ESCAPE,
+      UP, DOWN, RIGHT, LEFT, HOME, END, PAGE_UP, PAGE_DOWN, INSERT, DELETE,
+      F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12,
+      // Text is in the text field of an event.
+      PASTE,
+      // See the mouse field of an event.
+      MOUSE,
+      // Unrecognized escape sequence.
+      UNKNOWN
+    };
+
+    // Flags of the modifiers field.
+    static constexpr std::uint8_t
+        SHIFT = 1U << 0U,
+        ALT = 1U << 1U,
+        CTRL = 1U << 2U;
+
+    struct Mouse {
+      enum class Action {
+        PRESS, RELEASE, MOVE, SCROLL_UP, SCROLL_DOWN
+      };
+
+      Action action{};
+      // Zero is the left button, one is the middle and two is the right.
+      std::uint8_t button{};
+      // Zero-based cell coordinates.
+      unsigned short x{}, y{};
+    };
+
+    struct Event {
+      Key key{};
+      // Character of the CHARACTER key.
+      char32_t code_point{};
+      std::uint8_t modifiers{};
+      std::string text;
+      Mouse mouse;
+    };
+
+    /*
+     * Switches the input to the raw mode and enables bracketed paste in the
+     * terminal. Throws std::system_error if the input isn't a terminal.
+     */
+    explicit Input(int in_file_desc = STDIN_FILENO,
+        const Terminal& = Terminal());
+    // Restores the terminal.
+    ~Input();
+
+    Input(const Input&) = delete;
+    auto operator=(const Input&) -> Input& = delete;
+    Input(Input&&) = delete;
+    auto operator=(Input&&) -> Input& = delete;
+
+    /*
+     * Returns the next event, waiting for it no longer than the timeout.
+     * Returns nothing on timeout or if stopped.
+     */
+    auto wait(std::chrono::milliseconds timeout) -> std::optional<Event>;
+    // Calls the handler for each event until stop is called.
+    void run(const std::function<void(const Event&)>& handler);
+    /*
+     * Interrupts waiting of wait or run, can be called from any thread and
+     * signal handlers.
+     */
+    void stop();
+
+    // Enables reporting of clicks, moves with pressed buttons and scrolling.
+    void set_mouse_tracking(bool);
+    [[nodiscard]] inline auto is_mouse_tracking() const
+        { return m_mouse_tracking; }
+    // Whether the last wait was interrupted by stop or hang up.
+    [[nodiscard]] inline auto is_stopped() const { return m_stopped; }
+    [[nodiscard]] inline auto get_in_file_desc() const
+        { return m_in_file_desc; }
+
+    /*
+     * Sequences starting with the escape key are completed if the rest isn't
+     * received within this time, so the key alone can be distinguished.
+     */
+    static constexpr std::chrono::milliseconds ESCAPE_TIMEOUT{25};
+
+  private:
+    // Returns false on timeout or if stopped.
+    auto read_input(std::chrono::milliseconds timeout) -> bool;
+    void write_sequence(std::string_view) const;
+
+    int m_in_file_desc, m_out_file_desc, m_epoll_file_desc, m_stop_file_desc;
+    termios m_saved_mode{};
+    std::unique_ptr<internal::InputDecoder> m_decoder;
+    std::deque<Event> m_events;
+    std::array<char, 4096U> m_read_buffer{};
+    std::chrono::steady_clock::time_point m_last_read{};
+    bool m_mouse_tracking{}, m_stopped{};
+  };
+} // Namespace fcli.
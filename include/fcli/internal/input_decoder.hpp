@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+#include "../input.hpp"
+
+namespace fcli::internal {
+  /*
+   * Turns bytes of terminal input into events. Bytes are classified and the
+   * transition table gives an action and the next state for each state and
+   * class, like in parsers of terminal emulators. Incomplete sequences are
+   * kept between calls, so input can be split anywhere.
+   */
+  class InputDecoder {
+  public:
+    // Appends events of complete sequences.
+    void feed(std::string_view, std::deque<Input::Event>&);
+    /*
+     * Completes the incomplete sequence, e.g. the escape key that isn't
+     * followed by a sequence. Pasted text is never completed.
+     */
+    void flush(std::deque<Input::Event>&);
+    [[nodiscard]] auto is_pending() const -> bool;
+
+    enum class State {
+      GROUND, ESCAPE, CSI, SS3, UTF8, PASTE
+    };
+
+    enum class Action {
+      NONE,
+      // Emit a character of the ASCII range.
+      PRINT,
+      // Emit a key of a control character.
+      CONTROL,
+      // Start a sequence or the alt modifier of the next key.
+      ESCAPE,
+      // Emit the escape key of the previous escape character.
+      ESCAPE_KEY,
+      START,
+      COLLECT,
+      // Emit a key of a complete sequence.
+      DISPATCH,
+      UTF8_START,
+      UTF8_CONTINUE,
+      // Emit the replacement character.
+      INVALID,
+      // Complete the sequence and process the byte again in the ground state.
+      ABORT
+    };
+
+    struct Transition {
+      Action action;
+      State state;
+    };
+
+  private:
+    void execute(Action, State previous, char, std::deque<Input::Event>&);
+    void dispatch_csi(char final, std::deque<Input::Event>&);
+    void dispatch_ss3(char final, std::deque<Input::Event>&);
+    void dispatch_mouse(char final, std::deque<Input::Event>&);
+    // Returns size of the processed part of the data.
+    auto feed_paste(std::string_view, std::deque<Input::Event>&) -> std::size_t;
+    auto emit(std::deque<Input::Event>&, Input::Key, char32_t code_point = 0U,
+        std::uint8_t modifiers = 0U) -> Input::Event&;
+
+    State m_state{State::GROUND};
+    // Parameters of a sequence, bytes of a character or pasted text.
+    std::string m_sequence;
+    std::size_t m_utf8_remaining{};
+    // The previous escape character is the alt modifier.
+    bool m_alt{};
+  };
+} // Namespace fcli::internal.
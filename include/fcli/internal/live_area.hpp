@@ -0,0 +1,40 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace fcli::internal {
+  // Lines at the bottom of an output that are redrawn as a whole.
+  class LiveArea {
+  public:
+    /*
+     * Returns sequence that erases the drawn lines
+     * and moves cursor to the begin of the first one.
+     */
+    [[nodiscard]] auto erase() -> std::string;
+    // Remembers how many lines should be erased next time.
+    void set_drawn(std::string_view content);
+
+    [[nodiscard]] inline auto get_lines() const { return m_lines; }
+
+  private:
+    std::size_t m_lines{};
+  };
+} // Namespace fcli::internal.
@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// File of events that is written by Recorder and read by Replayer.
+namespace fcli::internal::recording {
+  // Placed at the beginning of a file, the last character is the version.
+  constexpr std::string_view MAGIC = "FCLIREC1";
+
+  enum class Type : std::uint8_t {
+    // Payload is text.
+    TEXT,
+    // Payload is double.
+    PERCENTS,
+    // Flag is the determined mode, no payload.
+    DETERMINED,
+    // Payload is unsigned short.
+    WIDTH,
+    // No payload.
+    SHOW,
+    HIDE,
+    // Flag is success, payload is result message.
+    FINISH,
+    // Payload is bytes written to the output stream.
+    OUTPUT,
+
+    _COUNT
+  };
+
+  // Precedes a payload. Native byte order is used.
+  struct Header {
+    // Since the first event.
+    std::uint64_t nanoseconds;
+    std::uint32_t payload_size;
+    Type type;
+    std::uint8_t flag;
+    // Zero, written to avoid uninitialized padding.
+    std::uint16_t reserved;
+  };
+  static_assert(sizeof(Header) == 16U);
+} // Namespace fcli::internal::recording.
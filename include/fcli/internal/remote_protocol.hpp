@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+// Messages that are sent by RemoteProgress to Aggregator.
+namespace fcli::internal::remote_protocol {
+  enum class Type : std::uint8_t {
+    // Flag is the determined mode, payload is text.
+    CREATE,
+    // Payload is text.
+    TEXT,
+    // Payload is double.
+    PERCENTS,
+    // Flag is the determined mode, no payload.
+    DETERMINED,
+    // Flag is success, payload is result message.
+    FINISH,
+    // Progress is destroyed without a result, no payload.
+    REMOVE,
+
+    _COUNT
+  };
+
+  // Both sides are on the same host, so the native byte order is used.
+  struct Header {
+    // Writers can share the same descriptor, so identifier of
+    // a progress is unique only within its process.
+    std::uint32_t process_id;
+    std::uint32_t id;
+    Type type;
+    std::uint8_t flag;
+    std::uint16_t payload_size;
+  };
+  static_assert(sizeof(Header) == 12U);
+
+  // Writes of this size to a pipe are atomic, so
+  // several writers can share the same descriptor.
+  constexpr std::size_t MAX_MESSAGE_SIZE = PIPE_BUF;
+  constexpr std::size_t MAX_PAYLOAD_SIZE = MAX_MESSAGE_SIZE - sizeof(Header);
+} // Namespace fcli::internal::remote_protocol.
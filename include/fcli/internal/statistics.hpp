@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "fcli/statistics.hpp"
+
+namespace fcli::internal {
+#ifdef FCLI_STATISTICS
+  inline constexpr bool STATISTICS_ENABLED = true;
+#else
+  inline constexpr bool STATISTICS_ENABLED = false;
+#endif
+
+  using counter_t = std::atomic<std::uint64_t>;
+
+  struct ProgressStatistics {
+    counter_t notifications{}, frames_rendered{}, frames_skipped{},
+        bytes_written{}, updater_wakeups{}, lock_nanoseconds{};
+
+    [[nodiscard]] auto load() const -> Statistics::ProgressCounters;
+  };
+
+  struct TextStatistics {
+    counter_t calls{}, bytes_in{}, bytes_out{}, nanoseconds{};
+  };
+  // Defined by statistics.cpp.
+  extern TextStatistics text_statistics;
+
+  // Does nothing if statistics are disabled, so the pointer can be null then.
+  template<typename T>
+  inline void count(T* t_statistics, counter_t T::*t_counter,
+      std::uint64_t t_value = 1U) {
+    if constexpr (STATISTICS_ENABLED) {
+      (t_statistics->*t_counter).fetch_add(t_value, std::memory_order_relaxed);
+    }
+  }
+
+  // Adds lifetime of the object to the counter if statistics are enabled.
+  template<typename T>
+  class ScopeTimer {
+  public:
+    ScopeTimer(T* t_statistics, counter_t T::*t_counter):
+        m_statistics(t_statistics), m_counter(t_counter) {
+      if constexpr (STATISTICS_ENABLED) {
+        m_start = std::chrono::steady_clock::now();
+      }
+    }
+
+    ~ScopeTimer() {
+      if constexpr (STATISTICS_ENABLED) {
+        count(m_statistics, m_counter, static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_start).count()));
+      }
+    }
+
+    ScopeTimer(const ScopeTimer&) = delete;
+    auto operator=(const ScopeTimer&) -> ScopeTimer& = delete;
+    ScopeTimer(ScopeTimer&&) = delete;
+    auto operator=(ScopeTimer&&) -> ScopeTimer& = delete;
+
+  private:
+    T* m_statistics;
+    counter_t T::*m_counter;
+    std::chrono::steady_clock::time_point m_start;
+  };
+} // Namespace fcli::internal.
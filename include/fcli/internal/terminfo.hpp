@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Reader of compiled terminfo entries, see term(5).
+namespace fcli::internal::terminfo {
+  struct Capabilities {
+    // Negative if the terminal has no colors.
+    int colors{-1};
+    // Extended RGB or Tc capability: 24-bit colors are supported.
+    bool direct_color{};
+    // Empty strings are absent capabilities.
+    std::string set_foreground, set_background, exit_attributes;
+  };
+
+  /*
+   * Parses an entry of the legacy or the 32-bit numbers format. Only the
+   * needed capabilities are read at their indexes, names of extended ones
+   * are compared without copying. Returns nothing if the entry is invalid.
+   */
+  [[nodiscard]] auto parse(std::string_view entry) ->
+      std::optional<Capabilities>;
+
+  /*
+   * Maps the entry file from $TERMINFO, ~/.terminfo, $TERMINFO_DIRS or the
+   * system directories. Returns nothing if it isn't found or is invalid.
+   */
+  [[nodiscard]] auto load(std::string_view name) ->
+      std::optional<Capabilities>;
+
+  // Result of load that is cached for the process lifetime.
+  [[nodiscard]] auto get_cached(std::string_view name) ->
+      std::optional<Capabilities>;
+} // Namespace fcli::internal::terminfo.
@@ -0,0 +1,58 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace fcli::internal {
+  /*
+   * Passes values from one writer to one reader, neither of them waits for
+   * the other. The writer fills its back buffer and publishes it, the reader
+   * takes the last published buffer. Intermediate values can be skipped.
+   */
+  template<class T> class TripleBuffer {
+  public:
+    // Writer side. Buffers keep their memory, so assign to the buffer.
+    [[nodiscard]] inline auto get_back() -> T& { return m_buffers[m_back]; }
+    void publish();
+
+    /*
+     * Reader side. Returns true if a buffer was published after the previous
+     * call, then it's available as the front one.
+     */
+    auto update() -> bool;
+    [[nodiscard]] inline auto get_front() const -> const T&
+        { return m_buffers[m_front]; }
+
+  private:
+    static constexpr unsigned INDEX_MASK = 3U;
+    // Set in m_middle when it's published and isn't taken by the reader yet.
+    static constexpr unsigned PUBLISHED = 4U;
+
+    std::array<T, 3U> m_buffers{};
+    // Used only by the writer.
+    unsigned m_back{0U};
+    std::atomic<unsigned> m_middle{1U};
+    // Used only by the reader.
+    unsigned m_front{2U};
+  };
+} // Namespace fcli::internal.
+
+#include "triple_buffer.inl"
@@ -0,0 +1,33 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+namespace fcli::internal {
+  template<class T> void TripleBuffer<T>::publish() {
+    m_back = m_middle.exchange(m_back | PUBLISHED,
+        std::memory_order_acq_rel) & INDEX_MASK;
+  }
+
+  template<class T> auto TripleBuffer<T>::update() -> bool {
+    if ((m_middle.load(std::memory_order_relaxed) & PUBLISHED) == 0U) {
+      return false;
+    }
+    m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) &
+        INDEX_MASK;
+    return true;
+  }
+} // Namespace fcli::internal.
@@ -0,0 +1,58 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Measurement of strings in terminal columns.
+namespace fcli::internal::unicode {
+  struct Measure {
+    // In terminal columns.
+    std::size_t width;
+    // In bytes.
+    std::size_t length;
+  };
+
+  /*
+   * Returns zero for combining and control characters, two for East Asian
+   * wide and fullwidth characters and one for others.
+   */
+  [[nodiscard]] auto get_width(char32_t code_point) -> unsigned;
+  // Returns position after the escape sequence that starts at the position.
+  [[nodiscard]] auto skip_escape(std::string_view, std::size_t pos) ->
+      std::size_t;
+  /*
+   * Decodes the code point that starts at the position. Returns zero length
+   * for invalid sequences (overlong forms, surrogates and out of range).
+   */
+  [[nodiscard]] auto decode(std::string_view, std::size_t pos,
+      char32_t& code_point) -> std::size_t;
+  // Appends UTF-8 sequence of the code point.
+  void encode(char32_t code_point, std::string&);
+  // Length of the leading part that consists of printable ASCII characters.
+  [[nodiscard]] auto get_printable_ascii_length(std::string_view)
+      -> std::size_t;
+  /*
+   * Measures the longest prefix that takes no more than the maximum width.
+   * Escape sequences take no space, invalid UTF-8 bytes take one column each.
+   */
+  [[nodiscard]] auto measure(std::string_view,
+      std::size_t max_width) -> Measure;
+} // Namespace fcli::internal::unicode.
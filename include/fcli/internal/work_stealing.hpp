@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace fcli::internal {
+  /*
+   * Splits range of indices [0, count) into chunks and processes them on
+   * several threads. Each worker owns a contiguous block of chunks and takes
+   * them from the front. When its block is exhausted, it steals the back half
+   * of the largest block of another worker.
+   */
+  class WorkStealing {
+  public:
+    // Takes the first and the past-the-last indices of a chunk.
+    using body_t = std::function<void(std::size_t, std::size_t)>;
+
+    // Zero values mean automatic selection.
+    explicit WorkStealing(std::size_t count,
+        unsigned workers = 0U, std::size_t chunk_size = 0U);
+
+    /*
+     * Calling thread is used as one of the workers. Stops taking new chunks
+     * if the body throws an exception (it's rethrown after all workers
+     * finish) or the cancellation predicate returns true.
+     */
+    void run(const body_t&, const std::function<bool()>& cancelled = {});
+
+    // Sum of the per-worker counters, so it can be called during a run.
+    [[nodiscard]] auto get_done() const -> std::size_t;
+    [[nodiscard]] inline auto get_count() const { return m_count; }
+    [[nodiscard]] inline auto get_workers() const { return m_workers_count; }
+    [[nodiscard]] inline auto get_chunk_size() const { return m_chunk_size; }
+    [[nodiscard]] inline auto is_cancelled() const
+        { return m_cancelled.load(); }
+
+  private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64U;
+    // Used to choose chunk size automatically.
+    static constexpr std::size_t CHUNKS_PER_WORKER = 32U;
+
+    // Aligned to avoid false sharing between the counters of workers.
+    struct alignas(CACHE_LINE_SIZE) Worker {
+      // Guards the block bounds. Contended only while stealing.
+      std::mutex mut;
+      // Chunk indices.
+      std::size_t next{}, last{};
+      // Processed items. Written only by the owner.
+      std::atomic<std::size_t> done{};
+    };
+
+    void work(unsigned index, const body_t&,
+        const std::function<bool()>& cancelled);
+    // Returns false if there are no chunks left.
+    [[nodiscard]] auto take_chunk(unsigned index, std::size_t& chunk) -> bool;
+    [[nodiscard]] auto steal(unsigned index) -> bool;
+
+    std::size_t m_count;
+    unsigned m_workers_count;
+    std::size_t m_chunk_size;
+    std::unique_ptr<Worker[]> m_workers;
+
+    std::atomic<bool> m_cancelled{};
+    std::exception_ptr m_exception;
+    std::mutex m_exception_mut;
+  };
+} // Namespace fcli::internal.
@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "internal/live_area.hpp"
+#include "progress.hpp"
+
+namespace fcli {
+  /*
+   * Prints log lines above progresses without tearing them. Lines are queued
+   * from any thread and on each frame the renderer erases progresses once,
+   * prints all queued lines and draws progresses again with a single write.
+   * If no progresses are attached, lines are printed immediately.
+   */
+  class OutputArbiter {
+  public:
+    explicit OutputArbiter(std::ostream& = std::cout);
+    // Prints queued lines and erases progresses.
+    ~OutputArbiter();
+
+    OutputArbiter(const OutputArbiter&) = delete;
+    auto operator=(const OutputArbiter&) -> OutputArbiter& = delete;
+    OutputArbiter(OutputArbiter&&) = delete;
+    auto operator=(OutputArbiter&&) -> OutputArbiter& = delete;
+
+    /*
+     * Progress is drawn by the arbiter while it's attached and running, so
+     * it must stay hidden. Create it with the arbiter stream, so its result
+     * message is printed above other progresses. Attached progresses must be
+     * detached before destruction.
+     */
+    void attach(Progress&);
+    void detach(Progress&);
+    // Detaches and finishes the progress.
+    void finish(Progress&, bool success, std::string_view message);
+
+    // Line break is appended if the line doesn't end with it.
+    void print(std::string_view line);
+    /*
+     * Written data is queued line by line. Each thread gets its own stream,
+     * as formatting state of a stream can't be shared, and has its own
+     * incomplete line, so lines of different threads are never mixed. A stream
+     * must be used only by the thread that got it, so pass a progress the
+     * stream of the thread that finishes it.
+     */
+    [[nodiscard]] auto get_ostream() -> std::ostream&;
+
+  private:
+    class Streambuf: public std::streambuf {
+    public:
+      explicit Streambuf(OutputArbiter& arbiter): m_arbiter(arbiter) {}
+
+    protected:
+      auto overflow(int_type) -> int_type override;
+      auto xsputn(const char_type*, std::streamsize) -> std::streamsize
+          override;
+
+    private:
+      OutputArbiter& m_arbiter;
+    };
+
+    // Attention: it doesn't lock mutex automatically.
+    void queue(std::string_view data);
+    void render();
+    // Attention: it doesn't lock mutex automatically.
+    [[nodiscard]] auto build_output(bool last) -> std::string;
+
+    std::ostream& m_ostream;
+
+    // Guards all following members.
+    std::mutex m_mut;
+    std::vector<Progress*> m_progresses;
+    // Complete lines that aren't printed yet.
+    std::string m_lines;
+    std::map<std::thread::id, std::string> m_incomplete_lines;
+    bool m_redraw{}, m_stopping{};
+    std::condition_variable m_render_cv;
+    // Used only by the renderer.
+    internal::LiveArea m_live_area;
+
+    Streambuf m_streambuf{*this};
+    // Streams of threads over the shared buffer. Guarded by m_mut.
+    std::map<std::thread::id, std::unique_ptr<std::ostream>> m_streams;
+    // Started last as it uses all other members.
+    std::thread m_renderer;
+
+    static constexpr std::chrono::milliseconds FRAME_INTERVAL{50};
+  };
+} // Namespace fcli.
@@ -0,0 +1,199 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <istream>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "input.hpp"
+#include "palette.hpp"
+#include "screen.hpp"
+#include "terminal.hpp"
+#include "theme.hpp"
+
+namespace fcli {
+  /*
+   * Shows long output page by page with styles of Text::format. A file is
+   * mapped to memory and a stream is read by a separate thread, while the
+   * same thread finds line boundaries, so a pager is ready at once. Only the
+   * lines that are shown are formatted, and recently formatted lines are
+   * cached. Search goes through the raw bytes, so specifiers inside of
+   * a pattern aren't skipped.
+   *
+   * Keys: arrows, j / k, page keys, space / b scroll, g / G and Home / End
+   * go to the first and the last line, "/" and "?" search forward and
+   * backward, n / N repeat the search, q and Escape quit.
+   *
+   * Content functions are thread-safe, interactive ones aren't.
+   */
+  class Pager {
+  public:
+    // Throws std::filesystem::filesystem_error if the file can't be mapped.
+    explicit Pager(const std::filesystem::path&,
+        const std::optional<Terminal::ColorsSupport>& =
+            Terminal::get_cached_colors_support(),
+        const Palette& = Theme::get_palette());
+    /*
+     * The stream is read until its end, destruction of the pager waits for
+     * the next bytes of it. Streams without a buffer (e.g. std::cin
+     * synchronized with stdio) are read by bytes, so prefer the descriptor
+     * for them.
+     */
+    explicit Pager(std::istream&,
+        const std::optional<Terminal::ColorsSupport>& =
+            Terminal::get_cached_colors_support(),
+        const Palette& = Theme::get_palette());
+    /*
+     * The descriptor (e.g. a pipe) is read until its end or destruction of
+     * the pager, it isn't closed. Throws std::system_error.
+     */
+    explicit Pager(int file_desc,
+        const std::optional<Terminal::ColorsSupport>& =
+            Terminal::get_cached_colors_support(),
+        const Palette& = Theme::get_palette());
+    ~Pager();
+
+    Pager(const Pager&) = delete;
+    auto operator=(const Pager&) -> Pager& = delete;
+    Pager(Pager&&) = delete;
+    auto operator=(Pager&&) -> Pager& = delete;
+
+    /*
+     * Content.
+     */
+
+    // Lines that are found so far.
+    [[nodiscard]] auto get_lines_count() const -> std::size_t;
+    [[nodiscard]] auto is_indexed() const -> bool;
+    void wait_indexed() const;
+    // Without the line feed.
+    [[nodiscard]] auto get_raw_line(std::size_t) const -> std::string;
+    /*
+     * Line with specifiers replaced by escape sequences and tabs expanded.
+     * Very long lines are cut.
+     */
+    [[nodiscard]] auto get_line(std::size_t) -> std::string;
+    /*
+     * Returns the first line after (or the last one before) the passed line
+     * that contains the pattern. Waits for lines to be found if needed, while
+     * interactive search doesn't wait and is continued by draw.
+     */
+    [[nodiscard]] auto find(std::string_view pattern, std::size_t line,
+        bool backward = false) const -> std::optional<std::size_t>;
+
+    /*
+     * Interaction.
+     */
+
+    // Handles events and redraws the screen until quit or Input::stop.
+    void run(Input&, Screen&);
+    // Returns false on quit.
+    auto handle(const Input::Event&) -> bool;
+    // Draws the whole screen, call Screen::present after it.
+    void draw(Screen&);
+
+    /*
+     * Getters / setters.
+     */
+
+    // First visible line.
+    [[nodiscard]] inline auto get_top() const { return m_top; }
+    void set_top(std::size_t);
+
+    // If disabled, lines are shown as is.
+    [[nodiscard]] inline auto is_formatting() const { return m_formatting; }
+    void set_formatting(bool);
+
+    static constexpr std::size_t CACHE_CAPACITY = 256U;
+    // Longer lines are cut before formatting.
+    static constexpr std::size_t MAX_LINE_SIZE = 64U * 1024U;
+
+  private:
+    void index_mapping();
+    void read_stream(std::istream&);
+    void read_file_desc(int file_desc);
+    // Appends content of a stream and indexes it.
+    void append(const char* data, std::size_t size);
+    void finish_indexing();
+    // Adds offsets of lines of the new data. Locks the mutex.
+    void index(std::size_t begin, std::size_t end);
+    // Attention: it doesn't lock mutex automatically.
+    [[nodiscard]] auto get_data() const -> std::string_view;
+    // Attention: it doesn't lock mutex automatically.
+    [[nodiscard]] auto get_line_bounds(std::size_t) const ->
+        std::pair<std::size_t, std::size_t>;
+    // Attention: it doesn't lock mutex automatically.
+    [[nodiscard]] auto get_line_of(std::size_t offset) const -> std::size_t;
+    /*
+     * Searches complete lines from the offset, which is advanced past the
+     * searched content if the pattern isn't found there. The lock is
+     * released while a mapping is scanned.
+     */
+    [[nodiscard]] auto find_forward(std::string_view pattern,
+        std::size_t& offset, std::unique_lock<std::mutex>&) const ->
+        std::optional<std::size_t>;
+    void search(bool backward);
+    // Searches lines that are found so far, the rest is searched later.
+    void continue_search();
+
+    const char* m_mapping{};
+    // Content of a stream.
+    std::string m_buffer;
+    std::size_t m_size{};
+    std::filesystem::path m_path;
+
+    // Offsets of the line starts.
+    std::vector<std::size_t> m_offsets{0U};
+    bool m_indexed{};
+    mutable std::mutex m_mut;
+    mutable std::condition_variable m_indexed_cv;
+    std::atomic<bool> m_stop{};
+    // Interrupts waiting for a descriptor.
+    int m_stop_file_desc{-1};
+    std::thread m_thread;
+
+    // Formatted lines, the most recent is at the front.
+    std::list<std::pair<std::size_t, std::string>> m_cache;
+    std::unordered_map<std::size_t, decltype(m_cache)::iterator> m_cache_index;
+    std::optional<Terminal::ColorsSupport> m_colors_support;
+    Palette m_palette;
+    bool m_formatting{true};
+    std::string m_status_style, m_reset_style;
+
+    std::size_t m_top{};
+    unsigned short m_rows{1U};
+    // Pattern being typed after "/" or "?", and the last one.
+    std::optional<std::string> m_input;
+    std::string m_pattern;
+    bool m_backward{}, m_not_found{}, m_searching{};
+    // Line of the pending forward search and offset to continue it from.
+    std::size_t m_search_line{}, m_search_offset{};
+  };
+} // Namespace fcli.
@@ -0,0 +1,74 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+#include "internal/work_stealing.hpp"
+#include "progress.hpp"
+
+namespace fcli {
+  // Zero values mean automatic selection.
+  struct ParallelOptions {
+    // By default, it's number of hardware threads.
+    unsigned workers{};
+    // By default, each worker gets several chunks to balance the load.
+    std::size_t chunk_size{};
+  };
+
+  /*
+   * Calls the function for each element of a random access range (or for each
+   * index in [0, range) if an integer passed, std::out_of_range is thrown if
+   * it's negative) on all cores. The progress is
+   * switched to the determined mode and its percents are merged from the
+   * per-worker counters by the updater, so workers never contend on it.
+   *
+   * If the function throws an exception, the rest of the work is cancelled
+   * and the exception is rethrown. Work is also cancelled if the progress is
+   * finished with failure during the run, in that case false is returned.
+   */
+  template<class Range, class Function>
+  auto parallel_for(Range&& range, Function&& function,
+      Progress& progress, const ParallelOptions& options = {}) -> bool;
+
+  /*
+   * Assigns the function result for each element of the input range to the
+   * output range that starts from the passed random access iterator.
+   * Behaves the same way as parallel_for.
+   */
+  template<class Range, class OutputIt, class Function>
+  auto parallel_transform(Range&& range, OutputIt output, Function&& function,
+      Progress& progress, const ParallelOptions& options = {}) -> bool;
+
+  namespace internal {
+    // Indexing other iterators would make the algorithms quadratic.
+    template<class Iterator>
+    constexpr bool is_random_access_v = std::is_base_of_v<
+        std::random_access_iterator_tag, typename std::iterator_traits<
+            std::decay_t<Iterator>>::iterator_category>;
+
+    // Non-template part of the parallel algorithms.
+    auto run_with_progress(WorkStealing&, const WorkStealing::body_t&,
+        Progress&) -> bool;
+  } // Namespace internal.
+} // Namespace fcli.
+
+#include "parallel.inl"
@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+namespace fcli {
+  template<class Range, class Function>
+  auto parallel_for(Range&& t_range, Function&& t_function,
+      Progress& t_progress, const ParallelOptions& t_options) -> bool {
+
+    if constexpr (std::is_integral_v<std::decay_t<Range>>) {
+      if constexpr (std::is_signed_v<std::decay_t<Range>>) {
+        if (t_range < 0) {
+          throw std::out_of_range("range mustn't be negative");
+        }
+      }
+      internal::WorkStealing scheduler(static_cast<std::size_t>(t_range),
+          t_options.workers, t_options.chunk_size);
+      return internal::run_with_progress(scheduler,
+          [&t_function] (std::size_t t_first, std::size_t t_last) {
+        for (auto i = t_first; i != t_last; ++i) {
+          t_function(static_cast<std::decay_t<Range>>(i));
+        }
+      }, t_progress);
+    } else {
+      const auto begin = std::begin(t_range);
+      static_assert(internal::is_random_access_v<decltype(begin)>,
+          "range must be random access");
+      internal::WorkStealing scheduler(
+          static_cast<std::size_t>(std::distance(begin, std::end(t_range))),
+          t_options.workers, t_options.chunk_size);
+      return internal::run_with_progress(scheduler,
+          [&t_function, &begin] (std::size_t t_first, std::size_t t_last) {
+        for (auto i = t_first; i != t_last; ++i) {
+          t_function(*std::next(begin, static_cast<std::ptrdiff_t>(i)));
+        }
+      }, t_progress);
+    }
+  }
+
+  template<class Range, class OutputIt, class Function>
+  auto parallel_transform(Range&& t_range, OutputIt t_output,
+      Function&& t_function, Progress& t_progress,
+      const ParallelOptions& t_options) -> bool {
+
+    const auto begin = std::begin(t_range);
+    static_assert(internal::is_random_access_v<decltype(begin)>,
+        "range must be random access");
+    static_assert(internal::is_random_access_v<OutputIt>,
+        "output iterator must be random access");
+    internal::WorkStealing scheduler(
+        static_cast<std::size_t>(std::distance(begin, std::end(t_range))),
+        t_options.workers, t_options.chunk_size);
+    return internal::run_with_progress(scheduler,
+        [&t_function, &begin, &t_output]
+        (std::size_t t_first, std::size_t t_last) {
+      for (auto i = t_first; i != t_last; ++i) {
+        const auto offset = static_cast<std::ptrdiff_t>(i);
+        *std::next(t_output, offset) =
+            t_function(*std::next(begin, offset));
+      }
+    }, t_progress);
+  }
+} // Namespace fcli.
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "progress.hpp"
+#include "terminal.hpp"
+#include "theme.hpp"
+
+namespace fcli {
+  /*
+   * Scope of a named phase that is profiled. Phases can be nested. Finished
+   * phases are recorded to buffers of their threads without locks and
+   * allocations, so they can be used in hot code. Records are kept until
+   * they are taken, and each thread keeps at most MAX_THREAD_RECORDS of
+   * them: later phases are dropped.
+   */
+  class Phase {
+  public:
+    struct Record {
+      // Interned, so it's valid until the process exit.
+      std::string_view name;
+      // Since the first phase of the process.
+      std::chrono::nanoseconds start;
+      std::chrono::nanoseconds duration;
+      // Number of enclosing phases of the same thread.
+      unsigned depth;
+      // Sequential number of the thread, starts from one.
+      std::size_t thread;
+    };
+
+    explicit Phase(std::string_view name);
+    // Text of the progress is set to the name and restored on destruction.
+    Phase(Progress&, std::string_view name);
+    ~Phase();
+
+    Phase(const Phase&) = delete;
+    auto operator=(const Phase&) -> Phase& = delete;
+    Phase(Phase&&) = delete;
+    auto operator=(Phase&&) -> Phase& = delete;
+
+    /*
+     * Static functions.
+     */
+
+    // Finished phases of all threads. Never waits for them.
+    [[nodiscard]] static auto get_records() -> std::vector<Record>;
+    /*
+     * Same as get_records, but the records are removed, so a long-running
+     * process can export them periodically. Following summaries and traces
+     * don't include them.
+     */
+    [[nodiscard]] static auto take_records() -> std::vector<Record>;
+    // Phases that weren't recorded since their threads kept too many.
+    [[nodiscard]] static auto get_dropped_count() -> std::size_t;
+    /*
+     * Table with number of calls and total, average and maximum durations
+     * of each phase name. Share is the part of time of top-level phases.
+     */
+    [[nodiscard]] static auto format_summary(
+        const std::optional<Terminal::ColorsSupport>& =
+            Terminal::get_cached_colors_support(),
+        const Palette& = Theme::get_palette()) -> std::string;
+    /*
+     * Writes records in the Chrome trace event format, that can be opened
+     * by chrome://tracing or Perfetto. Throws filesystem_error.
+     */
+    static void write_trace(const std::filesystem::path&);
+    // Prints the summary to the stream and writes the trace at exit.
+    static void report_at_exit(std::ostream& = std::cout,
+        std::optional<std::filesystem::path> trace_path = {});
+
+    static constexpr std::size_t MAX_THREAD_RECORDS = 64U * 1024U;
+
+  private:
+    Progress* m_progress{};
+    std::string m_previous_text;
+    std::string_view m_name;
+    std::chrono::steady_clock::time_point m_start;
+  };
+} // Namespace fcli.
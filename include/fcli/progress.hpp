@@ -22,7 +22,10 @@
 #include <chrono>
 #include <condition_variable>
 #include <exception>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -32,12 +35,36 @@
 #include "indicator.hpp"
 #include "internal/enum_array.hpp"
 #include "internal/lazy_init.hpp"
+#include "stage.hpp"
+#include "statistics.hpp"
 #include "terminal.hpp"
+#include "text.hpp"
 #include "theme.hpp"
 
 namespace fcli {
+  class Recorder;
+
+  /*
+   * Styles, indicator and symbols are kept in a skin that is shared by all
+   * progresses with the same appearance and is copied only when it's changed.
+   * So an instance needs no heap memory for its appearance, and none at all
+   * if its text is short.
+   */
   class Progress {
   public:
+    using time_point_t = std::chrono::time_point<std::chrono::steady_clock>;
+    // Returns the current time. Must be thread-safe.
+    using clock_func_t = std::function<time_point_t()>;
+
+    // Who draws frames of a shown progress.
+    enum class Driver {
+      // Own thread that is started by the show function.
+      THREAD,
+      // Host (e.g. an event loop) that calls the render_once function when
+      // the time returned by next_deadline comes. No threads are started.
+      EXTERNAL
+    };
+
     // Styles of progress parts.
     enum class Style {
       PLAIN,
@@ -49,6 +76,8 @@ namespace fcli {
       // Result messages.
       SUCCESS_SYMBOL,
       FAILURE_SYMBOL,
+      // Loading bar of a stalled progress.
+      STALLED,
 
       _COUNT
     };
@@ -85,6 +114,23 @@ namespace fcli {
       _DEFAULT = MINUS
     };
 
+    // Changed by the finish function and reset on show.
+    enum class State {
+      RUNNING,
+      SUCCEEDED,
+      FAILED
+    };
+
+    // Passed to frame handlers.
+    struct Snapshot {
+      std::string_view text;
+      double percents;
+      bool determined;
+      State state;
+      // Printed frame. Empty if the progress is finished.
+      std::string_view frame;
+    };
+
     class no_space_error : public std::exception {
     public:
       [[nodiscard]] inline auto what() const noexcept -> const char* override
@@ -92,7 +138,10 @@ namespace fcli {
     };
 
     Progress() = default;
-    inline ~Progress() { hide(); }
+    inline ~Progress() {
+      hide();
+      set_auto_width(false);
+    }
 
     // Width will be set to minimum.
     Progress(std::string_view text, bool determined, std::ostream& ostream,
@@ -100,8 +149,9 @@ namespace fcli {
             Terminal::get_cached_colors_support(),
         const Palette& palette = Theme::get_palette()):
 
-        m_text(text), m_determined(determined), m_ostream(ostream),
-        m_formatted_styles(format_default_styles(colors_support, palette)) {}
+        m_text(text), m_text_width(Text::visible_width(text)),
+        m_determined(determined), m_ostream(ostream),
+        m_skin(get_default_skin(colors_support, palette)) {}
 
     // Output stream will be set to standard.
     Progress(std::string_view text, bool determined, unsigned short width,
@@ -109,7 +159,11 @@ namespace fcli {
             Terminal::get_cached_colors_support(),
         const Palette& palette = Theme::get_palette());
 
-    // Attention: output stream and hide status are not copied.
+    /*
+     * Attention: output stream, hide status, percents source, stages,
+     * wakeup, frame and stall handlers, recorder and automatic width are not
+     * copied.
+     */
     Progress(const Progress&);
     auto operator=(const Progress&) -> Progress&;
     // Output stream can't be moved.
@@ -122,6 +176,55 @@ namespace fcli {
     // Result message automatically hides progress. If you want
     // to format the message then you should do it manually.
     void finish(bool success, std::string_view message);
+    // Returns the message as it's printed by the finish function.
+    [[nodiscard]] auto format_result(bool success,
+        std::string_view message) const -> std::string;
+
+    /*
+     * Functions for the external driver. Rendering does nothing if progress is
+     * hidden or driven by the thread.
+     */
+
+    // Returns time_point_t::max() if there is nothing to draw.
+    [[nodiscard]] auto next_deadline() const -> time_point_t;
+    // Erases the previous frame and prints the current one.
+    void render_once(time_point_t now);
+    /*
+     * Renders a frame only if the next deadline has come. Together with
+     * VirtualClock it steps through frames synchronously, for example, in
+     * tests and benchmarks. Returns true if a frame is drawn.
+     */
+    auto step(time_point_t now) -> bool;
+    /*
+     * Called from any thread when the progress is changed, so the next
+     * deadline should be requested again. For example, the handler can write
+     * to an eventfd that is watched by the host. It mustn't call functions of
+     * the progress.
+     */
+    void set_wakeup_handler(std::function<void()>);
+
+    /*
+     * Handler is called after each printed frame (by any driver) and on
+     * finish. It mustn't call functions of the progress. Returns an identifier
+     * to remove the handler.
+     */
+    auto add_frame_handler(std::function<void(const Snapshot&)>) ->
+        std::size_t;
+    void remove_frame_handler(std::size_t id);
+
+    /*
+     * Builds the current frame (without erasing of the previous one) and
+     * advances the animation. Use it to display a hidden progress by own
+     * means, for example, as a part of the multi-line output.
+     */
+    [[nodiscard]] auto render_frame() -> std::string;
+
+    /*
+     * Records further calls and output (see the Recorder class). Current
+     * text, percents, mode, width and the shown state are recorded first.
+     * Pass nullptr to stop recording.
+     */
+    void set_recorder(std::shared_ptr<Recorder>);
 
     // Percents control.
     auto operator++() -> Progress&;
@@ -147,9 +250,29 @@ namespace fcli {
 
     [[nodiscard]] inline auto get_width() const { return m_width.load(); }
     void set_width(unsigned short);
+    /*
+     * Makes width follow the cached terminal width (see
+     * Terminal::get_cached_width). It's limited the same way as by set_width,
+     * but doesn't throw if terminal is too narrow: frames aren't drawn until
+     * it's widened. When the width is changed, all rows of the previous frame
+     * that the terminal could wrap are cleared.
+     */
+    void set_auto_width(bool);
+    [[nodiscard]] auto is_auto_width() const -> bool;
+
+    [[nodiscard]] inline auto get_driver() const { return m_driver.load(); }
+    // Shown progress is hidden and shown again with the new driver.
+    void set_driver(Driver);
+
+    [[nodiscard]] auto get_clock() const -> clock_func_t;
+    // Pass an empty function to use the steady clock.
+    void set_clock(clock_func_t);
 
     [[nodiscard]] auto get_ostream() -> std::ostream&;
     [[nodiscard]] inline auto is_hidden() const { return m_hidden.load(); }
+    [[nodiscard]] inline auto get_state() const { return m_state.load(); }
+    // Zeros if statistics are disabled (see the Statistics class).
+    [[nodiscard]] auto get_statistics() const -> Statistics::ProgressCounters;
 
     [[nodiscard]] inline auto is_dots_used() const
         { return m_append_dots.load(); }
@@ -172,6 +295,43 @@ namespace fcli {
     [[nodiscard]] auto get_pending_text() const -> std::optional<std::string>;
     [[nodiscard]] auto get_pending_percents() const -> std::optional<double>;
 
+    /*
+     * Makes the updater pull percents from the passed function every
+     * SOURCE_POLL_INTERVAL instead of waiting for them to be set. It's called
+     * from the updater thread, so it must be thread-safe. Pass an empty
+     * function to return to the manual control. Returns the previous source,
+     * so it can be restored. Stages are a source too, so replacing it detaches
+     * them until the source is restored.
+     */
+    auto set_percents_source(std::function<double()>) ->
+        std::function<double()>;
+
+    /*
+     * Adds a weighted top-level stage (see the Stage class). Percents of the
+     * progress are taken from the stages, so throws std::logic_error if the
+     * first stage is added while another percents source is set.
+     */
+    [[nodiscard]] auto add_stage(double weight,
+        std::string_view text = {}) -> Stage;
+    // Shows text of the active stage on the second line.
+    [[nodiscard]] inline auto is_stage_text_shown() const
+        { return m_show_stage_text.load(); }
+    void set_stage_text_shown(bool);
+
+    /*
+     * Determined progress is stalled if its percents grow slower than the
+     * minimum rate (percents per second) during the timeout. With the zero
+     * rate it means that percents aren't changed for the timeout. Stalled
+     * loading bar uses the STALLED style. Detection is done while building
+     * frames, so the handler is called by the driver when the stalled state
+     * is changed and it mustn't call functions of the progress. Pass zero
+     * timeout to disable detection. If the progress is stalled, the previous
+     * handler is called with false by this function.
+     */
+    void set_stall_detection(std::chrono::milliseconds timeout,
+        double min_rate = 0.0, std::function<void(bool stalled)> = {});
+    [[nodiscard]] inline auto is_stalled() const { return m_stalled.load(); }
+
     [[nodiscard]] auto get_indicator() const -> Indicator;
     void set_indicator(const Indicator&);
     inline void set_indicator(BuiltInIndicator name)
@@ -183,17 +343,13 @@ namespace fcli {
             Terminal::get_cached_colors_support(),
         const Palette& = Theme::get_palette());
 
-    [[nodiscard]] inline auto get_success_symbol() const
-        { return m_success_symbol; }
-    inline void set_success_symbol(std::string_view symbol)
-        { m_success_symbol = symbol; }
+    [[nodiscard]] auto get_success_symbol() const -> std::string;
+    void set_success_symbol(std::string_view);
     inline void set_success_symbol(SuccessSymbol name)
         { set_success_symbol(get_success_symbol(name)); }
 
-    [[nodiscard]] inline auto get_failure_symbol() const
-        { return m_failure_symbol; }
-    inline void set_failure_symbol(std::string_view symbol)
-        { m_failure_symbol = symbol; }
+    [[nodiscard]] auto get_failure_symbol() const -> std::string;
+    void set_failure_symbol(std::string_view);
     inline void set_failure_symbol(FailureSymbol name)
         { set_failure_symbol(get_failure_symbol(name)); }
 
@@ -207,48 +363,121 @@ namespace fcli {
     [[nodiscard]] static auto get_failure_symbol(FailureSymbol) -> std::string;
 
     // Default styles of all new objects.
-    [[nodiscard]] static inline auto get_default_style(Style name)
-        { return s_default_styles->get(name); }
-    static inline void set_default_style(Style name, std::string_view style)
-        { s_default_styles->set(name, std::string(style)); }
+    [[nodiscard]] static auto get_default_style(Style) -> std::string;
+    static void set_default_style(Style, std::string_view);
 
   private:
     using styles_t = internal::EnumArray<Style, std::string>;
+    // Immutable appearance (styles, indicator and symbols) that is shared
+    // between progresses and replaced as a whole when it's changed.
+    struct Skin;
 
     void copy_percents(const Progress&);
     // Attention: it doesn't lock mutex automatically.
     void copy_non_atomic(const Progress&);
-    // Main function that updates progress.
+    // Replaces the skin with its changed copy.
+    void change_skin(const std::function<void(Skin&)>&);
+    // Main function of the updater thread.
     void update();
+    // Attention: it doesn't lock mutex automatically.
+    void draw_frame(time_point_t now);
+    // Attention: it doesn't lock mutex automatically.
+    void erase_frame();
+    /*
+     * Sequence that erases the printed frame and moves to its first line.
+     * Attention: it doesn't lock mutex automatically.
+     */
+    [[nodiscard]] auto build_erase() -> std::string;
+    // Attention: it doesn't lock mutex automatically.
+    void call_frame_handlers(std::string_view frame);
+    // Called by the terminal width listener.
+    void apply_terminal_width(unsigned short);
+    // Attention: it doesn't lock mutex automatically.
+    [[nodiscard]] auto build_frame(time_point_t now) -> std::string;
+    // Attention: it doesn't lock mutex automatically.
+    [[nodiscard]] inline auto get_now() const
+        { return m_clock ? m_clock() : std::chrono::steady_clock::now(); }
+    /*
+     * Updates the stalled state and returns time to the next check.
+     * Attention: it doesn't lock mutex automatically.
+     */
+    auto detect_stall(time_point_t now, double percents)
+        -> std::chrono::milliseconds;
+    // Attention: it doesn't lock mutex automatically.
+    void set_stalled(bool);
     // Used to notify updater for new changes.
     void notify();
 
     std::string m_text;
+    // Visible width of the text, it's measured only when the text changes.
+    std::size_t m_text_width{};
     std::atomic<bool> m_determined{};
     std::atomic<unsigned short> m_width{MIN_WIDTH};
     std::ostream& m_ostream{std::cout};
 
     std::atomic<bool> m_hidden{true};
+    std::atomic<State> m_state{State::RUNNING};
     std::atomic<bool> m_append_dots{true};
     // Determined progress only.
     std::atomic<double> m_percents{};
-    // Undetermined progress only.
-    Indicator m_indicator{get_indicator(BuiltInIndicator::_DEFAULT)};
     // Set to true when indicator is changed. Used by updater.
-    std::atomic<bool> m_invalidate_frame_it{};
+    std::atomic<bool> m_invalidate_frame_it{true};
 
     std::atomic<std::chrono::milliseconds> m_info_update_interval{};
-    std::atomic<std::chrono::time_point<std::chrono::steady_clock>>
-        m_next_info_update{std::chrono::steady_clock::now()};
+    // The epoch is in the past for any clock.
+    std::atomic<time_point_t> m_next_info_update{};
     std::optional<std::string> m_pending_text;
     // A negative value means there is no pending percents value.
     std::atomic<double> m_pending_percents{-1.0};
+    // Not copied as it usually refers to the owner's local state.
+    std::function<double()> m_percents_source;
+    // Created with the first stage. Not copied as stages are handles.
+    std::optional<Stage> m_root_stage;
+    std::atomic<bool> m_show_stage_text{};
+
+    // Stall detection, guarded by m_mut. Zero timeout disables it.
+    std::chrono::milliseconds m_stall_timeout{};
+    double m_stall_min_rate{};
+    std::function<void(bool)> m_stall_handler;
+    // Start of the current measurement, empty until the first frame.
+    std::optional<time_point_t> m_stall_window_start;
+    double m_stall_window_percents{};
+    std::atomic<bool> m_stalled{};
+
+    // Guarded by m_mut. Progresses with the default appearance share it.
+    std::shared_ptr<const Skin> m_skin{get_default_skin()};
+
+    /*
+     * Animation state that is changed while building a frame.
+     */
 
-    styles_t m_formatted_styles{format_default_styles()};
-    // Updater doesn't use this members, so mutex lock doesn't required.
-    std::string
-        m_success_symbol{get_success_symbol(SuccessSymbol::_DEFAULT)},
-        m_failure_symbol{get_failure_symbol(FailureSymbol::_DEFAULT)};
+    // Indexes of the displayed indicator frame and the next one.
+    std::size_t m_frame_index{}, m_next_frame_index{};
+    std::string m_dots;
+    // Current number of displayed dots. If text size is more than
+    // space_for_text + MAX_DOTS, then static MAX_DOTS dots will be displayed.
+    std::size_t m_dots_count{};
+    std::chrono::milliseconds m_frame_passed_time{}, m_dots_passed_time{};
+    // Empty until the first frame is built.
+    std::optional<time_point_t> m_prev_frame_time;
+    // Maximum time to wait for the next frame.
+    std::chrono::milliseconds m_wait_time{};
+    // Size of the last printed frame, used to erase it.
+    unsigned short m_printed_width{};
+    std::size_t m_printed_lines{};
+    // Set when width is changed by the terminal. The previous frame
+    // can be wrapped then, so it's erased entirely.
+    std::atomic<bool> m_resized{};
+    // Zero if the width isn't taken from the terminal.
+    std::atomic<unsigned short> m_terminal_width{};
+    // Terminal width subscription.
+    std::optional<std::size_t> m_width_listener_id;
+
+    std::atomic<Driver> m_driver{Driver::THREAD};
+    // Set with the recorder, so calls don't lock the mutex without it.
+    std::atomic<bool> m_recording{};
+    // Empty function means the steady clock.
+    clock_func_t m_clock;
 
     // Executes the update function.
     std::thread m_updater;
@@ -257,13 +486,28 @@ namespace fcli {
 
     bool m_force_update{};
     std::condition_variable m_force_update_cv;
+    // Also guards the wakeup handler as it's called on notify.
     mutable std::mutex m_force_update_mut;
+    // Not copied as it refers to the host.
+    std::function<void()> m_wakeup_handler;
+    // Guarded by m_mut. Not copied.
+    std::map<std::size_t, std::function<void(const Snapshot&)>>
+        m_frame_handlers;
+    std::size_t m_next_frame_handler_id{};
+    // Guarded by m_mut. Not copied.
+    std::shared_ptr<Recorder> m_recorder;
+    // Null if statistics are disabled. Not copied.
+    std::shared_ptr<internal::ProgressStatistics> m_statistics{
+        Statistics::register_progress()};
 
     /*
      * Private static members and functions.
      */
 
     static constexpr std::chrono::milliseconds DOTS_UPDATE_INTERVAL{1000};
+    static constexpr std::chrono::milliseconds SOURCE_POLL_INTERVAL{100};
+    // Placed in the front of the active stage text.
+    static constexpr std::string_view STAGE_TEXT_INDENT = "   ";
     static constexpr std::size_t MAX_DOTS = 3U;
     static constexpr double MAX_PERCENTS = 100.0;
     static constexpr unsigned short
@@ -276,15 +520,24 @@ namespace fcli {
 
     [[nodiscard]] static inline auto get_empty_line(unsigned short width)
         { return '\r' + std::string(width, ' ') + '\r'; }
+    // Erases lines from the last to the first one.
+    [[nodiscard]] static auto get_empty_lines(
+        unsigned short width, std::size_t count) -> std::string;
 
-    // Called once on object creation.
-    static auto format_default_styles(
+    /*
+     * Returns the skin with the default styles, indicator and symbols. It's
+     * built once for each pair of colors support and palette (until default
+     * styles are changed).
+     */
+    [[nodiscard]] static auto get_default_skin(
         const std::optional<Terminal::ColorsSupport>& =
             Terminal::get_cached_colors_support(),
-        const Palette& = Theme::get_palette()) -> styles_t;
+        const Palette& = Theme::get_palette()) -> std::shared_ptr<const Skin>;
 
     [[nodiscard]] static inline auto init_default_styles() -> styles_t {
-      return styles_t({"<r>", "~B~", "<b>", "<b>~y~", "<b>~g~", "<b>~r~"});
+      return styles_t({
+        "<r>", "~B~", "<b>", "<b>~y~", "<b>~g~", "<b>~r~", "~Y~"
+      });
     }
     static inline internal::LazyInit<styles_t>
         s_default_styles{init_default_styles};
@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "internal/recording.hpp"
+
+namespace fcli {
+  /*
+   * Writes API calls of a progress (see Progress::set_recorder) and its
+   * output with timestamps to a compact binary file, so the session can be
+   * replayed later by Replayer. Percents of sources and stages aren't
+   * recorded as they aren't set by calls. Timestamps are taken from the clock
+   * of the progress (see Progress::set_clock), so a session under a virtual
+   * clock is replayed with its timing. A recorder is meant for a single
+   * progress. Thread-safe.
+   */
+  class Recorder {
+  public:
+    // Throws filesystem_error.
+    explicit Recorder(const std::filesystem::path&);
+
+    Recorder(const Recorder&) = delete;
+    auto operator=(const Recorder&) -> Recorder& = delete;
+    Recorder(Recorder&&) = delete;
+    auto operator=(Recorder&&) -> Recorder& = delete;
+
+    // Writes buffered events. Throws filesystem_error.
+    void flush();
+
+  private:
+    friend class Progress;
+    using type_t = internal::recording::Type;
+
+    using time_point_t = std::chrono::steady_clock::time_point;
+
+    void record(time_point_t now, type_t, bool flag = false,
+        std::string_view payload = {});
+    template<typename T>
+    inline void record_value(time_point_t t_now, type_t t_type, T t_value) {
+      record(t_now, t_type, false, std::string_view(
+          reinterpret_cast<const char*>(&t_value), sizeof(t_value)));
+    }
+
+    std::filesystem::path m_path;
+    std::ofstream m_file;
+    // Guards all following members.
+    std::mutex m_mut;
+    // Time of the first event.
+    std::optional<time_point_t> m_start;
+    std::chrono::nanoseconds m_last_time{};
+  };
+
+  /*
+   * Re-drives a new progress with recorded calls to compare rendering cost
+   * on identical sessions.
+   */
+  class Replayer {
+  public:
+    struct Report {
+      std::size_t events;
+      // Printed frames of the replayed progress.
+      std::size_t frames;
+      // Written by the replayed progress.
+      std::uintmax_t bytes;
+      // Written by the recorded progress.
+      std::uintmax_t recorded_bytes;
+      // Process CPU time, including the updater thread.
+      std::chrono::nanoseconds cpu_time;
+      std::chrono::nanoseconds duration;
+    };
+
+    class format_error : public std::exception {
+    public:
+      [[nodiscard]] inline auto what() const noexcept -> const char* override
+          { return "invalid recording"; }
+    };
+
+    // Reads all events. Throws filesystem_error and format_error.
+    explicit Replayer(const std::filesystem::path&);
+
+    /*
+     * Output of the progress is written to the passed stream. Calls are
+     * made at the recorded time divided by speed. Zero speed means virtual
+     * time: frames are stepped by the external driver without waiting, so
+     * results are reproducible.
+     */
+    [[nodiscard]] auto run(std::ostream&, double speed = 0.0) const -> Report;
+
+    [[nodiscard]] inline auto get_events_count() const
+        { return m_events.size(); }
+
+  private:
+    struct Event {
+      std::chrono::nanoseconds time;
+      internal::recording::Type type;
+      bool flag;
+      std::string payload;
+    };
+
+    std::vector<Event> m_events;
+  };
+} // Namespace fcli.
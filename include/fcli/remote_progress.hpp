@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "internal/remote_protocol.hpp"
+
+namespace fcli {
+  /*
+   * Progress of a child process that only sends compact updates through an
+   * inherited pipe or socket to the Aggregator of the parent process. Several
+   * remote progresses can share the same descriptor. A stream socket can
+   * take a message in parts, so progresses sharing it must not be updated
+   * concurrently.
+   *
+   * Percents updates that don't change the displayed value (with precision
+   * to tenths) aren't sent. If the descriptor is non-blocking and the pipe is
+   * full, text and percents updates are postponed instead of waiting: the
+   * latest values are sent with the next update or by the flush function.
+   */
+  class RemoteProgress {
+  public:
+    // Pass OPENED file descriptor.
+    RemoteProgress(int out_file_desc, std::string_view text, bool determined);
+    // Removes the progress if it isn't finished.
+    ~RemoteProgress();
+
+    RemoteProgress(const RemoteProgress&) = delete;
+    auto operator=(const RemoteProgress&) -> RemoteProgress& = delete;
+    RemoteProgress(RemoteProgress&&) = delete;
+    auto operator=(RemoteProgress&&) -> RemoteProgress& = delete;
+
+    // Further updates are ignored.
+    void finish(bool success, std::string_view message);
+
+    auto operator++() -> RemoteProgress&;
+    auto operator+=(double) -> RemoteProgress&;
+    auto operator=(double) -> RemoteProgress&;
+    auto operator=(std::string_view) -> RemoteProgress&;
+
+    void set_text(std::string_view);
+    void set_percents(double);
+    void set_determined(bool);
+    // Waits until postponed updates are sent.
+    void flush();
+
+    [[nodiscard]] inline auto get_percents() const { return m_percents; }
+    [[nodiscard]] inline auto get_id() const { return m_id; }
+
+  private:
+    using type_t = internal::remote_protocol::Type;
+
+    // Returns false if an optional message was dropped.
+    auto send(type_t, bool flag, const void* payload,
+        std::size_t payload_size, bool optional) -> bool;
+    // Sends postponed updates. Returns false if they are dropped again.
+    auto send_pending(bool optional) -> bool;
+
+    int m_out_file_desc;
+    std::uint32_t m_process_id;
+    std::uint32_t m_id{s_next_id++};
+    double m_percents{};
+    // Last sent percents in tenths. Negative if nothing is sent.
+    long m_sent_tenths{-1L};
+    // Postponed updates, the text keeps its memory.
+    std::string m_pending_text;
+    bool m_text_pending{}, m_percents_pending{};
+    bool m_finished{};
+
+    static inline std::atomic<std::uint32_t> s_next_id;
+  };
+} // Namespace fcli.
@@ -0,0 +1,141 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "progress.hpp"
+
+namespace fcli {
+  /*
+   * Full-screen output for dashboards. Content is drawn to the back buffer of
+   * cells, then present writes only the cells that differ from the front
+   * buffer (that is what the terminal shows) with the shortest cursor moves
+   * and changes attributes only between cells of different styles. Rows are
+   * counted from the top of the terminal, so nothing else should be printed
+   * while a screen is used. Not thread-safe.
+   */
+  class Screen {
+  public:
+    struct Cell {
+      // UTF-8 of a code point and its combining characters.
+      std::array<char, 8U> glyph{' '};
+      std::uint8_t glyph_size{1U};
+      // Zero for the right half of a wide character.
+      std::uint8_t width{1U};
+      // Index of the SGR sequence, zero is the plain style.
+      std::uint16_t style{};
+
+      [[nodiscard]] inline auto operator==(const Cell& other) const {
+        return glyph_size == other.glyph_size && width == other.width &&
+            style == other.style && glyph == other.glyph;
+      }
+      [[nodiscard]] inline auto operator!=(const Cell& other) const
+          { return !(*this == other); }
+    };
+
+    Screen(unsigned short width, unsigned short height,
+        std::ostream& = std::cout);
+    // Leaves the alternate screen.
+    ~Screen();
+
+    Screen(const Screen&) = delete;
+    auto operator=(const Screen&) -> Screen& = delete;
+    Screen(Screen&&) = delete;
+    auto operator=(Screen&&) -> Screen& = delete;
+
+    /*
+     * Clears the back buffer. Content isn't kept between frames
+     * automatically, but unchanged cells aren't written by present.
+     */
+    void clear();
+    /*
+     * Draws text with escape sequences, e.g. formatted by Text::format. SGR
+     * sequences change style of the following cells, others are skipped.
+     * New line continues from the column x of the next row. Text is clipped
+     * by the maximum width and the screen. Returns number of drawn rows.
+     */
+    auto draw_text(unsigned short x, unsigned short y, std::string_view,
+        unsigned short max_width = USHRT_MAX) -> unsigned short;
+    /*
+     * Draws the next frame of a hidden progress (see Progress::render_frame)
+     * within its width. Returns number of drawn rows.
+     */
+    auto draw_progress(unsigned short x, unsigned short y, Progress&) ->
+        unsigned short;
+    /*
+     * Writes the difference between the buffers and makes the front one
+     * equal to the back one. Returns number of written bytes.
+     */
+    auto present() -> std::size_t;
+    // The next present redraws all cells.
+    void invalidate();
+
+    /*
+     * Getters / setters.
+     */
+
+    [[nodiscard]] auto get_cell(unsigned short x, unsigned short y) const ->
+        const Cell&;
+    [[nodiscard]] inline auto get_width() const { return m_width; }
+    [[nodiscard]] inline auto get_height() const { return m_height; }
+    // Clears both buffers.
+    void resize(unsigned short width, unsigned short height);
+
+    // Switches to the alternate screen immediately and hides the cursor.
+    void set_alternate(bool);
+    [[nodiscard]] inline auto is_alternate() const { return m_alternate; }
+    // Wraps updates in the synchronized output mode (DEC 2026), so
+    // terminals that support it never show a half-drawn frame.
+    inline void set_synchronized(bool enable) { m_synchronized = enable; }
+    [[nodiscard]] inline auto is_synchronized() const
+        { return m_synchronized; }
+
+  private:
+    // Writes the cell and repairs wide characters that it overlaps.
+    void put(unsigned short x, unsigned short y, const Cell&);
+    // Returns identifier of the SGR sequence.
+    auto add_style(std::string_view) -> std::uint16_t;
+    // Appends the shortest sequence that moves the cursor.
+    void move_cursor(unsigned short x, unsigned short y);
+
+    std::ostream& m_ostream;
+    unsigned short m_width, m_height;
+    std::vector<Cell> m_front, m_back;
+    // SGR sequences of styles, the first one is empty.
+    std::vector<std::string> m_styles{std::string()};
+    std::unordered_map<std::string, std::uint16_t> m_style_ids;
+    bool m_alternate{}, m_synchronized{}, m_clear_pending{true};
+
+    /*
+     * State of the present function.
+     */
+
+    std::string m_output;
+    // Negative if unknown.
+    int m_cursor_x{-1}, m_cursor_y{-1};
+  };
+} // Namespace fcli.
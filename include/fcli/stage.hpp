@@ -0,0 +1,102 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace fcli {
+  /*
+   * Weighted part of a progress that can have own stages. Percents of a
+   * stage roll up to all its ancestors using atomic fixed-point counters, so
+   * updates never lock and stages don't have their own updaters.
+   *
+   * Stage is a handle: its copies refer to the same part. Use
+   * Progress::add_stage to create the top-level stages.
+   */
+  class Stage {
+  public:
+    // Creates a root stage that takes 100 percents.
+    Stage();
+
+    /*
+     * Weight is share (in percents) of this stage that the new stage takes,
+     * so weights of all children should sum to 100. Text of the most recently
+     * updated stage is considered as the active text of the whole tree.
+     */
+    [[nodiscard]] auto add_stage(double weight,
+        std::string_view text = {}) const -> Stage;
+
+    // Percents that are set directly, without the children part.
+    void set_percents(double) const;
+    // Percents that include the children part.
+    [[nodiscard]] auto get_percents() const -> double;
+    inline auto operator=(double percents) -> Stage&
+        { set_percents(percents); return *this; }
+
+    void set_text(std::string_view) const;
+    [[nodiscard]] auto get_text() const -> std::string;
+    // Text of the most recently updated stage of the whole tree.
+    [[nodiscard]] auto get_active_text() const -> std::string;
+
+    [[nodiscard]] inline auto get_weight() const { return m_node->weight; }
+
+  private:
+    struct Node {
+      Node() = default;
+      // Resets the active node of the root if it's this one.
+      ~Node();
+      Node(const Node&) = delete;
+      auto operator=(const Node&) -> Node& = delete;
+      Node(Node&&) = delete;
+      auto operator=(Node&&) -> Node& = delete;
+
+      // Keeps ancestors alive, so updates can always reach the root.
+      std::shared_ptr<Node> parent;
+      Node* root{};
+      double weight{};
+      // Fixed-point units that correspond to 100 percents of this node.
+      std::int64_t span{};
+
+      // Units of this node and all its descendants.
+      std::atomic<std::int64_t> done{};
+      // Units that are set directly.
+      std::atomic<std::int64_t> own{};
+      // Root only: most recently updated node of the tree.
+      std::atomic<Node*> active{};
+      // Root only: held while reading text of the active node, so the node
+      // can't be destroyed in the meantime. Updates don't lock it.
+      std::mutex active_mut;
+
+      // Text changes rarely, so don't bother with a lock-free structure.
+      mutable std::mutex text_mut;
+      std::string text;
+    };
+
+    explicit Stage(std::shared_ptr<Node> node): m_node(std::move(node)) {}
+
+    std::shared_ptr<Node> m_node;
+
+    // Fine enough to represent weights of deeply nested stages.
+    static constexpr std::int64_t ROOT_SPAN = 1'000'000'000'000;
+    static constexpr double MAX_PERCENTS = 100.0;
+  };
+} // Namespace fcli.
@@ -0,0 +1,84 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace fcli {
+  namespace internal {
+    struct ProgressStatistics;
+  } // Namespace internal.
+
+  /*
+   * Counters of the hot paths. They are collected only if the library is
+   * built with the ENABLE_STATISTICS option. Otherwise counting code is
+   * compiled out and all counters are zeros.
+   */
+  class Statistics {
+  public:
+    struct ProgressCounters {
+      // Changes that woke up the driver.
+      std::uint64_t notifications;
+      std::uint64_t frames_rendered;
+      // Render requests of the external driver that didn't draw a frame.
+      std::uint64_t frames_skipped;
+      // Frames, erasing and result messages written to the output stream.
+      std::uint64_t bytes_written;
+      std::uint64_t updater_wakeups;
+      // Time of holding the mutex while setting information and rendering.
+      std::chrono::nanoseconds lock_time;
+
+      auto operator+=(const ProgressCounters&) -> ProgressCounters&;
+    };
+
+    // Calls of Text::format (including ones made by other functions).
+    struct TextCounters {
+      std::uint64_t calls;
+      std::uint64_t bytes_in;
+      std::uint64_t bytes_out;
+      std::chrono::nanoseconds time;
+    };
+
+    struct Snapshot {
+      std::chrono::steady_clock::time_point time;
+      // Sum of all progresses, including destroyed ones.
+      ProgressCounters progresses;
+      TextCounters text;
+    };
+
+    [[nodiscard]] static auto is_enabled() -> bool;
+    [[nodiscard]] static auto get_snapshot() -> Snapshot;
+    /*
+     * Calls the handler with a snapshot every interval from a background
+     * thread, so counters can be exported to metrics of a service. Pass an
+     * empty function to stop.
+     */
+    static void set_dump_handler(std::function<void(const Snapshot&)>,
+        std::chrono::milliseconds interval = std::chrono::seconds(1));
+
+  private:
+    friend class Progress;
+
+    // Returns nullptr if statistics are disabled.
+    [[nodiscard]] static auto register_progress() ->
+        std::shared_ptr<internal::ProgressStatistics>;
+  };
+} // Namespace fcli.
@@ -0,0 +1,145 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "palette.hpp"
+#include "terminal.hpp"
+#include "theme.hpp"
+
+namespace fcli {
+  /*
+   * Prints rows aligned into columns as they are added. Widths of columns
+   * are measured in terminal columns of formatted cells, so specifiers and
+   * escape sequences take no space. Rows are held back until the look-ahead
+   * window is full, then the window is sized and printed, so memory doesn't
+   * depend on the number of rows. Widths never shrink, but a later window can
+   * widen a column. Output is written to the stream in large chunks.
+   *
+   * Not thread-safe.
+   */
+  class Table {
+  public:
+    enum class Alignment {
+      LEFT,
+      RIGHT,
+      CENTER
+    };
+
+    struct Column {
+      std::string header;
+      // Specifiers of Text::format that are applied to each cell.
+      std::string style;
+      Alignment alignment{Alignment::LEFT};
+      std::size_t min_width{};
+      // Longer cells are truncated. Zero means no limit.
+      std::size_t max_width{};
+    };
+
+    explicit Table(std::vector<Column>, std::ostream& = std::cout,
+        const std::optional<Terminal::ColorsSupport>& =
+            Terminal::get_cached_colors_support(),
+        const Palette& = Theme::get_palette());
+    // Prints the remaining rows.
+    ~Table();
+
+    Table(const Table&) = delete;
+    auto operator=(const Table&) -> Table& = delete;
+    Table(Table&&) = delete;
+    auto operator=(Table&&) -> Table& = delete;
+
+    /*
+     * Cells may contain specifiers of Text::format. Missing trailing cells
+     * are empty, throws std::out_of_range if there are more cells than
+     * columns.
+     */
+    void add_row(std::initializer_list<std::string_view> cells);
+    void add_row(const std::vector<std::string>& cells);
+    // Sizes and prints held rows, then writes the buffer to the stream.
+    void flush();
+
+    /* Getters / setters. */
+
+    [[nodiscard]] inline auto get_columns() const -> const
+        std::vector<Column>& { return m_columns; }
+    // Widths of the printed rows.
+    [[nodiscard]] inline auto get_widths() const -> const
+        std::vector<std::size_t>& { return m_widths; }
+    [[nodiscard]] inline auto get_rows_count() const
+        { return m_rows_count; }
+
+    // Number of rows that are sized together. Zero sizes each row by itself.
+    inline void set_look_ahead(std::size_t rows) { m_look_ahead = rows; }
+    [[nodiscard]] inline auto get_look_ahead() const { return m_look_ahead; }
+    // Printed between columns, may contain specifiers.
+    void set_separator(std::string_view);
+    // Applied to headers instead of styles of columns.
+    inline void set_header_style(std::string_view style)
+        { m_header_style = style; }
+
+    static constexpr std::size_t DEFAULT_LOOK_AHEAD = 1000U;
+    static constexpr std::size_t BUFFER_SIZE = 64U * 1024U;
+
+  private:
+    struct Cell {
+      // Position after the cell in m_held.
+      std::size_t end;
+      // In terminal columns.
+      std::size_t width;
+    };
+
+    // Appends the formatted cell with the style of the column to m_held.
+    void append_cell(std::size_t column, std::string_view cell);
+    void end_row();
+    void print_held();
+    void print_cell(std::size_t column, std::string_view cell,
+        std::size_t width);
+
+    std::vector<Column> m_columns;
+    std::ostream& m_ostream;
+    std::optional<Terminal::ColorsSupport> m_colors_support;
+    Palette m_palette;
+
+    std::size_t m_look_ahead{DEFAULT_LOOK_AHEAD};
+    std::string m_separator{"  "};
+    std::string m_header_style{"<b>"};
+    // Formatted styles of columns.
+    std::vector<std::string> m_styles;
+    std::string m_reset;
+
+    std::vector<std::size_t> m_widths;
+    bool m_header_printed{};
+    std::size_t m_rows_count{};
+
+    // Formatted cells of the held rows without padding.
+    std::string m_held;
+    std::vector<Cell> m_held_cells;
+    std::size_t m_held_rows{};
+    // Used to format a cell.
+    std::string m_cell;
+    // Printed rows that aren't written to the stream yet.
+    std::string m_buffer;
+  };
+} // Namespace fcli.
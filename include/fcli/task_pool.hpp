@@ -0,0 +1,156 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "internal/live_area.hpp"
+#include "internal/triple_buffer.hpp"
+#include "progress.hpp"
+
+namespace fcli {
+  /*
+   * Runs submitted tasks on the fixed set of workers. While there are
+   * unfinished tasks, it shows status line of each busy worker and the overall
+   * progress below them. Messages of finished tasks are printed above.
+   */
+  class TaskPool {
+  public:
+    /*
+     * Passed to a task to report its status. Status is passed to the renderer
+     * through lock-free slots, so it never waits for rendering.
+     */
+    class Handle {
+    public:
+      inline void set_text(std::string_view text) {
+        m_status.text.get_back() = text;
+        m_status.text.publish();
+      }
+      // Switches the status line to the determined mode.
+      void set_percents(double);
+      // Replaces the task name in the result message.
+      inline void set_result_message(std::string_view message)
+          { m_result_message = message; }
+
+      [[nodiscard]] inline auto get_result_message() const
+          { return m_result_message; }
+
+    private:
+      friend class TaskPool;
+
+      struct Status {
+        internal::TripleBuffer<std::string> text;
+        // Negative while the status line is undetermined.
+        std::atomic<double> percents{-1.0};
+      };
+
+      explicit Handle(Status& status): m_status(status) {}
+
+      Status& m_status;
+      std::optional<std::string> m_result_message;
+    };
+
+    // Task is considered failed if it throws an exception.
+    using task_t = std::function<void(Handle&)>;
+
+    // Zero workers means number of hardware threads.
+    explicit TaskPool(unsigned short width, std::ostream& = std::cout,
+        unsigned workers = 0U);
+    // Waits for all tasks.
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    auto operator=(const TaskPool&) -> TaskPool& = delete;
+    TaskPool(TaskPool&&) = delete;
+    auto operator=(TaskPool&&) -> TaskPool& = delete;
+
+    // Name is the initial status text and the default result message.
+    void submit(std::string_view name, task_t);
+    // Blocks until all submitted tasks are finished and
+    // erases status lines. Returns number of failed tasks.
+    auto wait() -> std::size_t;
+
+    // Use it to change text and styles of the overall progress.
+    [[nodiscard]] inline auto get_overall() -> Progress& { return m_overall; }
+    // Use it to change styles, indicator and width of status lines.
+    void for_each_worker(const std::function<void(Progress&)>&);
+    [[nodiscard]] inline auto get_workers_count() const
+        { return static_cast<unsigned>(m_workers.size()); }
+
+  private:
+    struct Worker {
+      /*
+       * Status line. It's never shown, frames are taken by the renderer, and
+       * only the renderer changes it while a task is running.
+       */
+      std::unique_ptr<Progress> progress;
+      Handle::Status status;
+      std::atomic<bool> busy{};
+      std::thread thread;
+    };
+
+    struct Result {
+      bool success;
+      std::string message;
+    };
+
+    void work(Worker&);
+    void render();
+    // Used only by the renderer.
+    void apply_status(Worker&);
+    // Erases previous live area, prints new results and draws status lines.
+    void draw(bool last);
+
+    std::ostream& m_ostream;
+    Progress m_overall;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    // Guards all following members.
+    std::mutex m_mut;
+    std::deque<std::pair<std::string, task_t>> m_tasks;
+    std::vector<Result> m_results;
+    std::size_t m_failed{};
+    // Atomic as they are read by the overall progress without lock.
+    std::atomic<std::size_t> m_submitted{}, m_finished{};
+    bool m_shutdown{}, m_rendering{};
+    // Rendering stops requested by the wait function and finished by the
+    // renderer, which draws the last frame for each of them.
+    std::size_t m_stop_requests{}, m_stops_done{};
+    std::condition_variable m_tasks_cv, m_finished_cv, m_render_cv;
+    // Draws while there are unfinished tasks and idles between them.
+    std::thread m_renderer;
+
+    // Used only by the renderer.
+    internal::LiveArea m_live_area;
+
+    static constexpr std::chrono::milliseconds RENDER_INTERVAL{50};
+  };
+} // Namespace fcli.
@@ -17,9 +17,18 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <optional>
 #include <string>
 #include <unistd.h>
+#include <vector>
+
+#include "internal/terminfo.hpp"
+#include "theme.hpp"
 
 namespace fcli {
   class Terminal {
@@ -29,6 +38,37 @@ namespace fcli {
       HAS_256_COLORS
     };
 
+    using Capabilities = internal::terminfo::Capabilities;
+
+    // Properties of a terminal that are kept between runs.
+    struct Profile {
+      std::optional<ColorsSupport> colors_support;
+      bool direct_color{};
+      // The user palette (Theme::Name::_USER) isn't applied.
+      Theme::Name theme{Theme::Name::DEFAULT};
+      // Application-defined flags, for example, workarounds of the terminal.
+      std::uint32_t quirks{};
+    };
+
+    // Replies of the terminal to the query function.
+    struct QueryResult {
+      // Gamma-encoded luma of the background from 0 (black) to 1 (white).
+      std::optional<double> background_luma;
+      // Name and version reported by XTVERSION, e.g. "kitty(0.26.5)".
+      std::string version;
+      // Primary device attributes. Empty if the terminal didn't answer.
+      std::vector<int> device_attributes;
+      // Reported by COLORTERM or known by the version.
+      bool direct_color{};
+
+      // Material theme that matches the background if 256 colors are
+      // supported, otherwise the default one.
+      [[nodiscard]] auto suggest_theme(
+          const std::optional<ColorsSupport>&) const -> Theme::Name;
+    };
+
+    static constexpr std::chrono::milliseconds DEFAULT_QUERY_TIMEOUT{25};
+
     Terminal() = default;
     // Pass OPENED file descriptor, that used to get terminal width.
     explicit Terminal(int out_file_desc): m_out_file_desc(out_file_desc) {}
@@ -38,9 +78,61 @@ namespace fcli {
         m_out_file_desc(out_file_desc), m_name(name) {}
 
     [[nodiscard]] auto get_width() const -> unsigned short;
-    // TRY to find out how many colors terminal supports.
+    [[nodiscard]] auto get_height() const -> unsigned short;
+    /*
+     * TRY to find out how many colors terminal supports. The terminfo entry
+     * of the name is used if it's found, otherwise the name is compared with
+     * known prefixes.
+     */
     [[nodiscard]] auto find_out_supported_colors() const ->
         std::optional<ColorsSupport>;
+    /*
+     * Capabilities from the compiled terminfo entry of the name. Entries are
+     * memory-mapped once per process. Empty if the entry isn't found.
+     */
+    [[nodiscard]] auto get_capabilities() const -> std::optional<Capabilities>;
+
+    /*
+     * Profiles are persisted in $XDG_CACHE_HOME/fcli (~/.cache/fcli by
+     * default) for each identity of a terminal: the name and the COLORTERM,
+     * TERM_PROGRAM and TERM_PROGRAM_VERSION variables. A profile is read by a
+     * single pread and is ignored if it's written with another format
+     * version, so startup doesn't probe the terminal.
+     */
+
+    // Returns nothing if there is no valid profile.
+    [[nodiscard]] auto load_profile() const -> std::optional<Profile>;
+    // Replaces the stored profile atomically. Throws filesystem_error.
+    void store_profile(const Profile&) const;
+    /*
+     * Loads the profile or detects and stores it. Theme of a detected
+     * profile is the current one. Errors of storing are ignored.
+     */
+    [[nodiscard]] auto get_profile() const -> Profile;
+    // Caches colors support and sets the theme.
+    static void apply_profile(const Profile&);
+
+    /*
+     * Asks the terminal for the background color (OSC 11), version
+     * (XTVERSION) and device attributes (DA1). Replies are read from the input
+     * descriptor in raw mode until the DA1 reply that every terminal sends
+     * last or the timeout. Returns nothing immediately if the input or the
+     * output isn't a terminal. On timeout, unread input is dropped, so
+     * replies that are already received aren't echoed or read by the shell
+     * after raw mode is left.
+     */
+    [[nodiscard]] auto query(int in_file_desc = STDIN_FILENO,
+        std::chrono::milliseconds timeout = DEFAULT_QUERY_TIMEOUT) const ->
+        QueryResult;
+    // Runs the query in a separate thread, so startup isn't blocked.
+    [[nodiscard]] auto query_async(int in_file_desc = STDIN_FILENO,
+        std::chrono::milliseconds timeout = DEFAULT_QUERY_TIMEOUT) const ->
+        std::future<QueryResult>;
+    /*
+     * Finds replies to the query requests in the input, other bytes are
+     * ignored. Useful if the input is read by an own loop.
+     */
+    [[nodiscard]] static auto parse_replies(std::string_view) -> QueryResult;
 
     /*
      * Getters / setters.
@@ -54,6 +146,27 @@ namespace fcli {
     [[nodiscard]] inline auto get_name() const { return m_name; }
     inline void set_name(std::string_view name) { m_name = name; }
 
+    /*
+     * Process-wide width of the watched terminal (standard output by
+     * default). It's updated by the SIGWINCH handler, so reading it doesn't
+     * involve system calls. Zero means the width is unknown. Handler is
+     * installed on the first call of any of these functions and calls the
+     * previously installed one.
+     */
+
+    [[nodiscard]] static auto get_cached_width() -> unsigned short;
+    // Pass OPENED file descriptor.
+    static void watch_width(int out_file_desc = STDOUT_FILENO);
+    /*
+     * Listener is called from a separate thread when the cached width is
+     * changed. It mustn't subscribe or unsubscribe listeners. Returns an
+     * identifier to unsubscribe.
+     */
+    static auto subscribe_width(std::function<void(unsigned short)>) ->
+        std::size_t;
+    // When it returns, the listener is guaranteed not to be running.
+    static void unsubscribe_width(std::size_t id);
+
     [[nodiscard]] static inline auto get_cached_colors_support()
         { return s_cached_colors_support; }
     static inline void cache_colors_support(ColorsSupport colors_support)
@@ -62,6 +175,9 @@ namespace fcli {
         { s_cached_colors_support.reset(); }
 
   private:
+    // Identity of the terminal that a profile is stored for.
+    [[nodiscard]] auto get_profile_key() const -> std::string;
+
     // Null safety version of standard function.
     [[nodiscard]] static auto getenv(std::string_view) -> std::string;
 
@@ -17,8 +17,10 @@
 
 #pragma once
 
+#include <cstddef>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include "internal/enum_array.hpp"
 #include "internal/lazy_init.hpp"
@@ -82,6 +84,19 @@ namespace fcli {
         remove_specifiers_copy(const std::string& str)
         { return format_copy(str, {}); }
 
+    /*
+     * Returns number of terminal columns that the string takes. Escape
+     * sequences and combining characters take no space, East Asian wide
+     * characters take two columns. Specifiers aren't recognized.
+     */
+    [[nodiscard]] static auto visible_width(std::string_view) -> std::size_t;
+    /*
+     * Returns the longest prefix that takes no more than the passed number of
+     * columns. Code points and escape sequences are never split.
+     */
+    [[nodiscard]] static auto truncate_to_width(std::string_view,
+        std::size_t width) -> std::string_view;
+
   private:
     static void replace_specifier(std::string& str,
         std::string_view from, std::string_view to);
@@ -0,0 +1,132 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "progress.hpp"
+
+namespace fcli {
+  // Formats size using binary prefixes, e.g. "512 B" or "1.5 MiB".
+  [[nodiscard]] auto format_size(std::uintmax_t bytes) -> std::string;
+
+  /*
+   * Shows transferred bytes on a progress. Text of the progress is extended
+   * with transferred and total sizes and the average rate, for example,
+   * "Downloading (1.5 MiB / 10.0 MiB, 2.0 MiB/s)". Text is updated no more
+   * often than UPDATE_INTERVAL.
+   *
+   * Not thread-safe.
+   */
+  class ByteProgress {
+  public:
+    /*
+     * Zero total means it's unknown: the progress isn't determined then.
+     * The current text of the progress is extended.
+     */
+    ByteProgress(Progress&, std::uintmax_t total);
+    // Restores the text of the progress.
+    ~ByteProgress();
+
+    ByteProgress(const ByteProgress&) = delete;
+    auto operator=(const ByteProgress&) -> ByteProgress& = delete;
+    ByteProgress(ByteProgress&&) = delete;
+    auto operator=(ByteProgress&&) -> ByteProgress& = delete;
+
+    void add(std::uintmax_t bytes);
+
+    [[nodiscard]] inline auto get_done() const { return m_done; }
+    [[nodiscard]] inline auto get_total() const { return m_total; }
+    [[nodiscard]] inline auto get_progress() -> Progress&
+        { return m_progress; }
+
+    static constexpr std::chrono::milliseconds UPDATE_INTERVAL{100};
+
+  private:
+    void update(Progress::time_point_t now);
+
+    Progress& m_progress;
+    // Text of the progress without sizes.
+    std::string m_text;
+    Progress::clock_func_t m_clock;
+    Progress::time_point_t m_start_time;
+    Progress::time_point_t m_next_update;
+    std::uintmax_t m_total;
+    std::uintmax_t m_done{};
+  };
+
+  /*
+   * Copies a regular file in the kernel (copy_file_range or sendfile), so
+   * data never passes through user-space buffers. Destination is created or
+   * truncated and gets permissions of the source. Progress is switched to
+   * the determined mode and shows sizes (see ByteProgress).
+   *
+   * Returns number of copied bytes. Throws std::filesystem::filesystem_error.
+   */
+  auto copy_file(const std::filesystem::path& from,
+      const std::filesystem::path& to, Progress&) -> std::uintmax_t;
+
+  /*
+   * Stream buffer that counts bytes read from or written to the wrapped
+   * buffer and shows them on a progress (see ByteProgress):
+   *   ProgressStreambuf buffer(*file.rdbuf(), progress, size);
+   *   std::istream stream(&buffer);
+   *
+   * Large reads and writes bypass the own buffer. Output is flushed to the
+   * wrapped buffer by the destructor.
+   */
+  class ProgressStreambuf: public std::streambuf {
+  public:
+    // Zero total means it's unknown.
+    ProgressStreambuf(std::streambuf& wrapped, Progress&,
+        std::uintmax_t total = 0U);
+    ~ProgressStreambuf() override;
+
+    ProgressStreambuf(const ProgressStreambuf&) = delete;
+    auto operator=(const ProgressStreambuf&) -> ProgressStreambuf& = delete;
+    ProgressStreambuf(ProgressStreambuf&&) = delete;
+    auto operator=(ProgressStreambuf&&) -> ProgressStreambuf& = delete;
+
+    [[nodiscard]] inline auto get_bytes() const
+        { return m_byte_progress.get_done(); }
+
+  protected:
+    auto underflow() -> int_type override;
+    auto xsgetn(char_type*, std::streamsize) -> std::streamsize override;
+    auto overflow(int_type) -> int_type override;
+    auto xsputn(const char_type*, std::streamsize) -> std::streamsize
+        override;
+    auto sync() -> int override;
+
+  private:
+    // Returns false if the wrapped buffer failed.
+    auto flush_put_area() -> bool;
+
+    std::streambuf& m_wrapped;
+    ByteProgress m_byte_progress;
+    std::vector<char_type> m_get_buffer;
+    std::vector<char_type> m_put_buffer;
+
+    static constexpr std::streamsize BUFFER_SIZE = 64 * 1024;
+  };
+} // Namespace fcli.
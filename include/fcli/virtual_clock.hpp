@@ -0,0 +1,52 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include "progress.hpp"
+
+namespace fcli {
+  /*
+   * Clock that is advanced only manually. Pass its function to
+   * Progress::set_clock and use the external driver to render frames
+   * deterministically (see Progress::step). Thread-safe.
+   */
+  class VirtualClock {
+  public:
+    using time_point_t = Progress::time_point_t;
+
+    explicit VirtualClock(time_point_t start = {}):
+        m_now(start.time_since_epoch().count()) {}
+
+    [[nodiscard]] inline auto now() const
+        { return time_point_t(time_point_t::duration(m_now.load())); }
+    inline void set(time_point_t time)
+        { m_now = time.time_since_epoch().count(); }
+    inline void advance(time_point_t::duration duration)
+        { m_now += duration.count(); }
+
+    // The clock must outlive users of the function.
+    [[nodiscard]] inline auto get_function() const -> Progress::clock_func_t
+        { return [this] { return now(); }; }
+
+  private:
+    std::atomic<time_point_t::rep> m_now;
+  };
+} // Namespace fcli.
@@ -0,0 +1,235 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <system_error>
+#include <unistd.h>
+
+#include "fcli/aggregator.hpp"
+#include "fcli/internal/remote_protocol.hpp"
+
+using namespace fcli;
+using namespace fcli::internal;
+using namespace std;
+using namespace chrono;
+
+Aggregator::Aggregator(unsigned short t_width, ostream& t_ostream):
+    m_width(t_width), m_ostream(t_ostream),
+    m_epoll_file_desc(epoll_create1(EPOLL_CLOEXEC)),
+    m_read_buffer(READ_BUFFER_SIZE) {
+
+  if (m_epoll_file_desc < 0) {
+    throw system_error(errno, generic_category(), "couldn't create epoll");
+  }
+}
+
+Aggregator::~Aggregator() {
+  for (const auto& [file_desc, buffer] : m_sources) {
+    close(file_desc);
+  }
+  close(m_epoll_file_desc);
+
+  m_progresses.clear();
+  m_ostream << m_live_area.erase() << flush;
+}
+
+void Aggregator::add_source(int t_in_file_desc) {
+  const int flags = fcntl(t_in_file_desc, F_GETFL);
+  if (flags < 0 || fcntl(t_in_file_desc, F_SETFL, flags | O_NONBLOCK) != 0) {
+    throw system_error(errno, generic_category(),
+        "couldn't make source non-blocking");
+  }
+
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = t_in_file_desc;
+  if (epoll_ctl(m_epoll_file_desc, EPOLL_CTL_ADD,
+      t_in_file_desc, &event) != 0) {
+    throw system_error(errno, generic_category(), "couldn't watch source");
+  }
+  m_sources.emplace(t_in_file_desc, string());
+}
+
+auto Aggregator::poll(milliseconds t_timeout) -> bool {
+  if (m_sources.empty()) {
+    return false;
+  }
+
+  auto now = steady_clock::now();
+  if (!m_progresses.empty()) {
+    // Wake up in time to animate progresses.
+    t_timeout = min(t_timeout, max(
+        duration_cast<milliseconds>(m_next_draw - now), milliseconds::zero()));
+  }
+
+  array<epoll_event, MAX_EVENTS> events{};
+  int count = 0;
+  do {
+    count = epoll_wait(m_epoll_file_desc, events.data(), MAX_EVENTS,
+        static_cast<int>(t_timeout.count()));
+  } while (count < 0 && errno == EINTR);
+  if (count < 0) {
+    throw system_error(errno, generic_category(), "couldn't wait for updates");
+  }
+
+  for (int i = 0; i != count; ++i) {
+    const int file_desc = events.at(static_cast<size_t>(i)).data.fd;
+    auto& buffer = m_sources.at(file_desc);
+    const bool open = read_source(file_desc, buffer);
+    apply_messages(file_desc, buffer);
+    if (!open) {
+      close_source(file_desc);
+    }
+  }
+
+  now = steady_clock::now();
+  if (m_draw_requested || (!m_progresses.empty() && now >= m_next_draw)) {
+    draw();
+    m_draw_requested = false;
+    m_next_draw = now + RENDER_INTERVAL;
+  }
+  return !m_sources.empty();
+}
+
+void Aggregator::run() {
+  constexpr milliseconds MAX_TIMEOUT = 1h;
+  while (poll(MAX_TIMEOUT)) {}
+}
+
+auto Aggregator::read_source(int t_file_desc, string& t_buffer) -> bool {
+  while (true) {
+    const auto size = read(t_file_desc,
+        m_read_buffer.data(), m_read_buffer.size());
+    if (size > 0) {
+      t_buffer.append(m_read_buffer.data(), static_cast<size_t>(size));
+      continue;
+    }
+    if (size == 0) {
+      return false;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    // No more data for now, or an error that is considered as closing.
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+  }
+}
+
+void Aggregator::apply_messages(int t_file_desc, string& t_buffer) {
+  using namespace remote_protocol;
+  size_t offset = 0U;
+
+  while (t_buffer.size() - offset >= sizeof(Header)) {
+    Header header{};
+    memcpy(&header, t_buffer.data() + offset, sizeof(header));
+    if (t_buffer.size() - offset - sizeof(header) < header.payload_size) {
+      // Wait for the rest of the message.
+      break;
+    }
+    const string_view payload(t_buffer.data() + offset + sizeof(header),
+        header.payload_size);
+    offset += sizeof(header) + header.payload_size;
+
+    constexpr unsigned ID_BITS = 32U;
+    const auto key = pair(t_file_desc,
+        (uint64_t{header.process_id} << ID_BITS) | header.id);
+    if (header.type == Type::CREATE) {
+      auto progress = make_unique<Progress>(payload, header.flag != 0U,
+          m_ostream);
+      progress->set_width(m_width);
+      if (m_create_handler) {
+        m_create_handler(*progress);
+      }
+      m_progresses[key] = move(progress);
+      m_draw_requested = true;
+      continue;
+    }
+
+    const auto it = m_progresses.find(key);
+    if (it == m_progresses.cend()) {
+      continue;
+    }
+    auto& progress = *it->second;
+
+    switch (header.type) {
+      case Type::TEXT:
+        progress.set_text(payload);
+        break;
+      case Type::PERCENTS:
+        if (payload.size() == sizeof(double)) {
+          double percents = 0.0;
+          memcpy(&percents, payload.data(), sizeof(percents));
+          progress.set_percents(percents);
+        }
+        break;
+      case Type::DETERMINED:
+        progress.set_determined(header.flag != 0U);
+        break;
+      case Type::FINISH:
+        m_results.push_back(progress.format_result(header.flag != 0U,
+            payload));
+        [[fallthrough]];
+      case Type::REMOVE:
+        m_progresses.erase(it);
+        m_draw_requested = true;
+        break;
+      default:
+        break;
+    }
+  }
+  t_buffer.erase(0U, offset);
+}
+
+void Aggregator::close_source(int t_file_desc) {
+  epoll_ctl(m_epoll_file_desc, EPOLL_CTL_DEL, t_file_desc, nullptr);
+  close(t_file_desc);
+  m_sources.erase(t_file_desc);
+
+  // Writer has gone without finishing its progresses.
+  const auto first = m_progresses.lower_bound(pair(t_file_desc, uint64_t{}));
+  auto last = first;
+  for (; last != m_progresses.cend() && last->first.first == t_file_desc;
+      ++last) {
+    auto& progress = *last->second;
+    m_results.push_back(progress.format_result(false, progress.get_text()));
+  }
+  m_progresses.erase(first, last);
+  m_draw_requested = true;
+}
+
+void Aggregator::draw() {
+  auto output = m_live_area.erase();
+  for (const auto& r : m_results) {
+    output += r + '\n';
+  }
+  m_results.clear();
+
+  string frames;
+  for (auto& [key, progress] : m_progresses) {
+    if (!frames.empty()) {
+      frames += '\n';
+    }
+    frames += progress->render_frame();
+  }
+  m_live_area.set_drawn(frames);
+  m_ostream << output + frames << flush;
+}
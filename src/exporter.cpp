@@ -0,0 +1,240 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+
+#include "fcli/exporter.hpp"
+
+using namespace fcli;
+using namespace std;
+using namespace chrono;
+
+namespace {
+  // Closes a file descriptor on scope exit.
+  struct FileDesc {
+    int value;
+    ~FileDesc() {
+      if (value >= 0) {
+        close(value);
+      }
+    }
+  };
+} // Namespace.
+
+Exporter::Exporter(string t_path, size_t t_slots):
+    m_path(move(t_path)), m_slots(t_slots),
+    m_size(sizeof(Header) + t_slots * sizeof(Slot)) {
+
+  const FileDesc file{open(m_path.c_str(),
+      O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP)};
+  if (file.value < 0) {
+    throw system_error(errno, generic_category(), "couldn't open " + m_path);
+  }
+  // New space is filled with zeros, so all slots are unused.
+  if (ftruncate(file.value, static_cast<off_t>(m_size)) != 0) {
+    throw system_error(errno, generic_category(), "couldn't resize " + m_path);
+  }
+  m_data = mmap(nullptr, m_size,
+      PROT_READ | PROT_WRITE, MAP_SHARED, file.value, 0);
+  if (m_data == MAP_FAILED) {
+    throw system_error(errno, generic_category(), "couldn't map " + m_path);
+  }
+
+  auto& header = *static_cast<Header*>(m_data);
+  header.version = VERSION;
+  header.slots = static_cast<uint32_t>(m_slots);
+  header.slot_size = sizeof(Slot);
+  // Readers check the magic first, so it's written last.
+  atomic_thread_fence(memory_order_release);
+  header.magic = MAGIC;
+}
+
+Exporter::~Exporter() {
+  munmap(m_data, m_size);
+  unlink(m_path.c_str());
+}
+
+void Exporter::attach(Progress& t_progress) {
+  lock_guard lock(m_mut);
+  if (m_entries.count(&t_progress) != 0U) {
+    return;
+  }
+
+  Slot* slot = nullptr;
+  for (size_t i = 0U; i != m_slots; ++i) {
+    if (get_slot(i)->used == 0U) {
+      slot = get_slot(i);
+      break;
+    }
+  }
+  if (slot == nullptr) {
+    throw out_of_range("all slots of the exporter are used");
+  }
+  slot->used = 1U;
+
+  auto& entry = m_entries[&t_progress];
+  entry = {slot, {}, t_progress.get_percents(), steady_clock::now(), 0.0};
+  // Publish the current state as the next frame can be drawn much later.
+  const auto text = t_progress.get_text();
+  publish(entry, {text, t_progress.get_percents(), t_progress.is_determined(),
+      t_progress.get_state(), {}});
+
+  // Entry address is stable, as map nodes aren't moved.
+  entry.handler_id = t_progress.add_frame_handler(
+      [this, &entry] (const Progress::Snapshot& snapshot) {
+    publish(entry, snapshot);
+  });
+}
+
+void Exporter::detach(Progress& t_progress) {
+  m_mut.lock();
+  const auto it = m_entries.find(&t_progress);
+  if (it == m_entries.cend()) {
+    m_mut.unlock();
+    return;
+  }
+  const auto handler_id = it->second.handler_id;
+  m_mut.unlock();
+
+  // Handler is called with the progress locked, so remove it
+  // without own lock to preserve the locking order.
+  t_progress.remove_frame_handler(handler_id);
+
+  lock_guard lock(m_mut);
+  auto& slot = *it->second.slot;
+  const auto sequence = slot.sequence.load(memory_order_relaxed);
+  slot.sequence.store(sequence + 1U, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  slot.used = 0U;
+  slot.sequence.store(sequence + 2U, memory_order_release);
+  m_entries.erase(it);
+}
+
+void Exporter::publish(Entry& t_entry, const Progress::Snapshot& t_snapshot) {
+  const auto now = steady_clock::now();
+  if (const auto passed_time = now - t_entry.rate_time;
+      passed_time >= RATE_INTERVAL) {
+    const auto rate = (t_snapshot.percents - t_entry.rate_percents) /
+        duration<double>(passed_time).count();
+    t_entry.rate += (rate - t_entry.rate) * RATE_SMOOTHING;
+    t_entry.rate_percents = t_snapshot.percents;
+    t_entry.rate_time = now;
+  }
+
+  auto& slot = *t_entry.slot;
+  const auto sequence = slot.sequence.load(memory_order_relaxed);
+  slot.sequence.store(sequence + 1U, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  slot.used = 1U;
+  slot.pid = getpid();
+  slot.state = static_cast<uint32_t>(t_snapshot.state);
+  slot.determined = t_snapshot.determined ? 1U : 0U;
+  slot.percents = t_snapshot.percents;
+  slot.rate = t_entry.rate;
+  slot.updated_ms = duration_cast<milliseconds>(
+      system_clock::now().time_since_epoch()).count();
+  slot.text_size = static_cast<uint32_t>(
+      min(t_snapshot.text.size(), MAX_TEXT_SIZE));
+  memcpy(slot.text, t_snapshot.text.data(), slot.text_size);
+
+  slot.sequence.store(sequence + 2U, memory_order_release);
+}
+
+auto Exporter::get_slot(size_t t_index) const -> Slot* {
+  return reinterpret_cast<Slot*>(static_cast<char*>(m_data) +
+      sizeof(Header) + t_index * sizeof(Slot));
+}
+
+auto Exporter::read(const string& t_path) -> vector<Record> {
+  const FileDesc file{open(t_path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (file.value < 0) {
+    throw system_error(errno, generic_category(), "couldn't open " + t_path);
+  }
+  struct stat status{};
+  if (fstat(file.value, &status) != 0) {
+    throw system_error(errno, generic_category(), "couldn't stat " + t_path);
+  }
+  const auto size = static_cast<size_t>(status.st_size);
+  if (size < sizeof(Header)) {
+    throw format_error();
+  }
+
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file.value, 0);
+  if (data == MAP_FAILED) {
+    throw system_error(errno, generic_category(), "couldn't map " + t_path);
+  }
+  // Unmaps the file on scope exit.
+  const unique_ptr<void, function<void(void*)>> mapping(data,
+      [size] (void* d) { munmap(d, size); });
+
+  const auto& header = *static_cast<const Header*>(data);
+  if (header.magic != MAGIC || header.version != VERSION ||
+      header.slot_size != sizeof(Slot) ||
+      size < sizeof(Header) + header.slots * sizeof(Slot)) {
+    throw format_error();
+  }
+  atomic_thread_fence(memory_order_acquire);
+
+  // Writer could be killed while writing, so don't retry forever.
+  constexpr unsigned MAX_ATTEMPTS = 100U;
+  vector<Record> records;
+  const auto* slots = reinterpret_cast<const Slot*>(
+      static_cast<const char*>(data) + sizeof(Header));
+
+  for (size_t i = 0U; i != header.slots; ++i) {
+    const auto& slot = slots[i];
+    for (unsigned attempt = 0U; attempt != MAX_ATTEMPTS; ++attempt) {
+      const auto sequence = slot.sequence.load(memory_order_acquire);
+      if (sequence % 2U != 0U) {
+        this_thread::yield();
+        continue;
+      }
+
+      const bool used = slot.used != 0U;
+      Record record{slot.pid, string(slot.text,
+          min<size_t>(slot.text_size, MAX_TEXT_SIZE)), slot.percents,
+          slot.determined != 0U, slot.rate,
+          static_cast<Progress::State>(slot.state),
+          milliseconds(slot.updated_ms)};
+
+      atomic_thread_fence(memory_order_acquire);
+      if (slot.sequence.load(memory_order_relaxed) == sequence) {
+        if (used) {
+          records.push_back(move(record));
+        }
+        break;
+      }
+    }
+  }
+  return records;
+}
+
+auto Exporter::get_default_path() -> string {
+  return string(DEFAULT_PATH_PREFIX) + to_string(getpid());
+}
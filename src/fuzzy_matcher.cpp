@@ -0,0 +1,312 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "fcli/fuzzy_matcher.hpp"
+#include "fcli/internal/work_stealing.hpp"
+
+using namespace fcli;
+using namespace fcli::internal;
+using namespace std;
+
+namespace {
+  constexpr int
+      SCORE_MATCH = 16,
+      BONUS_BOUNDARY = 8,
+      BONUS_CONSECUTIVE = 4,
+      PENALTY_GAP_START = 3,
+      PENALTY_GAP_EXTENSION = 1;
+
+  constexpr auto make_lowercase() {
+    array<char, 256U> lowercase{};
+    for (unsigned byte = 0U; byte != lowercase.size(); ++byte) {
+      lowercase[byte] = static_cast<char>(byte >= 'A' && byte <= 'Z' ?
+          byte - 'A' + 'a' : byte);
+    }
+    return lowercase;
+  }
+
+  /*
+   * Bits of lowercase letters and digits are unique, other ASCII characters
+   * share the rest of bits except the last one, which is for non-ASCII
+   * bytes.
+   */
+  constexpr auto make_bits() {
+    constexpr unsigned LETTERS = 26U, DIGITS = 10U, SHARED = 27U;
+    array<uint64_t, 256U> bits{};
+    for (unsigned byte = 0U; byte != bits.size(); ++byte) {
+      const auto c = byte >= 'A' && byte <= 'Z' ? byte - 'A' + 'a' : byte;
+      unsigned bit = 0U;
+      if (c >= 'a' && c <= 'z') {
+        bit = c - 'a';
+      } else if (c >= '0' && c <= '9') {
+        bit = LETTERS + c - '0';
+      } else if (c < 0x80U) {
+        bit = LETTERS + DIGITS + c % SHARED;
+      } else {
+        bit = LETTERS + DIGITS + SHARED;
+      }
+      bits[byte] = uint64_t{1U} << bit;
+    }
+    return bits;
+  }
+
+  constexpr auto LOWERCASE = make_lowercase();
+  constexpr auto BITS = make_bits();
+
+  auto get_mask(string_view t_str) {
+    uint64_t mask = 0U;
+    for (const auto c : t_str) {
+      mask |= BITS[static_cast<unsigned char>(c)];
+    }
+    return mask;
+  }
+
+  auto is_alphanumeric(char t_c) {
+    return (t_c >= 'a' && t_c <= 'z') || (t_c >= 'A' && t_c <= 'Z') ||
+        (t_c >= '0' && t_c <= '9') || static_cast<unsigned char>(t_c) >= 0x80U;
+  }
+
+  // Start of a word, a camel case hump or a number.
+  auto is_boundary(char t_previous, char t_current) {
+    if (!is_alphanumeric(t_previous)) {
+      return is_alphanumeric(t_current);
+    }
+    const auto is_digit = [] (char t_c) { return t_c >= '0' && t_c <= '9'; };
+    return (t_previous >= 'a' && t_previous <= 'z' &&
+        t_current >= 'A' && t_current <= 'Z') ||
+        (!is_digit(t_previous) && is_digit(t_current));
+  }
+} // Namespace.
+
+FuzzyMatcher::FuzzyMatcher(const vector<string>& t_candidates) {
+  size_t size = 0U;
+  for (const auto& candidate : t_candidates) {
+    size += candidate.size();
+  }
+  m_data.reserve(size);
+  m_folded_data.reserve(size);
+  m_offsets.reserve(t_candidates.size() + 1U);
+  m_masks.reserve(t_candidates.size());
+  for (const auto& candidate : t_candidates) {
+    m_data += candidate;
+    for (const auto c : candidate) {
+      m_folded_data += LOWERCASE[static_cast<unsigned char>(c)];
+    }
+    m_offsets.push_back(m_data.size());
+    m_masks.push_back(get_mask(candidate));
+  }
+  select_top();
+}
+
+void FuzzyMatcher::set_query(string_view t_query) {
+  if (t_query == m_query) {
+    return;
+  }
+  // Previous matches include all matches of the longer query.
+  const bool extends = !m_query.empty() &&
+      t_query.substr(0U, m_query.size()) == m_query;
+  m_query = t_query;
+  m_case_sensitive = any_of(m_query.cbegin(), m_query.cend(),
+      [] (char t_c) { return t_c >= 'A' && t_c <= 'Z'; });
+  m_folded_query = m_query;
+  if (!m_case_sensitive) {
+    for (auto& c : m_folded_query) {
+      c = LOWERCASE[static_cast<unsigned char>(c)];
+    }
+  }
+  m_query_mask = get_mask(m_query);
+
+  if (m_query.empty()) {
+    m_matches.clear();
+    select_top();
+    return;
+  }
+
+  const auto count = extends ? m_matches.size() : get_candidates_count();
+  WorkStealing scheduler(count, count < PARALLEL_THRESHOLD ? 1U : 0U);
+  const auto chunk_size = scheduler.get_chunk_size();
+  const auto chunks_count = (count + chunk_size - 1U) / chunk_size;
+  vector<vector<uint32_t>> chunk_matches(chunks_count);
+  vector<vector<Match>> chunk_tops(chunks_count);
+
+  scheduler.run([&] (size_t t_first, size_t t_last) {
+    auto& matches = chunk_matches[t_first / chunk_size];
+    auto& top = chunk_tops[t_first / chunk_size];
+    for (auto i = t_first; i != t_last; ++i) {
+      const size_t index = extends ? m_matches[i] : i;
+      if ((m_query_mask & ~m_masks[index]) != 0U) {
+        continue;
+      }
+      Match match{index, 0};
+      if (score(index, match.score)) {
+        matches.push_back(static_cast<uint32_t>(index));
+        push_top(top, match);
+      }
+    }
+  });
+
+  m_matches.clear();
+  for (const auto& matches : chunk_matches) {
+    m_matches.insert(m_matches.cend(), matches.cbegin(), matches.cend());
+  }
+  merge_tops(chunk_tops);
+}
+
+auto FuzzyMatcher::get_positions(size_t t_index) const -> vector<size_t> {
+  vector<size_t> positions;
+  int score = 0;
+  if (!this->score(t_index, score, &positions)) {
+    positions.clear();
+  }
+  return positions;
+}
+
+void FuzzyMatcher::set_top_count(size_t t_count) {
+  // The best matches of the smaller top are already sorted.
+  if (t_count <= m_top.size()) {
+    m_top.resize(t_count);
+  } else if (t_count > m_top_count && m_top.size() == m_top_count) {
+    // The top that isn't full already has all matches.
+    m_top_count = t_count;
+    select_top();
+  }
+  m_top_count = t_count;
+}
+
+auto FuzzyMatcher::score(size_t t_index, int& t_score,
+    vector<size_t>* t_positions) const -> bool {
+  const auto candidate = get_candidate(t_index);
+  const auto* const begin =
+      (m_case_sensitive ? m_data : m_folded_data).data() + m_offsets[t_index];
+  const string_view query = m_folded_query;
+
+  // End of the first occurrence of the query.
+  size_t end = 0U;
+  for (const auto c : query) {
+    const auto* const found = static_cast<const char*>(
+        memchr(begin + end, c, candidate.size() - end));
+    if (found == nullptr) {
+      return false;
+    }
+    end = static_cast<size_t>(found - begin) + 1U;
+  }
+
+  // The latest start of an occurrence that ends there is the shortest one.
+  auto start = end;
+  for (auto remaining = query.size(); remaining != 0U;) {
+    if (begin[--start] == query[remaining - 1U]) {
+      --remaining;
+    }
+  }
+
+  t_score = 0;
+  size_t matched = 0U, previous = 0U;
+  for (auto i = start; i != end && matched != query.size(); ++i) {
+    if (begin[i] != query[matched]) {
+      continue;
+    }
+    t_score += SCORE_MATCH;
+    if (i == 0U || is_boundary(candidate[i - 1U], candidate[i])) {
+      t_score += BONUS_BOUNDARY;
+    }
+    if (matched != 0U) {
+      const auto gap = static_cast<int>(i - previous - 1U);
+      t_score += gap == 0 ? BONUS_CONSECUTIVE :
+          -PENALTY_GAP_START - (gap - 1) * PENALTY_GAP_EXTENSION;
+    }
+    if (t_positions != nullptr) {
+      t_positions->push_back(i);
+    }
+    previous = i;
+    ++matched;
+  }
+  return true;
+}
+
+auto FuzzyMatcher::is_better(const Match& t_first, const Match& t_second) const
+    -> bool {
+  if (t_first.score != t_second.score) {
+    return t_first.score > t_second.score;
+  }
+  if (!m_query.empty()) {
+    const auto first_size = m_offsets[t_first.index + 1U] -
+        m_offsets[t_first.index];
+    const auto second_size = m_offsets[t_second.index + 1U] -
+        m_offsets[t_second.index];
+    if (first_size != second_size) {
+      return first_size < second_size;
+    }
+  }
+  return t_first.index < t_second.index;
+}
+
+void FuzzyMatcher::push_top(vector<Match>& t_heap, const Match& t_match) const {
+  // The worst match is on the top of the heap.
+  const auto better = [this] (const Match& t_first, const Match& t_second) {
+    return is_better(t_first, t_second);
+  };
+  if (t_heap.size() < m_top_count) {
+    t_heap.push_back(t_match);
+    push_heap(t_heap.begin(), t_heap.end(), better);
+  } else if (m_top_count != 0U && better(t_match, t_heap.front())) {
+    pop_heap(t_heap.begin(), t_heap.end(), better);
+    t_heap.back() = t_match;
+    push_heap(t_heap.begin(), t_heap.end(), better);
+  }
+}
+
+void FuzzyMatcher::select_top() {
+  if (m_query.empty()) {
+    // All candidates in the original order.
+    m_top.clear();
+    for (size_t i = 0U; i != min(get_candidates_count(), m_top_count); ++i) {
+      m_top.push_back({i, 0});
+    }
+    return;
+  }
+  // Scores aren't kept, since the top is rarely extended.
+  const auto count = m_matches.size();
+  WorkStealing scheduler(count, count < PARALLEL_THRESHOLD ? 1U : 0U);
+  const auto chunk_size = scheduler.get_chunk_size();
+  vector<vector<Match>> chunk_tops((count + chunk_size - 1U) / chunk_size);
+
+  scheduler.run([&] (size_t t_first, size_t t_last) {
+    auto& top = chunk_tops[t_first / chunk_size];
+    for (auto i = t_first; i != t_last; ++i) {
+      Match match{m_matches[i], 0};
+      (void)score(match.index, match.score);
+      push_top(top, match);
+    }
+  });
+  merge_tops(chunk_tops);
+}
+
+void FuzzyMatcher::merge_tops(const vector<vector<Match>>& t_chunk_tops) {
+  m_top.clear();
+  for (const auto& top : t_chunk_tops) {
+    m_top.insert(m_top.cend(), top.cbegin(), top.cend());
+  }
+  sort(m_top.begin(), m_top.end(),
+      [this] (const Match& t_first, const Match& t_second) {
+    return is_better(t_first, t_second);
+  });
+  m_top.resize(min(m_top.size(), m_top_count));
+}
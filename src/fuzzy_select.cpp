@@ -0,0 +1,237 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "fcli/fuzzy_select.hpp"
+#include "fcli/internal/unicode.hpp"
+#include "fcli/text.hpp"
+
+using namespace fcli;
+using namespace std;
+
+namespace {
+  auto is_continuation(char t_c) {
+    return (static_cast<unsigned char>(t_c) & 0xC0U) == 0x80U;
+  }
+} // Namespace.
+
+FuzzySelect::FuzzySelect(const vector<string>& t_candidates,
+    const optional<Terminal::ColorsSupport>& t_colors_support,
+    const Palette& t_palette): m_matcher(t_candidates),
+    m_match_style(Text::format_copy("~g~", t_colors_support, t_palette)),
+    m_selection_style(Text::format_copy("<b>", t_colors_support, t_palette)),
+    m_info_style(Text::format_copy("~d~", t_colors_support, t_palette)),
+    m_reset_style(Text::format_copy("<r>", t_colors_support, t_palette)) {}
+
+auto FuzzySelect::run(Input& t_input, Screen& t_screen) -> optional<size_t> {
+  m_chosen = m_cancelled = false;
+  draw(t_screen);
+  t_screen.present();
+  t_input.run([this, &t_input, &t_screen] (const Input::Event& t_event) {
+    // Events that are already read after the end.
+    if (m_chosen || m_cancelled) {
+      return;
+    }
+    if (!handle(t_event)) {
+      t_input.stop();
+      return;
+    }
+    draw(t_screen);
+    t_screen.present();
+  });
+  return m_chosen ? get_selected() : nullopt;
+}
+
+auto FuzzySelect::handle(const Input::Event& t_event) -> bool {
+  using Key = Input::Key;
+  const auto page = static_cast<long>(m_rows);
+  const bool ctrl = (t_event.modifiers & Input::CTRL) != 0U;
+  const bool plain = (t_event.modifiers & (Input::CTRL | Input::ALT)) == 0U;
+
+  switch (t_event.key) {
+    case Key::CHARACTER:
+      if (ctrl) {
+        switch (t_event.code_point) {
+          case U'c': case U'g':
+            m_cancelled = true;
+            return false;
+          case U'u':
+            set_query({});
+            break;
+          case U'p':
+            move_selection(-1);
+            break;
+          case U'n':
+            move_selection(1);
+            break;
+          default:
+            break;
+        }
+      } else if (plain) {
+        auto query = get_query();
+        internal::unicode::encode(t_event.code_point, query);
+        set_query(query);
+      }
+      break;
+    case Key::PASTE: {
+      auto query = get_query();
+      for (const auto c : t_event.text) {
+        if (static_cast<unsigned char>(c) >= ' ') {
+          query += c;
+        }
+      }
+      set_query(query);
+      break;
+    }
+    case Key::BACKSPACE: {
+      auto query = get_query();
+      while (!query.empty() && is_continuation(query.back())) {
+        query.pop_back();
+      }
+      if (!query.empty()) {
+        query.pop_back();
+      }
+      set_query(query);
+      break;
+    }
+    case Key::ENTER:
+      m_chosen = get_selected().has_value();
+      return !m_chosen;
+    case Key::ESCAPE:
+      m_cancelled = true;
+      return false;
+    case Key::UP:
+      move_selection(-1);
+      break;
+    case Key::DOWN:
+      move_selection(1);
+      break;
+    case Key::PAGE_UP:
+      move_selection(-page);
+      break;
+    case Key::PAGE_DOWN:
+      move_selection(page);
+      break;
+    case Key::MOUSE:
+      if (t_event.mouse.action == Input::Mouse::Action::SCROLL_UP) {
+        move_selection(-1);
+      } else if (t_event.mouse.action == Input::Mouse::Action::SCROLL_DOWN) {
+        move_selection(1);
+      }
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+void FuzzySelect::draw(Screen& t_screen) {
+  constexpr unsigned short MATCHES_ROW = 2U;
+  const auto height = t_screen.get_height();
+  m_rows = height > MATCHES_ROW ?
+      static_cast<unsigned short>(height - MATCHES_ROW) : 1U;
+  extend_top();
+
+  t_screen.clear();
+  t_screen.draw_text(0U, 0U, m_prompt + get_query());
+  t_screen.draw_text(0U, 1U, m_info_style +
+      to_string(m_matcher.get_matches_count()) + '/' +
+      to_string(m_matcher.get_candidates_count()) + m_reset_style);
+
+  const auto& top = m_matcher.get_top();
+  string line;
+  for (unsigned short row = 0U; row != m_rows; ++row) {
+    const auto position = m_offset + row;
+    if (position >= top.size() || MATCHES_ROW + row >= height) {
+      break;
+    }
+    const auto index = top[position].index;
+    const auto candidate = m_matcher.get_candidate(index);
+    const auto matched = m_matcher.get_positions(index);
+    const auto& base_style = position == m_selection ?
+        m_selection_style : m_reset_style;
+
+    line = base_style;
+    line += position == m_selection ? "> " : "  ";
+    // Styles are changed only between code points.
+    auto next_matched = matched.cbegin();
+    bool highlighted = false;
+    for (size_t begin = 0U; begin != candidate.size();) {
+      auto end = begin + 1U;
+      while (end != candidate.size() && is_continuation(candidate[end])) {
+        ++end;
+      }
+      bool is_matched = false;
+      for (; next_matched != matched.cend() && *next_matched < end;
+          ++next_matched) {
+        is_matched = true;
+      }
+      if (is_matched != highlighted) {
+        line += is_matched ? m_match_style : m_reset_style + base_style;
+        highlighted = is_matched;
+      }
+      line.append(candidate.substr(begin, end - begin));
+      begin = end;
+    }
+    line += m_reset_style;
+    t_screen.draw_text(0U, static_cast<unsigned short>(MATCHES_ROW + row),
+        line);
+  }
+}
+
+auto FuzzySelect::get_selected() const -> optional<size_t> {
+  const auto& top = m_matcher.get_top();
+  if (m_selection >= top.size()) {
+    return {};
+  }
+  return top[m_selection].index;
+}
+
+void FuzzySelect::set_query(string_view t_query) {
+  // Top that was extended by scrolling is shrunk back.
+  m_matcher.set_top_count(
+      max<size_t>(m_rows, FuzzyMatcher::DEFAULT_TOP_COUNT));
+  m_matcher.set_query(t_query);
+  m_selection = m_offset = 0U;
+}
+
+void FuzzySelect::move_selection(long t_offset) {
+  const auto count = m_matcher.get_matches_count();
+  if (count == 0U) {
+    return;
+  }
+  const auto selection = clamp(static_cast<long>(m_selection) + t_offset,
+      0L, static_cast<long>(count) - 1L);
+  m_selection = static_cast<size_t>(selection);
+  if (m_selection < m_offset) {
+    m_offset = m_selection;
+  } else if (m_selection >= m_offset + m_rows) {
+    m_offset = m_selection - m_rows + 1U;
+  }
+  // Matches below the top are selected from all matches.
+  extend_top();
+}
+
+void FuzzySelect::extend_top() {
+  const auto needed = m_offset + m_rows;
+  const auto count = m_matcher.get_top_count();
+  if (count < needed) {
+    // Doubled, so scrolling down rescores matches only a few times.
+    m_matcher.set_top_count(max(needed, count * 2U));
+  }
+}
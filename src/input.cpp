@@ -0,0 +1,203 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cerrno>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <system_error>
+
+#include "fcli/input.hpp"
+#include "fcli/internal/input_decoder.hpp"
+
+using namespace fcli;
+using namespace fcli::internal;
+using namespace std;
+using namespace chrono;
+
+namespace {
+  constexpr string_view
+      ENABLE_PASTE = "\033[?2004h",
+      DISABLE_PASTE = "\033[?2004l",
+      // Clicks, moves with pressed buttons and the SGR format of reports.
+      ENABLE_MOUSE = "\033[?1000h\033[?1002h\033[?1006h",
+      DISABLE_MOUSE = "\033[?1006l\033[?1002l\033[?1000l";
+
+  void watch(int t_epoll_file_desc, int t_file_desc) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = t_file_desc;
+    if (epoll_ctl(t_epoll_file_desc, EPOLL_CTL_ADD, t_file_desc, &event) != 0) {
+      throw system_error(errno, generic_category(), "couldn't watch input");
+    }
+  }
+} // Namespace.
+
+Input::Input(int t_in_file_desc, const Terminal& t_terminal):
+    m_in_file_desc(t_in_file_desc),
+    m_out_file_desc(t_terminal.get_out_file_desc()),
+    m_epoll_file_desc(epoll_create1(EPOLL_CLOEXEC)),
+    m_stop_file_desc(eventfd(0U, EFD_CLOEXEC | EFD_NONBLOCK)),
+    m_decoder(make_unique<InputDecoder>()) {
+
+  try {
+    if (m_epoll_file_desc < 0 || m_stop_file_desc < 0) {
+      throw system_error(errno, generic_category(), "couldn't create epoll");
+    }
+    watch(m_epoll_file_desc, m_in_file_desc);
+    watch(m_epoll_file_desc, m_stop_file_desc);
+    if (tcgetattr(m_in_file_desc, &m_saved_mode) != 0) {
+      throw system_error(errno, generic_category(),
+          "couldn't get mode of input");
+    }
+
+    auto raw = m_saved_mode;
+    raw.c_iflag &= ~static_cast<tcflag_t>(
+        IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+    // Output processing is kept, so new lines of the output aren't changed.
+    raw.c_lflag &= ~static_cast<tcflag_t>(ECHO | ECHONL | ICANON | ISIG |
+        IEXTEN);
+    raw.c_cflag = (raw.c_cflag & ~static_cast<tcflag_t>(CSIZE | PARENB)) | CS8;
+    raw.c_cc[VMIN] = 1U;
+    raw.c_cc[VTIME] = 0U;
+    if (tcsetattr(m_in_file_desc, TCSANOW, &raw) != 0) {
+      throw system_error(errno, generic_category(),
+          "couldn't switch input to the raw mode");
+    }
+  } catch (...) {
+    if (m_epoll_file_desc >= 0) {
+      close(m_epoll_file_desc);
+    }
+    if (m_stop_file_desc >= 0) {
+      close(m_stop_file_desc);
+    }
+    throw;
+  }
+  write_sequence(ENABLE_PASTE);
+}
+
+Input::~Input() {
+  set_mouse_tracking(false);
+  write_sequence(DISABLE_PASTE);
+  tcsetattr(m_in_file_desc, TCSANOW, &m_saved_mode);
+  close(m_epoll_file_desc);
+  close(m_stop_file_desc);
+}
+
+auto Input::wait(milliseconds t_timeout) -> optional<Event> {
+  const auto deadline = steady_clock::now() + t_timeout;
+  m_stopped = false;
+  while (m_events.empty()) {
+    const auto now = steady_clock::now();
+    if (m_decoder->is_pending() && now >= m_last_read + ESCAPE_TIMEOUT) {
+      m_decoder->flush(m_events);
+      continue;
+    }
+    if (now >= deadline) {
+      return {};
+    }
+
+    auto timeout = deadline - now;
+    if (m_decoder->is_pending()) {
+      timeout = min(timeout, m_last_read + ESCAPE_TIMEOUT - now);
+    }
+    if (!read_input(ceil<milliseconds>(timeout)) && m_stopped) {
+      return {};
+    }
+  }
+
+  auto event = move(m_events.front());
+  m_events.pop_front();
+  return event;
+}
+
+void Input::run(const function<void(const Event&)>& t_handler) {
+  constexpr milliseconds MAX_TIMEOUT = 1h;
+  while (true) {
+    const auto event = wait(MAX_TIMEOUT);
+    if (event) {
+      t_handler(*event);
+    } else if (m_stopped) {
+      return;
+    }
+  }
+}
+
+void Input::stop() {
+  const uint64_t increment = 1U;
+  // Counter can't overflow in practice, so the result is ignored.
+  [[maybe_unused]] const auto written =
+      write(m_stop_file_desc, &increment, sizeof(increment));
+}
+
+void Input::set_mouse_tracking(bool t_enable) {
+  if (m_mouse_tracking == t_enable) {
+    return;
+  }
+  m_mouse_tracking = t_enable;
+  write_sequence(t_enable ? ENABLE_MOUSE : DISABLE_MOUSE);
+}
+
+auto Input::read_input(milliseconds t_timeout) -> bool {
+  constexpr int MAX_EVENTS = 2;
+  array<epoll_event, MAX_EVENTS> events{};
+  int count = 0;
+  do {
+    count = epoll_wait(m_epoll_file_desc, events.data(), MAX_EVENTS,
+        static_cast<int>(t_timeout.count()));
+  } while (count < 0 && errno == EINTR);
+  if (count < 0) {
+    throw system_error(errno, generic_category(), "couldn't wait for input");
+  }
+
+  for (int i = 0; i != count; ++i) {
+    if (events.at(static_cast<size_t>(i)).data.fd == m_stop_file_desc) {
+      uint64_t value = 0U;
+      [[maybe_unused]] const auto size =
+          read(m_stop_file_desc, &value, sizeof(value));
+      m_stopped = true;
+      continue;
+    }
+
+    // Input is ready, so the read doesn't block.
+    const auto size = read(m_in_file_desc,
+        m_read_buffer.data(), m_read_buffer.size());
+    if (size > 0) {
+      m_decoder->feed(string_view(m_read_buffer.data(),
+          static_cast<size_t>(size)), m_events);
+      m_last_read = steady_clock::now();
+    } else if (size == 0 || (errno != EINTR && errno != EAGAIN)) {
+      // Hang up of the terminal.
+      m_stopped = true;
+    }
+  }
+  return count != 0 && !m_stopped;
+}
+
+void Input::write_sequence(string_view t_sequence) const {
+  while (!t_sequence.empty()) {
+    const auto written =
+        write(m_out_file_desc, t_sequence.data(), t_sequence.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    t_sequence.remove_prefix(static_cast<size_t>(written));
+  }
+}
@@ -0,0 +1,434 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <charconv>
+
+#include "fcli/internal/input_decoder.hpp"
+#include "fcli/internal/unicode.hpp"
+
+using namespace std;
+
+using namespace fcli;
+using namespace fcli::internal;
+
+namespace {
+  using Action = InputDecoder::Action;
+  using State = InputDecoder::State;
+  using Transition = InputDecoder::Transition;
+  using Key = Input::Key;
+
+  enum ByteClass {
+    CONTROL, ESCAPE, INTERMEDIATE, PARAMETER, FINAL, CSI_INTRODUCER,
+    SS3_INTRODUCER, DELETE, CONTINUATION, LEAD, INVALID, CLASSES_COUNT
+  };
+
+  constexpr auto make_classes() {
+    array<ByteClass, 256U> classes{};
+    for (unsigned byte = 0U; byte != classes.size(); ++byte) {
+      auto& byte_class = classes[byte];
+      if (byte == 0x1BU) {
+        byte_class = ESCAPE;
+      } else if (byte < 0x20U) {
+        byte_class = CONTROL;
+      } else if (byte < 0x30U) {
+        byte_class = INTERMEDIATE;
+      } else if (byte < 0x40U) {
+        byte_class = PARAMETER;
+      } else if (byte == '[') {
+        byte_class = CSI_INTRODUCER;
+      } else if (byte == 'O') {
+        byte_class = SS3_INTRODUCER;
+      } else if (byte < 0x7FU) {
+        byte_class = FINAL;
+      } else if (byte == 0x7FU) {
+        byte_class = DELETE;
+      } else if (byte < 0xC0U) {
+        byte_class = CONTINUATION;
+      } else if (byte >= 0xC2U && byte <= 0xF4U) {
+        byte_class = LEAD;
+      } else {
+        byte_class = INVALID;
+      }
+    }
+    return classes;
+  }
+
+  constexpr auto CLASSES = make_classes();
+
+  constexpr Transition
+      TO_GROUND{Action::ABORT, State::GROUND},
+      PRINT{Action::PRINT, State::GROUND},
+      EXECUTE{Action::CONTROL, State::GROUND},
+      REPLACE{Action::INVALID, State::GROUND},
+      START_UTF8{Action::UTF8_START, State::UTF8};
+
+  // Rows are states except PASTE, columns are byte classes.
+  constexpr array<array<Transition, CLASSES_COUNT>, 5U> TRANSITIONS{{
+    // Ground.
+    {{EXECUTE, {Action::ESCAPE, State::ESCAPE}, PRINT, PRINT, PRINT, PRINT,
+        PRINT, EXECUTE, REPLACE, START_UTF8, REPLACE}},
+    // Escape: the next key is with the alt modifier or a sequence starts.
+    {{EXECUTE, {Action::ESCAPE_KEY, State::ESCAPE}, PRINT, PRINT, PRINT,
+        {Action::START, State::CSI}, {Action::START, State::SS3}, EXECUTE,
+        REPLACE, START_UTF8, REPLACE}},
+    // Control sequence.
+    {{TO_GROUND, TO_GROUND, {Action::COLLECT, State::CSI},
+        {Action::COLLECT, State::CSI}, {Action::DISPATCH, State::GROUND},
+        {Action::DISPATCH, State::GROUND}, {Action::DISPATCH, State::GROUND},
+        {Action::NONE, State::CSI}, TO_GROUND, TO_GROUND, TO_GROUND}},
+    // Single shift 3: function keys of the application mode.
+    {{TO_GROUND, TO_GROUND, TO_GROUND, {Action::COLLECT, State::SS3},
+        {Action::DISPATCH, State::GROUND}, {Action::DISPATCH, State::GROUND},
+        {Action::DISPATCH, State::GROUND}, TO_GROUND, TO_GROUND, TO_GROUND,
+        TO_GROUND}},
+    // Continuation bytes of a character.
+    {{TO_GROUND, TO_GROUND, TO_GROUND, TO_GROUND, TO_GROUND, TO_GROUND,
+        TO_GROUND, TO_GROUND, {Action::UTF8_CONTINUE, State::UTF8},
+        TO_GROUND, TO_GROUND}}
+  }};
+
+  constexpr string_view PASTE_END = "\033[201~";
+  constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFDU;
+  // Longer sequences are malformed, their parameters aren't kept.
+  constexpr size_t MAX_SEQUENCE_SIZE = 64U;
+
+  // Returns the parameter or the default value if it's omitted.
+  auto get_parameter(string_view t_parameters, size_t t_index,
+      unsigned t_default) {
+    for (; t_index != 0U; --t_index) {
+      const auto separator = t_parameters.find(';');
+      if (separator == string_view::npos) {
+        return t_default;
+      }
+      t_parameters.remove_prefix(separator + 1U);
+    }
+    unsigned value = 0U;
+    const auto* const end = t_parameters.data() + t_parameters.size();
+    const auto [last, error] = from_chars(t_parameters.data(), end, value);
+    return error == errc() && last != t_parameters.data() ? value : t_default;
+  }
+
+  // Parameter of modifiers is one plus their bits.
+  auto get_modifiers(unsigned t_parameter) {
+    return static_cast<uint8_t>((t_parameter - 1U) &
+        (Input::SHIFT | Input::ALT | Input::CTRL));
+  }
+
+  // Keys of "CSI number ~" sequences.
+  auto get_tilde_key(unsigned t_number) {
+    switch (t_number) {
+      case 1U: case 7U: return Key::HOME;
+      case 2U: return Key::INSERT;
+      case 3U: return Key::DELETE;
+      case 4U: case 8U: return Key::END;
+      case 5U: return Key::PAGE_UP;
+      case 6U: return Key::PAGE_DOWN;
+      case 11U: return Key::F1;
+      case 12U: return Key::F2;
+      case 13U: return Key::F3;
+      case 14U: return Key::F4;
+      case 15U: return Key::F5;
+      case 17U: return Key::F6;
+      case 18U: return Key::F7;
+      case 19U: return Key::F8;
+      case 20U: return Key::F9;
+      case 21U: return Key::F10;
+      case 23U: return Key::F11;
+      case 24U: return Key::F12;
+      default: return Key::UNKNOWN;
+    }
+  }
+
+  // Keys of final bytes that are common for CSI and SS3 sequences.
+  auto get_final_key(char t_final) {
+    switch (t_final) {
+      case 'A': return Key::UP;
+      case 'B': return Key::DOWN;
+      case 'C': return Key::RIGHT;
+      case 'D': return Key::LEFT;
+      case 'H': return Key::HOME;
+      case 'F': return Key::END;
+      case 'P': return Key::F1;
+      case 'Q': return Key::F2;
+      case 'R': return Key::F3;
+      case 'S': return Key::F4;
+      default: return Key::UNKNOWN;
+    }
+  }
+} // Namespace.
+
+void InputDecoder::feed(string_view t_data, deque<Input::Event>& t_events) {
+  for (size_t pos = 0U; pos != t_data.size();) {
+    if (m_state == State::PASTE) {
+      pos += feed_paste(t_data.substr(pos), t_events);
+      continue;
+    }
+    if (m_state == State::GROUND && !m_alt) {
+      // Typed or pasted without the bracketed mode text.
+      const auto length = unicode::get_printable_ascii_length(
+          t_data.substr(pos));
+      for (const auto c : t_data.substr(pos, length)) {
+        emit(t_events, Key::CHARACTER, static_cast<unsigned char>(c));
+      }
+      pos += length;
+      if (pos == t_data.size()) {
+        break;
+      }
+    }
+
+    const auto byte = t_data[pos];
+    const auto& transition = TRANSITIONS.at(static_cast<size_t>(m_state))
+        [CLASSES[static_cast<unsigned char>(byte)]];
+    if (transition.action == Action::ABORT) {
+      flush(t_events);
+      continue;
+    }
+    const auto previous = m_state;
+    m_state = transition.state;
+    execute(transition.action, previous, byte, t_events);
+    ++pos;
+  }
+}
+
+void InputDecoder::flush(deque<Input::Event>& t_events) {
+  const uint8_t alt = m_alt ? Input::ALT : 0U;
+  switch (m_state) {
+    case State::ESCAPE:
+      emit(t_events, Key::ESCAPE);
+      break;
+    case State::CSI: case State::SS3:
+      if (m_sequence.empty()) {
+        // Alt with the introducer.
+        emit(t_events, Key::CHARACTER, m_state == State::CSI ? '[' : 'O',
+            Input::ALT);
+      } else {
+        emit(t_events, Key::UNKNOWN).text =
+            (m_state == State::CSI ? "\033[" : "\033O") + m_sequence;
+      }
+      break;
+    case State::UTF8:
+      emit(t_events, Key::CHARACTER, REPLACEMENT_CHARACTER, alt);
+      break;
+    case State::GROUND: case State::PASTE:
+      return;
+  }
+  m_state = State::GROUND;
+  m_sequence.clear();
+  m_alt = false;
+}
+
+auto InputDecoder::is_pending() const -> bool {
+  return m_state != State::GROUND && m_state != State::PASTE;
+}
+
+void InputDecoder::execute(Action t_action, State t_previous, char t_byte,
+    deque<Input::Event>& t_events) {
+  const auto byte = static_cast<unsigned char>(t_byte);
+  const uint8_t alt = m_alt ? Input::ALT : 0U;
+  switch (t_action) {
+    case Action::NONE: case Action::ABORT:
+      break;
+    case Action::PRINT:
+      emit(t_events, Key::CHARACTER, byte, alt);
+      m_alt = false;
+      break;
+    case Action::CONTROL:
+      if (byte == '\r' || byte == '\n') {
+        emit(t_events, Key::ENTER, 0U, alt);
+      } else if (byte == '\t') {
+        emit(t_events, Key::TAB, 0U, alt);
+      } else if (byte == '\b' || byte == 0x7FU) {
+        emit(t_events, Key::BACKSPACE, 0U, alt);
+      } else if (byte == 0U) {
+        emit(t_events, Key::CHARACTER, ' ', alt | Input::CTRL);
+      } else if (byte <= 0x1AU) {
+        emit(t_events, Key::CHARACTER, U'a' + byte - 1U, alt | Input::CTRL);
+      } else {
+        // Ctrl with one of "\]^_".
+        emit(t_events, Key::CHARACTER, U'@' + byte, alt | Input::CTRL);
+      }
+      m_alt = false;
+      break;
+    case Action::ESCAPE:
+      m_alt = true;
+      break;
+    case Action::ESCAPE_KEY:
+      emit(t_events, Key::ESCAPE);
+      break;
+    case Action::START:
+      m_sequence.clear();
+      m_alt = false;
+      break;
+    case Action::COLLECT:
+      if (m_sequence.size() != MAX_SEQUENCE_SIZE) {
+        m_sequence += t_byte;
+      }
+      break;
+    case Action::DISPATCH:
+      if (t_previous == State::CSI) {
+        dispatch_csi(t_byte, t_events);
+      } else {
+        dispatch_ss3(t_byte, t_events);
+      }
+      if (m_state != State::PASTE) {
+        m_sequence.clear();
+      }
+      break;
+    case Action::UTF8_START:
+      m_sequence.assign(1U, t_byte);
+      m_utf8_remaining = byte >= 0xF0U ? 3U : byte >= 0xE0U ? 2U : 1U;
+      break;
+    case Action::UTF8_CONTINUE:
+      m_sequence += t_byte;
+      if (--m_utf8_remaining == 0U) {
+        char32_t code_point = 0U;
+        if (unicode::decode(m_sequence, 0U, code_point) == 0U) {
+          // Overlong form or surrogate.
+          code_point = REPLACEMENT_CHARACTER;
+        }
+        emit(t_events, Key::CHARACTER, code_point, alt);
+        m_state = State::GROUND;
+        m_sequence.clear();
+        m_alt = false;
+      }
+      break;
+    case Action::INVALID:
+      emit(t_events, Key::CHARACTER, REPLACEMENT_CHARACTER, alt);
+      m_alt = false;
+      break;
+  }
+}
+
+void InputDecoder::dispatch_csi(char t_final, deque<Input::Event>& t_events) {
+  if (!m_sequence.empty() && m_sequence.front() == '<') {
+    dispatch_mouse(t_final, t_events);
+    return;
+  }
+  const auto modifiers = get_modifiers(get_parameter(m_sequence, 1U, 1U));
+  auto key = get_final_key(t_final);
+  char32_t code_point = 0U;
+  if (t_final == '~') {
+    const auto number = get_parameter(m_sequence, 0U, 0U);
+    if (number == 200U) {
+      m_state = State::PASTE;
+      m_sequence.clear();
+      return;
+    }
+    // The end of a paste without the start.
+    if (number == 201U) {
+      return;
+    }
+    key = get_tilde_key(number);
+  } else if (t_final == 'Z') {
+    emit(t_events, Key::TAB, 0U, Input::SHIFT);
+    return;
+  } else if (t_final == 'u') {
+    // Keys with modifiers that terminals send as "CSI code ; modifiers u".
+    code_point = get_parameter(m_sequence, 0U, 0U);
+    switch (code_point) {
+      case '\r': key = Key::ENTER; break;
+      case '\t': key = Key::TAB; break;
+      case 0x7FU: key = Key::BACKSPACE; break;
+      case 0x1BU: key = Key::ESCAPE; break;
+      default: key = Key::CHARACTER; break;
+    }
+    if (key != Key::CHARACTER) {
+      code_point = 0U;
+    }
+  }
+
+  if (key == Key::UNKNOWN) {
+    emit(t_events, key).text = "\033[" + m_sequence + t_final;
+    return;
+  }
+  emit(t_events, key, code_point, modifiers);
+}
+
+void InputDecoder::dispatch_ss3(char t_final, deque<Input::Event>& t_events) {
+  const auto key = get_final_key(t_final);
+  if (key == Key::UNKNOWN) {
+    emit(t_events, key).text = "\033O" + m_sequence + t_final;
+    return;
+  }
+  emit(t_events, key, 0U, get_modifiers(get_parameter(m_sequence, 0U, 1U)));
+}
+
+void InputDecoder::dispatch_mouse(char t_final,
+    deque<Input::Event>& t_events) {
+  if (t_final != 'M' && t_final != 'm') {
+    emit(t_events, Key::UNKNOWN).text = "\033[" + m_sequence + t_final;
+    return;
+  }
+  // SGR format: "CSI < buttons ; column ; row M" or "m" on release.
+  constexpr unsigned
+      BUTTON_BITS = 0x03U, SHIFT_BIT = 0x04U, ALT_BIT = 0x08U,
+      CTRL_BIT = 0x10U, MOTION_BIT = 0x20U, WHEEL_BIT = 0x40U;
+  const auto parameters = string_view(m_sequence).substr(1U);
+  const auto buttons = get_parameter(parameters, 0U, 0U);
+
+  auto& event = emit(t_events, Key::MOUSE);
+  auto& mouse = event.mouse;
+  event.modifiers = static_cast<uint8_t>(
+      ((buttons & SHIFT_BIT) != 0U ? Input::SHIFT : 0U) |
+      ((buttons & ALT_BIT) != 0U ? Input::ALT : 0U) |
+      ((buttons & CTRL_BIT) != 0U ? Input::CTRL : 0U));
+  mouse.button = static_cast<uint8_t>(buttons & BUTTON_BITS);
+  if ((buttons & WHEEL_BIT) != 0U) {
+    mouse.action = mouse.button == 0U ?
+        Input::Mouse::Action::SCROLL_UP : Input::Mouse::Action::SCROLL_DOWN;
+    mouse.button = 0U;
+  } else if ((buttons & MOTION_BIT) != 0U) {
+    mouse.action = Input::Mouse::Action::MOVE;
+  } else {
+    mouse.action = t_final == 'M' ?
+        Input::Mouse::Action::PRESS : Input::Mouse::Action::RELEASE;
+  }
+  // Coordinates are one-based.
+  mouse.x = static_cast<unsigned short>(
+      max(get_parameter(parameters, 1U, 1U), 1U) - 1U);
+  mouse.y = static_cast<unsigned short>(
+      max(get_parameter(parameters, 2U, 1U), 1U) - 1U);
+}
+
+auto InputDecoder::feed_paste(string_view t_data,
+    deque<Input::Event>& t_events) -> size_t {
+  // The end can be split between calls.
+  const auto searched = m_sequence.size() -
+      min(m_sequence.size(), PASTE_END.size() - 1U);
+  m_sequence += t_data;
+  const auto end = m_sequence.find(PASTE_END, searched);
+  if (end == string::npos) {
+    return t_data.size();
+  }
+
+  const auto rest = m_sequence.size() - end - PASTE_END.size();
+  m_sequence.resize(end);
+  emit(t_events, Key::PASTE).text = move(m_sequence);
+  m_sequence.clear();
+  m_state = State::GROUND;
+  return t_data.size() - rest;
+}
+
+auto InputDecoder::emit(deque<Input::Event>& t_events, Key t_key,
+    char32_t t_code_point, uint8_t t_modifiers) -> Input::Event& {
+  auto& event = t_events.emplace_back();
+  event.key = t_key;
+  event.code_point = t_code_point;
+  event.modifiers = t_modifiers;
+  return event;
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "fcli/internal/live_area.hpp"
+
+using namespace fcli::internal;
+using namespace std;
+
+auto LiveArea::erase() -> string {
+  constexpr string_view CLEAR_LINE = "\r\033[2K", CURSOR_UP = "\033[1A";
+  string result;
+  if (m_lines != 0U) {
+    result = CLEAR_LINE;
+    for (size_t i = 1U; i != m_lines; ++i) {
+      result += string(CURSOR_UP) + string(CLEAR_LINE);
+    }
+  }
+  m_lines = 0U;
+  return result;
+}
+
+void LiveArea::set_drawn(string_view t_content) {
+  m_lines = t_content.empty() ? 0U :
+      static_cast<size_t>(count(t_content.cbegin(), t_content.cend(), '\n')) +
+      1U;
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "fcli/internal/terminfo.hpp"
+
+using namespace std;
+using namespace fcli::internal;
+
+namespace {
+  constexpr uint16_t LEGACY_MAGIC = 0432, NUMBERS_32_BIT_MAGIC = 01036;
+  // Indexes of the predefined capabilities.
+  constexpr size_t
+      COLORS_INDEX = 13U,
+      EXIT_ATTRIBUTES_INDEX = 39U,
+      SET_FOREGROUND_INDEX = 359U,
+      SET_BACKGROUND_INDEX = 360U;
+
+  // Sequential reader of little-endian values that fails on overrun.
+  class Reader {
+  public:
+    explicit Reader(string_view t_data): m_data(t_data) {}
+
+    [[nodiscard]] auto read_short() -> optional<int> {
+      if (m_position + 2U > m_data.size()) {
+        return {};
+      }
+      const auto low = static_cast<unsigned char>(m_data[m_position]),
+          high = static_cast<unsigned char>(m_data[m_position + 1U]);
+      m_position += 2U;
+      // Values are signed, -1 is absent and -2 is cancelled.
+      return static_cast<int16_t>(low | high << 8U);
+    }
+
+    [[nodiscard]] auto read_int() -> optional<int> {
+      if (m_position + 4U > m_data.size()) {
+        return {};
+      }
+      uint32_t value = 0U;
+      for (size_t i = 4U; i != 0U; --i) {
+        value = value << 8U |
+            static_cast<unsigned char>(m_data[m_position + i - 1U]);
+      }
+      m_position += 4U;
+      return static_cast<int32_t>(value);
+    }
+
+    // Returns the skipped part.
+    auto skip(size_t t_size) -> optional<string_view> {
+      if (m_position + t_size > m_data.size()) {
+        return {};
+      }
+      const auto part = m_data.substr(m_position, t_size);
+      m_position += t_size;
+      return part;
+    }
+
+    // Sections start at even offsets.
+    void align() { m_position += m_position % 2U; }
+
+    [[nodiscard]] inline auto get_position() const { return m_position; }
+
+  private:
+    string_view m_data;
+    size_t m_position{};
+  };
+
+  // Returns the null-terminated string at the offset.
+  [[nodiscard]] auto get_string(string_view t_table, int t_offset) ->
+      string_view {
+    if (t_offset < 0 || static_cast<size_t>(t_offset) >= t_table.size()) {
+      return {};
+    }
+    const auto str = t_table.substr(static_cast<size_t>(t_offset));
+    return str.substr(0U, str.find('\0'));
+  }
+
+  // Extended capabilities of ncurses that follow the predefined ones.
+  void parse_extended(Reader& t_reader, bool t_numbers_32_bit,
+      terminfo::Capabilities& t_capabilities) {
+    t_reader.align();
+    array<int, 5U> header{};
+    for (auto& value : header) {
+      const auto read = t_reader.read_short();
+      if (!read || *read < 0) {
+        return;
+      }
+      value = *read;
+    }
+    const auto [bools_count, numbers_count, strings_count, offsets_count,
+        table_size] = header;
+
+    const auto bools = t_reader.skip(static_cast<size_t>(bools_count));
+    if (!bools) {
+      return;
+    }
+    t_reader.align();
+    vector<int> numbers;
+    for (int i = 0; i != numbers_count; ++i) {
+      const auto number = t_numbers_32_bit ?
+          t_reader.read_int() : t_reader.read_short();
+      if (!number) {
+        return;
+      }
+      numbers.push_back(*number);
+    }
+    // Offsets of string values and then of names of all capabilities.
+    vector<int> offsets;
+    for (int i = 0; i != offsets_count; ++i) {
+      const auto offset = t_reader.read_short();
+      if (!offset) {
+        return;
+      }
+      offsets.push_back(*offset);
+    }
+    const auto table = t_reader.skip(static_cast<size_t>(table_size));
+    if (!table || offsets.size() < static_cast<size_t>(strings_count)) {
+      return;
+    }
+
+    // Names follow the last string value.
+    size_t names_start = 0U;
+    for (int i = 0; i != strings_count; ++i) {
+      if (const auto offset = offsets[static_cast<size_t>(i)]; offset >= 0) {
+        names_start = max(names_start, static_cast<size_t>(offset) +
+            get_string(*table, offset).size() + 1U);
+      }
+    }
+    if (names_start > table->size()) {
+      return;
+    }
+    const auto names = table->substr(names_start);
+    const auto get_name = [&] (size_t t_index) {
+      const auto index = static_cast<size_t>(strings_count) + t_index;
+      return index < offsets.size() ?
+          get_string(names, offsets[index]) : string_view();
+    };
+
+    // Names are ordered as booleans, numbers and strings.
+    for (size_t i = 0U; i != bools->size(); ++i) {
+      const auto name = get_name(i);
+      if ((name == "RGB" || name == "Tc") && (*bools)[i] == 1) {
+        t_capabilities.direct_color = true;
+      }
+    }
+    for (size_t i = 0U; i != numbers.size(); ++i) {
+      if (get_name(bools->size() + i) == "RGB" && numbers[i] > 0) {
+        t_capabilities.direct_color = true;
+      }
+    }
+  }
+
+  [[nodiscard]] auto get_search_directories() -> vector<string> {
+    vector<string> directories;
+    const auto add_env = [&directories] (const char* t_name,
+        string_view t_suffix = {}) {
+      if (const char* value = getenv(t_name); value != nullptr &&
+          *value != '\0') {
+        directories.push_back(value + string(t_suffix));
+      }
+    };
+
+    add_env("TERMINFO");
+    add_env("HOME", "/.terminfo");
+    if (const char* dirs = getenv("TERMINFO_DIRS"); dirs != nullptr) {
+      string_view list(dirs);
+      while (!list.empty()) {
+        const auto end = min(list.find(':'), list.size());
+        // Empty element means the system directories.
+        if (end != 0U) {
+          directories.emplace_back(list.substr(0U, end));
+        }
+        list.remove_prefix(min(end + 1U, list.size()));
+      }
+    }
+    for (const char* directory : {"/etc/terminfo", "/lib/terminfo",
+        "/usr/lib/terminfo", "/usr/share/terminfo"}) {
+      directories.emplace_back(directory);
+    }
+    return directories;
+  }
+
+  [[nodiscard]] auto load_file(const string& t_path) ->
+      optional<terminfo::Capabilities> {
+    const int file_desc = open(t_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file_desc < 0) {
+      return {};
+    }
+    struct stat status{};
+    if (fstat(file_desc, &status) != 0 || status.st_size <= 0) {
+      close(file_desc);
+      return {};
+    }
+    const auto size = static_cast<size_t>(status.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_desc, 0);
+    close(file_desc);
+    if (data == MAP_FAILED) {
+      return {};
+    }
+    auto capabilities =
+        terminfo::parse(string_view(static_cast<const char*>(data), size));
+    munmap(data, size);
+    return capabilities;
+  }
+} // Namespace.
+
+auto terminfo::parse(string_view t_entry) -> optional<Capabilities> {
+  Reader reader(t_entry);
+  array<int, 6U> header{};
+  for (auto& value : header) {
+    const auto read = reader.read_short();
+    if (!read) {
+      return {};
+    }
+    value = *read;
+  }
+  const auto [magic, names_size, bools_count, numbers_count, strings_count,
+      table_size] = header;
+  if ((magic != LEGACY_MAGIC && magic != NUMBERS_32_BIT_MAGIC) ||
+      names_size < 0 || bools_count < 0 || numbers_count < 0 ||
+      strings_count < 0 || table_size < 0) {
+    return {};
+  }
+  const bool numbers_32_bit = magic == NUMBERS_32_BIT_MAGIC;
+  const size_t number_size = numbers_32_bit ? 4U : 2U;
+
+  if (!reader.skip(static_cast<size_t>(names_size + bools_count))) {
+    return {};
+  }
+  reader.align();
+  const auto numbers = reader.skip(
+      static_cast<size_t>(numbers_count) * number_size);
+  const auto offsets = reader.skip(static_cast<size_t>(strings_count) * 2U);
+  const auto table = reader.skip(static_cast<size_t>(table_size));
+  if (!numbers || !offsets || !table) {
+    return {};
+  }
+
+  Capabilities capabilities;
+  if (COLORS_INDEX < static_cast<size_t>(numbers_count)) {
+    Reader number(numbers->substr(COLORS_INDEX * number_size));
+    capabilities.colors = *(numbers_32_bit ?
+        number.read_int() : number.read_short());
+  }
+  const auto get_capability = [&] (size_t t_index) -> string {
+    if (t_index >= static_cast<size_t>(strings_count)) {
+      return {};
+    }
+    Reader offset(offsets->substr(t_index * 2U));
+    return string(get_string(*table, *offset.read_short()));
+  };
+  capabilities.exit_attributes = get_capability(EXIT_ATTRIBUTES_INDEX);
+  capabilities.set_foreground = get_capability(SET_FOREGROUND_INDEX);
+  capabilities.set_background = get_capability(SET_BACKGROUND_INDEX);
+
+  parse_extended(reader, numbers_32_bit, capabilities);
+  return capabilities;
+}
+
+auto terminfo::load(string_view t_name) -> optional<Capabilities> {
+  // Name mustn't escape the directory.
+  if (t_name.empty() || t_name.find('/') != string_view::npos ||
+      t_name == "." || t_name == "..") {
+    return {};
+  }
+
+  const string name(t_name);
+  array<char, 3U> hex_dir{};
+  snprintf(hex_dir.data(), hex_dir.size(), "%02x",
+      static_cast<unsigned char>(name.front()));
+
+  for (const auto& directory : get_search_directories()) {
+    // Directories are named by the first letter or its hex code.
+    for (const auto& subdirectory : {string(1U, name.front()),
+        string(hex_dir.data())}) {
+      if (auto capabilities =
+          load_file(directory + '/' + subdirectory + '/' + name)) {
+        return capabilities;
+      }
+    }
+  }
+  return {};
+}
+
+auto terminfo::get_cached(string_view t_name) -> optional<Capabilities> {
+  // Leaked, so it can be used by destructors of static objects.
+  static auto& cache = *new map<string, optional<Capabilities>, less<>>();
+  static auto& cache_mut = *new mutex();
+
+  lock_guard lock(cache_mut);
+  if (const auto it = cache.find(t_name); it != cache.cend()) {
+    return it->second;
+  }
+  return cache.emplace(t_name, load(t_name)).first->second;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "fcli/internal/work_stealing.hpp"
+
+using namespace fcli::internal;
+using namespace std;
+
+WorkStealing::WorkStealing(size_t t_count,
+    unsigned t_workers, size_t t_chunk_size): m_count(t_count) {
+
+  if (t_workers == 0U) {
+    t_workers = max(thread::hardware_concurrency(), 1U);
+  }
+  if (t_chunk_size == 0U) {
+    t_chunk_size = max<size_t>(m_count / (t_workers * CHUNKS_PER_WORKER), 1U);
+  }
+  m_chunk_size = t_chunk_size;
+
+  const size_t chunks = (m_count + m_chunk_size - 1U) / m_chunk_size;
+  // Don't start workers that will have nothing to do.
+  m_workers_count = static_cast<unsigned>(
+      max<size_t>(min<size_t>(t_workers, chunks), 1U));
+  m_workers = make_unique<Worker[]>(m_workers_count);
+
+  // Distribute chunks evenly between workers.
+  for (unsigned i = 0U; i != m_workers_count; ++i) {
+    m_workers[i].next = chunks * i / m_workers_count;
+    m_workers[i].last = chunks * (i + 1U) / m_workers_count;
+  }
+}
+
+void WorkStealing::run(const body_t& t_body,
+    const function<bool()>& t_cancelled) {
+  vector<thread> threads;
+  threads.reserve(m_workers_count - 1U);
+  for (unsigned i = 1U; i != m_workers_count; ++i) {
+    threads.emplace_back(&WorkStealing::work, this, i,
+        cref(t_body), cref(t_cancelled));
+  }
+  work(0U, t_body, t_cancelled);
+
+  for (auto& t : threads) {
+    t.join();
+  }
+  if (m_exception) {
+    rethrow_exception(m_exception);
+  }
+}
+
+auto WorkStealing::get_done() const -> size_t {
+  size_t done = 0U;
+  for (unsigned i = 0U; i != m_workers_count; ++i) {
+    done += m_workers[i].done.load(memory_order_relaxed);
+  }
+  return done;
+}
+
+void WorkStealing::work(unsigned t_index, const body_t& t_body,
+    const function<bool()>& t_cancelled) {
+  auto& worker = m_workers[t_index];
+  size_t chunk = 0U;
+
+  while (!m_cancelled.load(memory_order_relaxed)) {
+    if (t_cancelled && t_cancelled()) {
+      m_cancelled = true;
+      break;
+    }
+    if (!take_chunk(t_index, chunk)) {
+      break;
+    }
+
+    const auto first = chunk * m_chunk_size;
+    const auto last = min(first + m_chunk_size, m_count);
+    try {
+      t_body(first, last);
+    } catch (...) {
+      lock_guard lock(m_exception_mut);
+      if (!m_exception) {
+        m_exception = current_exception();
+      }
+      m_cancelled = true;
+      break;
+    }
+    // Only the owner writes to the counter, so there is no need in RMW.
+    worker.done.store(worker.done.load(memory_order_relaxed) +
+        (last - first), memory_order_relaxed);
+  }
+}
+
+auto WorkStealing::take_chunk(unsigned t_index, size_t& t_chunk) -> bool {
+  auto& worker = m_workers[t_index];
+  do {
+    lock_guard lock(worker.mut);
+    if (worker.next != worker.last) {
+      t_chunk = worker.next++;
+      return true;
+    }
+  } while (steal(t_index));
+  return false;
+}
+
+auto WorkStealing::steal(unsigned t_index) -> bool {
+  while (true) {
+    // Find a victim with the most remaining chunks.
+    unsigned victim = t_index;
+    size_t max_remaining = 0U;
+    for (unsigned i = 0U; i != m_workers_count; ++i) {
+      if (i == t_index) {
+        continue;
+      }
+      lock_guard lock(m_workers[i].mut);
+      const auto remaining = m_workers[i].last - m_workers[i].next;
+      if (remaining > max_remaining) {
+        max_remaining = remaining;
+        victim = i;
+      }
+    }
+    if (victim == t_index) {
+      return false;
+    }
+
+    // scoped_lock avoids deadlock when two workers steal from each other.
+    auto& thief = m_workers[t_index];
+    auto& target = m_workers[victim];
+    scoped_lock locks{thief.mut, target.mut};
+    const auto remaining = target.last - target.next;
+    if (remaining == 0U) {
+      // Block has been exhausted while searching, try again.
+      continue;
+    }
+
+    // Take the back half, but at least one chunk.
+    const auto stolen = (remaining + 1U) / 2U;
+    thief.last = target.last;
+    thief.next = target.last - stolen;
+    target.last = thief.next;
+    return true;
+  }
+}
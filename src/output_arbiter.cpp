@@ -0,0 +1,170 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "fcli/output_arbiter.hpp"
+
+using namespace fcli;
+using namespace std;
+
+OutputArbiter::OutputArbiter(ostream& t_ostream): m_ostream(t_ostream),
+    m_renderer(&OutputArbiter::render, this) {}
+
+OutputArbiter::~OutputArbiter() {
+  m_mut.lock();
+  m_stopping = true;
+  m_mut.unlock();
+  m_render_cv.notify_one();
+  m_renderer.join();
+}
+
+void OutputArbiter::attach(Progress& t_progress) {
+  lock_guard lock(m_mut);
+  if (find(m_progresses.cbegin(), m_progresses.cend(), &t_progress) ==
+      m_progresses.cend()) {
+    m_progresses.push_back(&t_progress);
+    m_redraw = true;
+  }
+  m_render_cv.notify_one();
+}
+
+void OutputArbiter::detach(Progress& t_progress) {
+  lock_guard lock(m_mut);
+  m_progresses.erase(remove(m_progresses.begin(), m_progresses.end(),
+      &t_progress), m_progresses.end());
+  m_redraw = true;
+  m_render_cv.notify_one();
+}
+
+void OutputArbiter::finish(Progress& t_progress, bool t_success,
+    string_view t_message) {
+  detach(t_progress);
+  t_progress.finish(t_success, t_message);
+}
+
+void OutputArbiter::print(string_view t_line) {
+  lock_guard lock(m_mut);
+  m_lines += t_line;
+  if (t_line.empty() || t_line.back() != '\n') {
+    m_lines += '\n';
+  }
+  m_render_cv.notify_one();
+}
+
+auto OutputArbiter::get_ostream() -> ostream& {
+  lock_guard lock(m_mut);
+  auto& stream = m_streams[this_thread::get_id()];
+  if (!stream) {
+    stream = make_unique<ostream>(&m_streambuf);
+  }
+  return *stream;
+}
+
+void OutputArbiter::queue(string_view t_data) {
+  const auto it = m_incomplete_lines.try_emplace(this_thread::get_id()).first;
+  auto& incomplete_line = it->second;
+
+  if (const auto end = t_data.rfind('\n'); end != string_view::npos) {
+    m_lines += incomplete_line;
+    m_lines += t_data.substr(0U, end + 1U);
+    t_data.remove_prefix(end + 1U);
+    incomplete_line.clear();
+    m_render_cv.notify_one();
+  }
+  incomplete_line += t_data;
+  if (incomplete_line.empty()) {
+    m_incomplete_lines.erase(it);
+  }
+}
+
+void OutputArbiter::render() {
+  unique_lock lock(m_mut);
+  while (!m_stopping) {
+    auto output = build_output(false);
+    lock.unlock();
+    if (!output.empty()) {
+      m_ostream << output << flush;
+    }
+    lock.lock();
+
+    const auto has_work = [this]
+        { return m_stopping || m_redraw || !m_lines.empty(); };
+    if (m_progresses.empty()) {
+      m_render_cv.wait(lock, has_work);
+    } else {
+      // Queued lines wait for the next frame.
+      m_render_cv.wait_for(lock, FRAME_INTERVAL,
+          [this] { return m_stopping || m_redraw; });
+    }
+  }
+
+  // Incomplete lines are printed as complete ones.
+  for (auto& [id, incomplete_line] : m_incomplete_lines) {
+    m_lines += incomplete_line + '\n';
+  }
+  m_incomplete_lines.clear();
+  m_ostream << build_output(true) << flush;
+}
+
+auto OutputArbiter::build_output(bool t_last) -> string {
+  m_redraw = false;
+  if (m_lines.empty() && m_progresses.empty() &&
+      m_live_area.get_lines() == 0U) {
+    return {};
+  }
+
+  auto output = m_live_area.erase() + m_lines;
+  m_lines.clear();
+  if (t_last) {
+    return output;
+  }
+
+  string frames;
+  for (auto* progress : m_progresses) {
+    // Finished progress has printed its result.
+    if (progress->get_state() != Progress::State::RUNNING) {
+      continue;
+    }
+    if (!frames.empty()) {
+      frames += '\n';
+    }
+    frames += progress->render_frame();
+  }
+  m_live_area.set_drawn(frames);
+  return output + frames;
+}
+
+/*
+ * Streambuf.
+ */
+
+auto OutputArbiter::Streambuf::overflow(int_type t_char) -> int_type {
+  if (!traits_type::eq_int_type(t_char, traits_type::eof())) {
+    const auto c = traits_type::to_char_type(t_char);
+    lock_guard lock(m_arbiter.m_mut);
+    m_arbiter.queue(string_view(&c, 1U));
+  }
+  return traits_type::not_eof(t_char);
+}
+
+auto OutputArbiter::Streambuf::xsputn(const char_type* t_data,
+    streamsize t_size) -> streamsize {
+  lock_guard lock(m_arbiter.m_mut);
+  m_arbiter.queue(string_view(t_data, static_cast<size_t>(t_size)));
+  return t_size;
+}
@@ -0,0 +1,650 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <streambuf>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+#include "fcli/internal/unicode.hpp"
+#include "fcli/pager.hpp"
+#include "fcli/text.hpp"
+
+using namespace fcli;
+using namespace fcli::internal;
+using namespace std;
+using namespace chrono;
+
+namespace {
+  // Mapped files are indexed by blocks, so a stop request is noticed soon.
+  constexpr size_t INDEX_BLOCK_SIZE = 4U * 1024U * 1024U;
+  constexpr size_t READ_BLOCK_SIZE = 64U * 1024U;
+  constexpr size_t TAB_WIDTH = 8U;
+  // Lines are scrolled by the mouse wheel.
+  constexpr long WHEEL_LINES = 3;
+  // Number of lines on the status row is updated while indexing.
+  constexpr milliseconds REFRESH_INTERVAL{100};
+
+  auto is_continuation(char t_c) {
+    return (static_cast<unsigned char>(t_c) & 0xC0U) == 0x80U;
+  }
+
+  // Columns are counted as code points, which is enough for tab stops.
+  auto expand_tabs(string_view t_line) {
+    string result;
+    result.reserve(t_line.size());
+    size_t column = 0U;
+    for (const auto c : t_line) {
+      if (c == '\t') {
+        const auto spaces = TAB_WIDTH - column % TAB_WIDTH;
+        result.append(spaces, ' ');
+        column += spaces;
+        continue;
+      }
+      result += c;
+      if (!is_continuation(c)) {
+        ++column;
+      }
+    }
+    return result;
+  }
+} // Namespace.
+
+Pager::Pager(const filesystem::path& t_path,
+    const optional<Terminal::ColorsSupport>& t_colors_support,
+    const Palette& t_palette): m_path(t_path),
+    m_colors_support(t_colors_support), m_palette(t_palette),
+    m_status_style(Text::format_copy("~d~", t_colors_support, t_palette)),
+    m_reset_style(Text::format_copy("<r>", t_colors_support, t_palette)) {
+
+  const int file_desc = open(t_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (file_desc < 0) {
+    throw filesystem::filesystem_error("couldn't open file", t_path,
+        error_code(errno, generic_category()));
+  }
+  struct stat status{};
+  if (fstat(file_desc, &status) != 0) {
+    const error_code error(errno, generic_category());
+    close(file_desc);
+    throw filesystem::filesystem_error("couldn't get file size", t_path, error);
+  }
+
+  m_size = static_cast<size_t>(status.st_size);
+  if (m_size != 0U) {
+    void* const data =
+        mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file_desc, 0);
+    if (data == MAP_FAILED) {
+      const error_code error(errno, generic_category());
+      close(file_desc);
+      throw filesystem::filesystem_error("couldn't map file", t_path, error);
+    }
+    m_mapping = static_cast<const char*>(data);
+  }
+  close(file_desc);
+  m_thread = thread(&Pager::index_mapping, this);
+}
+
+Pager::Pager(istream& t_stream,
+    const optional<Terminal::ColorsSupport>& t_colors_support,
+    const Palette& t_palette): m_colors_support(t_colors_support),
+    m_palette(t_palette),
+    m_status_style(Text::format_copy("~d~", t_colors_support, t_palette)),
+    m_reset_style(Text::format_copy("<r>", t_colors_support, t_palette)) {
+  m_thread = thread(&Pager::read_stream, this, ref(t_stream));
+}
+
+Pager::Pager(int t_file_desc,
+    const optional<Terminal::ColorsSupport>& t_colors_support,
+    const Palette& t_palette): m_stop_file_desc(eventfd(0U, EFD_CLOEXEC)),
+    m_colors_support(t_colors_support), m_palette(t_palette),
+    m_status_style(Text::format_copy("~d~", t_colors_support, t_palette)),
+    m_reset_style(Text::format_copy("<r>", t_colors_support, t_palette)) {
+  if (m_stop_file_desc < 0) {
+    throw system_error(errno, generic_category(), "couldn't create eventfd");
+  }
+  m_thread = thread(&Pager::read_file_desc, this, t_file_desc);
+}
+
+Pager::~Pager() {
+  m_stop = true;
+  if (m_stop_file_desc >= 0) {
+    const uint64_t increment = 1U;
+    [[maybe_unused]] const auto written =
+        write(m_stop_file_desc, &increment, sizeof(increment));
+  }
+  m_thread.join();
+  if (m_stop_file_desc >= 0) {
+    close(m_stop_file_desc);
+  }
+  if (m_mapping != nullptr) {
+    munmap(const_cast<char*>(m_mapping), m_size);
+  }
+}
+
+auto Pager::get_lines_count() const -> size_t {
+  lock_guard lock(m_mut);
+  // The last line is incomplete until the end.
+  if (!m_indexed || m_offsets.back() == m_size) {
+    return m_offsets.size() - 1U;
+  }
+  return m_offsets.size();
+}
+
+auto Pager::is_indexed() const -> bool {
+  lock_guard lock(m_mut);
+  return m_indexed;
+}
+
+void Pager::wait_indexed() const {
+  unique_lock lock(m_mut);
+  m_indexed_cv.wait(lock, [this] { return m_indexed; });
+}
+
+auto Pager::get_raw_line(size_t t_line) const -> string {
+  if (t_line >= get_lines_count()) {
+    throw out_of_range("line isn't found yet");
+  }
+  lock_guard lock(m_mut);
+  const auto [begin, end] = get_line_bounds(t_line);
+  return string(get_data().substr(begin, end - begin));
+}
+
+auto Pager::get_line(size_t t_line) -> string {
+  bool formatting = true;
+  {
+    lock_guard lock(m_mut);
+    formatting = m_formatting;
+    if (const auto it = m_cache_index.find(t_line);
+        it != m_cache_index.cend()) {
+      m_cache.splice(m_cache.begin(), m_cache, it->second);
+      return it->second->second;
+    }
+  }
+
+  auto raw = get_raw_line(t_line);
+  if (raw.size() > MAX_LINE_SIZE) {
+    raw.resize(MAX_LINE_SIZE);
+  }
+  auto line = expand_tabs(raw);
+  if (formatting) {
+    Text::format(line, m_colors_support, m_palette);
+  }
+
+  lock_guard lock(m_mut);
+  // Another thread could format it meanwhile.
+  if (m_cache_index.find(t_line) == m_cache_index.cend()) {
+    m_cache.emplace_front(t_line, line);
+    m_cache_index.emplace(t_line, m_cache.begin());
+    if (m_cache.size() > CACHE_CAPACITY) {
+      m_cache_index.erase(m_cache.back().first);
+      m_cache.pop_back();
+    }
+  }
+  return line;
+}
+
+auto Pager::find(string_view t_pattern, size_t t_line, bool t_backward) const
+    -> optional<size_t> {
+  if (t_pattern.empty()) {
+    return {};
+  }
+  unique_lock lock(m_mut);
+  if (t_backward) {
+    if (t_line >= m_offsets.size()) {
+      return {};
+    }
+    const auto found =
+        get_data().substr(0U, m_offsets[t_line]).rfind(t_pattern);
+    if (found == string_view::npos) {
+      return {};
+    }
+    return get_line_of(found);
+  }
+
+  m_indexed_cv.wait(lock,
+      [this, t_line] { return m_indexed || m_offsets.size() > t_line + 1U; });
+  if (m_offsets.size() <= t_line + 1U) {
+    return {};
+  }
+  for (auto offset = m_offsets[t_line + 1U];;) {
+    // Indexing can be finished while a mapping is searched without lock.
+    const bool indexed = m_indexed;
+    if (const auto line = find_forward(t_pattern, offset, lock)) {
+      return line;
+    }
+    if (indexed) {
+      return {};
+    }
+    const auto count = m_offsets.size();
+    m_indexed_cv.wait(lock,
+        [this, count] { return m_indexed || m_offsets.size() != count; });
+  }
+}
+
+void Pager::run(Input& t_input, Screen& t_screen) {
+  constexpr milliseconds MAX_TIMEOUT = 1h;
+  draw(t_screen);
+  t_screen.present();
+  while (true) {
+    const auto event =
+        t_input.wait(is_indexed() ? MAX_TIMEOUT : REFRESH_INTERVAL);
+    if (event) {
+      if (!handle(*event)) {
+        return;
+      }
+    } else if (t_input.is_stopped()) {
+      return;
+    }
+    draw(t_screen);
+    t_screen.present();
+  }
+}
+
+auto Pager::handle(const Input::Event& t_event) -> bool {
+  using Key = Input::Key;
+  const bool ctrl = (t_event.modifiers & Input::CTRL) != 0U;
+  const bool plain = (t_event.modifiers & (Input::CTRL | Input::ALT)) == 0U;
+  const auto top = static_cast<long>(m_top);
+  const auto page = static_cast<long>(m_rows);
+  const auto scroll = [this, top] (long t_lines) {
+    set_top(static_cast<size_t>(max(top + t_lines, 0L)));
+  };
+
+  // The pattern is being typed.
+  if (m_input) {
+    switch (t_event.key) {
+      case Key::CHARACTER:
+        if (ctrl &&
+            (t_event.code_point == U'c' || t_event.code_point == U'g')) {
+          m_input.reset();
+        } else if (plain) {
+          unicode::encode(t_event.code_point, *m_input);
+        }
+        break;
+      case Key::PASTE:
+        for (const auto c : t_event.text) {
+          if (static_cast<unsigned char>(c) >= ' ') {
+            *m_input += c;
+          }
+        }
+        break;
+      case Key::BACKSPACE:
+        if (m_input->empty()) {
+          m_input.reset();
+          break;
+        }
+        while (is_continuation(m_input->back())) {
+          m_input->pop_back();
+        }
+        m_input->pop_back();
+        break;
+      case Key::ENTER:
+        // Empty pattern repeats the last one.
+        if (!m_input->empty()) {
+          m_pattern = move(*m_input);
+        }
+        m_input.reset();
+        search(m_backward);
+        break;
+      case Key::ESCAPE:
+        m_input.reset();
+        break;
+      default:
+        break;
+    }
+    return true;
+  }
+
+  m_not_found = m_searching = false;
+  switch (t_event.key) {
+    case Key::CHARACTER:
+      if (ctrl) {
+        switch (t_event.code_point) {
+          case U'c':
+            return false;
+          case U'f':
+            scroll(page);
+            break;
+          case U'b':
+            scroll(-page);
+            break;
+          default:
+            break;
+        }
+        break;
+      }
+      switch (t_event.code_point) {
+        case U'q':
+          return false;
+        case U'j':
+          scroll(1);
+          break;
+        case U'k':
+          scroll(-1);
+          break;
+        case U' ':
+          scroll(page);
+          break;
+        case U'b':
+          scroll(-page);
+          break;
+        case U'g':
+          set_top(0U);
+          break;
+        case U'G':
+          set_top(get_lines_count());
+          break;
+        case U'/': case U'?':
+          m_input.emplace();
+          m_backward = t_event.code_point == U'?';
+          break;
+        case U'n':
+          search(m_backward);
+          break;
+        case U'N':
+          search(!m_backward);
+          break;
+        default:
+          break;
+      }
+      break;
+    case Key::ESCAPE:
+      return false;
+    case Key::DOWN: case Key::ENTER:
+      scroll(1);
+      break;
+    case Key::UP:
+      scroll(-1);
+      break;
+    case Key::PAGE_DOWN:
+      scroll(page);
+      break;
+    case Key::PAGE_UP:
+      scroll(-page);
+      break;
+    case Key::HOME:
+      set_top(0U);
+      break;
+    case Key::END:
+      set_top(get_lines_count());
+      break;
+    case Key::MOUSE:
+      if (t_event.mouse.action == Input::Mouse::Action::SCROLL_UP) {
+        scroll(-WHEEL_LINES);
+      } else if (t_event.mouse.action == Input::Mouse::Action::SCROLL_DOWN) {
+        scroll(WHEEL_LINES);
+      }
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+void Pager::draw(Screen& t_screen) {
+  const auto height = t_screen.get_height();
+  m_rows = height > 1U ? static_cast<unsigned short>(height - 1U) : 1U;
+  // Content could grow or be scrolled to the end.
+  if (m_searching) {
+    continue_search();
+  }
+  set_top(m_top);
+
+  t_screen.clear();
+  const auto count = get_lines_count();
+  unsigned short row = 0U;
+  for (; row != m_rows && m_top + row < count; ++row) {
+    t_screen.draw_text(0U, row, get_line(m_top + row));
+  }
+  if (height <= 1U) {
+    return;
+  }
+
+  string status;
+  if (m_input) {
+    status = (m_backward ? "?" : "/") + *m_input;
+  } else if (m_not_found) {
+    status = m_status_style + "Pattern not found" + m_reset_style;
+  } else if (m_searching) {
+    status = m_status_style + "Searching..." + m_reset_style;
+  } else {
+    status = m_status_style;
+    if (!m_path.empty()) {
+      status += m_path.filename().string() + ' ';
+    }
+    status += "lines " + to_string(count == 0U ? 0U : m_top + 1U) + '-' +
+        to_string(m_top + row) + " of " + to_string(count);
+    if (!is_indexed()) {
+      status += '+';
+    }
+    status += m_reset_style;
+  }
+  t_screen.draw_text(0U, static_cast<unsigned short>(height - 1U), status);
+}
+
+void Pager::set_top(size_t t_line) {
+  const auto count = get_lines_count();
+  // The last page is full.
+  m_top = min(t_line, count > m_rows ? count - m_rows : 0U);
+}
+
+void Pager::set_formatting(bool t_enable) {
+  lock_guard lock(m_mut);
+  m_formatting = t_enable;
+  m_cache.clear();
+  m_cache_index.clear();
+}
+
+void Pager::index_mapping() {
+  for (size_t begin = 0U; begin != m_size && !m_stop;) {
+    const auto end = min(begin + INDEX_BLOCK_SIZE, m_size);
+    index(begin, end);
+    begin = end;
+  }
+  finish_indexing();
+}
+
+void Pager::read_stream(istream& t_stream) {
+  using traits = streambuf::traits_type;
+  array<char, READ_BLOCK_SIZE> block{};
+  auto* const buffer = t_stream.rdbuf();
+  while (buffer != nullptr && !m_stop) {
+    // Only available bytes are taken, so lines are shown as they come.
+    auto available = buffer->in_avail();
+    if (available == 0) {
+      if (traits::eq_int_type(buffer->sgetc(), traits::eof())) {
+        break;
+      }
+      available = max<streamsize>(buffer->in_avail(), 1);
+    }
+    if (available < 0) {
+      break;
+    }
+    const auto size = buffer->sgetn(block.data(),
+        min(available, static_cast<streamsize>(block.size())));
+    if (size <= 0) {
+      break;
+    }
+    append(block.data(), static_cast<size_t>(size));
+  }
+  finish_indexing();
+}
+
+void Pager::read_file_desc(int t_file_desc) {
+  array<char, READ_BLOCK_SIZE> block{};
+  array<pollfd, 2U> file_descs{{
+    {t_file_desc, POLLIN, 0},
+    {m_stop_file_desc, POLLIN, 0}
+  }};
+  while (!m_stop) {
+    if (poll(file_descs.data(), file_descs.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    if (file_descs[1U].revents != 0) {
+      break;
+    }
+    const auto size = read(t_file_desc, block.data(), block.size());
+    if (size < 0 && (errno == EINTR || errno == EAGAIN)) {
+      continue;
+    }
+    if (size <= 0) {
+      break;
+    }
+    append(block.data(), static_cast<size_t>(size));
+  }
+  finish_indexing();
+}
+
+void Pager::append(const char* t_data, size_t t_size) {
+  size_t begin = 0U;
+  {
+    lock_guard lock(m_mut);
+    begin = m_buffer.size();
+    m_buffer.append(t_data, t_size);
+    m_size = m_buffer.size();
+  }
+  index(begin, begin + t_size);
+}
+
+void Pager::finish_indexing() {
+  lock_guard lock(m_mut);
+  m_indexed = true;
+  m_indexed_cv.notify_all();
+}
+
+void Pager::index(size_t t_begin, size_t t_end) {
+  // Content is changed only by this thread, so it's scanned without lock.
+  const auto* const data =
+      m_mapping != nullptr ? m_mapping : m_buffer.data();
+  vector<size_t> offsets;
+  for (auto pos = t_begin; pos != t_end;) {
+    const auto* const found = static_cast<const char*>(
+        memchr(data + pos, '\n', t_end - pos));
+    if (found == nullptr) {
+      break;
+    }
+    pos = static_cast<size_t>(found - data) + 1U;
+    offsets.push_back(pos);
+  }
+
+  lock_guard lock(m_mut);
+  m_offsets.insert(m_offsets.cend(), offsets.cbegin(), offsets.cend());
+  m_indexed_cv.notify_all();
+}
+
+auto Pager::get_data() const -> string_view {
+  return m_mapping != nullptr ?
+      string_view(m_mapping, m_size) : string_view(m_buffer);
+}
+
+auto Pager::get_line_bounds(size_t t_line) const -> pair<size_t, size_t> {
+  const auto begin = m_offsets[t_line];
+  auto end = t_line + 1U < m_offsets.size() ?
+      m_offsets[t_line + 1U] - 1U : m_size;
+  // Line ends of Windows.
+  if (end != begin && get_data()[end - 1U] == '\r') {
+    --end;
+  }
+  return {begin, end};
+}
+
+auto Pager::get_line_of(size_t t_offset) const -> size_t {
+  return static_cast<size_t>(upper_bound(m_offsets.cbegin(), m_offsets.cend(),
+      t_offset) - m_offsets.cbegin()) - 1U;
+}
+
+auto Pager::find_forward(string_view t_pattern, size_t& t_offset,
+    unique_lock<mutex>& t_lock) const -> optional<size_t> {
+  // Only complete lines are searched, so the line of a match is known.
+  const auto end = m_indexed ? m_size : m_offsets.back();
+  if (t_offset >= end) {
+    return {};
+  }
+  const auto data = get_data().substr(0U, end);
+  size_t found = 0U;
+  // Mapped content isn't changed, so the lock isn't needed to scan it.
+  if (m_mapping != nullptr) {
+    t_lock.unlock();
+    found = data.find(t_pattern, t_offset);
+    t_lock.lock();
+  } else {
+    found = data.find(t_pattern, t_offset);
+  }
+  if (found == string_view::npos) {
+    // A match can cross the end.
+    t_offset = max(t_offset, end - min(end, t_pattern.size() - 1U));
+    return {};
+  }
+  return get_line_of(found);
+}
+
+void Pager::search(bool t_backward) {
+  m_not_found = m_searching = false;
+  if (t_backward) {
+    const auto line = find(m_pattern, m_top, true);
+    m_not_found = !line;
+    if (line) {
+      set_top(*line);
+    }
+    return;
+  }
+  m_searching = true;
+  m_search_line = m_top;
+  m_search_offset = 0U;
+  continue_search();
+}
+
+void Pager::continue_search() {
+  if (m_pattern.empty()) {
+    m_searching = false;
+    m_not_found = true;
+    return;
+  }
+  optional<size_t> line;
+  bool indexed = false;
+  {
+    unique_lock lock(m_mut);
+    indexed = m_indexed;
+    // Search starts after the line, when its end is found.
+    if (m_search_offset == 0U && m_offsets.size() > m_search_line + 1U) {
+      m_search_offset = m_offsets[m_search_line + 1U];
+    }
+    if (m_search_offset != 0U) {
+      line = find_forward(m_pattern, m_search_offset, lock);
+    }
+  }
+  if (line) {
+    m_searching = false;
+    set_top(*line);
+  } else if (indexed) {
+    m_searching = false;
+    m_not_found = true;
+  }
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <functional>
+#include <utility>
+
+#include "fcli/parallel.hpp"
+
+using namespace fcli;
+using namespace fcli::internal;
+using namespace std;
+
+auto internal::run_with_progress(WorkStealing& t_scheduler,
+    const WorkStealing::body_t& t_body, Progress& t_progress) -> bool {
+  constexpr double MAX_PERCENTS = 100.0;
+  const auto count = static_cast<double>(t_scheduler.get_count());
+  const auto get_percents = [&t_scheduler, count] {
+    if (count == 0.0) {
+      return MAX_PERCENTS;
+    }
+    return static_cast<double>(t_scheduler.get_done()) / count * MAX_PERCENTS;
+  };
+
+  /*
+   * Source refers to the local scheduler, so the previous one (for example,
+   * of stages) must be restored even if the body throws an exception. The
+   * work that was done is merged then too.
+   */
+  struct SourceGuard {
+    Progress& progress;
+    const decltype(get_percents)& get_done_percents;
+    function<double()> previous_source;
+
+    ~SourceGuard() {
+      progress.set_percents_source(move(previous_source));
+      progress.set_percents(get_done_percents());
+    }
+  } source_guard{t_progress, get_percents, {}};
+
+  // Failure that happened before the run mustn't cancel it.
+  const bool failed_before =
+      t_progress.get_state() == Progress::State::FAILED;
+
+  t_progress.set_determined(true);
+  source_guard.previous_source = t_progress.set_percents_source(get_percents);
+  t_scheduler.run(t_body, [&t_progress, failed_before] {
+    return !failed_before &&
+        t_progress.get_state() == Progress::State::FAILED;
+  });
+  return !t_scheduler.is_cancelled();
+}
@@ -0,0 +1,401 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <unistd.h>
+
+#include "fcli/phase.hpp"
+#include "fcli/text.hpp"
+
+using namespace fcli;
+using namespace std;
+using namespace chrono;
+
+namespace {
+  constexpr size_t CHUNK_SIZE = 256U;
+  constexpr size_t MAX_CHUNKS = Phase::MAX_THREAD_RECORDS / CHUNK_SIZE;
+  // Thread caches of interned names are cleared when they grow larger.
+  constexpr size_t MAX_CACHED_NAMES = 1024U;
+
+  // Records are published by the size, so a reader never waits for a writer.
+  struct Chunk {
+    array<Phase::Record, CHUNK_SIZE> records;
+    atomic<size_t> size{};
+    atomic<Chunk*> next{};
+  };
+
+  struct Buffer {
+    // Read and freed under the lock of the registry. Full chunks are freed
+    // when the writer is moved to the next one.
+    Chunk* first{new Chunk()};
+    size_t first_taken{};
+    // Written only by its thread.
+    Chunk* last{first};
+    size_t thread{};
+    unsigned depth{};
+    // Allocated by the writer minus freed by readers.
+    atomic<size_t> chunks{1U};
+    atomic<size_t> dropped{};
+  };
+
+  struct Registry {
+    mutex mut;
+    vector<unique_ptr<Buffer>> buffers;
+    // Nodes aren't moved, so names are never invalidated.
+    unordered_set<string> names;
+    const steady_clock::time_point epoch{steady_clock::now()};
+
+    // Settings of the report at exit.
+    ostream* report_ostream{};
+    optional<filesystem::path> trace_path;
+  };
+
+  // Leaked, so phases can be used by destructors of static objects.
+  auto get_registry() -> Registry& {
+    static auto& registry = *new Registry();
+    return registry;
+  }
+
+  auto get_buffer() -> Buffer& {
+    // Buffer outlives its thread to keep records.
+    thread_local Buffer* buffer = [] {
+      auto& registry = get_registry();
+      lock_guard lock(registry.mut);
+      registry.buffers.push_back(make_unique<Buffer>());
+      registry.buffers.back()->thread = registry.buffers.size();
+      return registry.buffers.back().get();
+    }();
+    return *buffer;
+  }
+
+  /*
+   * Names are cached by their addresses, so names of literals are interned
+   * without lock and allocation after the first phase of a thread.
+   */
+  auto intern(string_view t_name) -> string_view {
+    thread_local unordered_map<const char*, string_view> cache;
+    if (const auto it = cache.find(t_name.data());
+        it != cache.cend() && it->second == t_name) {
+      return it->second;
+    }
+
+    auto& registry = get_registry();
+    unique_lock lock(registry.mut);
+    const string_view interned = *registry.names.emplace(t_name).first;
+    lock.unlock();
+    if (cache.size() == MAX_CACHED_NAMES) {
+      cache.clear();
+    }
+    cache[t_name.data()] = interned;
+    return interned;
+  }
+
+  /*
+   * Copies records of the buffer that aren't taken. Taken ones are skipped
+   * next time and their full chunks are freed.
+   * Attention: it doesn't lock mutex automatically.
+   */
+  void read_buffer(Buffer& t_buffer, vector<Phase::Record>& t_records,
+      bool t_take) {
+    auto taken = t_buffer.first_taken;
+    for (Chunk* chunk = t_buffer.first; chunk != nullptr; taken = 0U) {
+      const auto size = chunk->size.load(memory_order_acquire);
+      t_records.insert(t_records.end(),
+          chunk->records.cbegin() + static_cast<ptrdiff_t>(taken),
+          chunk->records.cbegin() + static_cast<ptrdiff_t>(size));
+      auto* const next = chunk->next.load(memory_order_acquire);
+      if (!t_take) {
+        chunk = next;
+        continue;
+      }
+      if (next == nullptr) {
+        t_buffer.first_taken = size;
+        break;
+      }
+      // The writer doesn't touch a chunk after linking the next one.
+      delete chunk;
+      t_buffer.first = chunk = next;
+      t_buffer.first_taken = 0U;
+      t_buffer.chunks.fetch_sub(1U, memory_order_relaxed);
+    }
+  }
+
+  auto format_duration(nanoseconds t_duration) -> string {
+    constexpr array<pair<double, const char*>, 3U> UNITS{{
+      {1e9, "s"}, {1e6, "ms"}, {1e3, "us"}
+    }};
+    const auto count = static_cast<double>(t_duration.count());
+    array<char, 32U> buffer{};
+    for (const auto& [factor, unit] : UNITS) {
+      if (count >= factor) {
+        snprintf(buffer.data(), buffer.size(), "%.2f %s",
+            count / factor, unit);
+        return buffer.data();
+      }
+    }
+    return to_string(t_duration.count()) + " ns";
+  }
+
+  /*
+   * Exact microseconds with three digits of fraction. Floating point would
+   * lose precision of long runs, so nested phases could overlap in a viewer.
+   */
+  auto format_microseconds(nanoseconds t_time) -> string {
+    constexpr long long NS_PER_US = 1000;
+    array<char, 32U> buffer{};
+    snprintf(buffer.data(), buffer.size(), "%lld.%03lld",
+        static_cast<long long>(t_time.count()) / NS_PER_US,
+        static_cast<long long>(t_time.count()) % NS_PER_US);
+    return buffer.data();
+  }
+
+  auto escape_json(string_view t_str) -> string {
+    string result;
+    for (const char c : t_str) {
+      if (c == '"' || c == '\\') {
+        result += '\\';
+        result += c;
+      } else if (static_cast<unsigned char>(c) < 0x20U) {
+        array<char, 8U> buffer{};
+        snprintf(buffer.data(), buffer.size(), "\\u%04x",
+            static_cast<unsigned>(c));
+        result += buffer.data();
+      } else {
+        result += c;
+      }
+    }
+    return result;
+  }
+} // Namespace.
+
+Phase::Phase(string_view t_name): m_name(intern(t_name)) {
+  ++get_buffer().depth;
+  m_start = steady_clock::now();
+}
+
+Phase::Phase(Progress& t_progress, string_view t_name):
+    m_progress(&t_progress), m_previous_text(t_progress.get_text()),
+    m_name(intern(t_name)) {
+
+  m_progress->set_text(m_name);
+  ++get_buffer().depth;
+  m_start = steady_clock::now();
+}
+
+Phase::~Phase() {
+  const auto end = steady_clock::now();
+  auto& buffer = get_buffer();
+  --buffer.depth;
+
+  auto* chunk = buffer.last;
+  auto size = chunk->size.load(memory_order_relaxed);
+  if (size == CHUNK_SIZE) {
+    if (buffer.chunks.load(memory_order_relaxed) >= MAX_CHUNKS) {
+      buffer.dropped.fetch_add(1U, memory_order_relaxed);
+      chunk = nullptr;
+    } else {
+      auto* next = new Chunk();
+      buffer.chunks.fetch_add(1U, memory_order_relaxed);
+      chunk->next.store(next, memory_order_release);
+      buffer.last = chunk = next;
+      size = 0U;
+    }
+  }
+
+  if (chunk != nullptr) {
+    const auto epoch = get_registry().epoch;
+    chunk->records.at(size) = {m_name, m_start - epoch, end - m_start,
+        buffer.depth, buffer.thread};
+    chunk->size.store(size + 1U, memory_order_release);
+  }
+
+  if (m_progress != nullptr) {
+    m_progress->set_text(m_previous_text);
+  }
+}
+
+/*
+ * Static functions.
+ */
+
+auto Phase::get_records() -> vector<Record> {
+  auto& registry = get_registry();
+  vector<Record> records;
+  lock_guard lock(registry.mut);
+  for (const auto& buffer : registry.buffers) {
+    read_buffer(*buffer, records, false);
+  }
+  return records;
+}
+
+auto Phase::take_records() -> vector<Record> {
+  auto& registry = get_registry();
+  vector<Record> records;
+  lock_guard lock(registry.mut);
+  for (const auto& buffer : registry.buffers) {
+    read_buffer(*buffer, records, true);
+  }
+  return records;
+}
+
+auto Phase::get_dropped_count() -> size_t {
+  auto& registry = get_registry();
+  size_t dropped = 0U;
+  lock_guard lock(registry.mut);
+  for (const auto& buffer : registry.buffers) {
+    dropped += buffer->dropped.load(memory_order_relaxed);
+  }
+  return dropped;
+}
+
+auto Phase::format_summary(
+    const optional<Terminal::ColorsSupport>& t_colors_support,
+    const Palette& t_palette) -> string {
+
+  struct Stats {
+    size_t calls;
+    nanoseconds total, max;
+  };
+  map<string_view, Stats> stats;
+  nanoseconds top_level_total{};
+  for (const auto& record : get_records()) {
+    auto& entry = stats[record.name];
+    ++entry.calls;
+    entry.total += record.duration;
+    entry.max = std::max(entry.max, record.duration);
+    if (record.depth == 0U) {
+      top_level_total += record.duration;
+    }
+  }
+
+  vector<pair<string_view, Stats>> rows(stats.cbegin(), stats.cend());
+  stable_sort(rows.begin(), rows.end(), [] (const auto& t_a, const auto& t_b)
+      { return t_a.second.total > t_b.second.total; });
+
+  // Cells of each row, the first one is the header.
+  constexpr size_t COLUMNS = 6U;
+  vector<array<string, COLUMNS>> table{
+    {"Phase", "Calls", "Total", "Average", "Max", "Share"}
+  };
+  for (const auto& [name, entry] : rows) {
+    array<char, 16U> share{};
+    snprintf(share.data(), share.size(), "%.1f%%",
+        top_level_total.count() == 0 ? 0.0 :
+        static_cast<double>(entry.total.count()) * 100.0 /
+        static_cast<double>(top_level_total.count()));
+    table.push_back({string(name), to_string(entry.calls),
+        format_duration(entry.total),
+        format_duration(entry.total / static_cast<long>(entry.calls)),
+        format_duration(entry.max), share.data()});
+  }
+
+  array<size_t, COLUMNS> widths{};
+  for (const auto& row : table) {
+    for (size_t i = 0U; i != COLUMNS; ++i) {
+      widths.at(i) = std::max(widths.at(i), Text::visible_width(row.at(i)));
+    }
+  }
+
+  // Names aren't formatted as they can contain specifiers.
+  const auto
+      header_style = Text::format_copy("<b>", t_colors_support, t_palette),
+      name_style = Text::format_copy("~c~", t_colors_support, t_palette),
+      reset_style = Text::format_copy("<r>", t_colors_support, t_palette);
+
+  string result;
+  for (size_t row = 0U; row != table.size(); ++row) {
+    for (size_t i = 0U; i != COLUMNS; ++i) {
+      const auto& cell = table.at(row).at(i);
+      const string padding(widths.at(i) - Text::visible_width(cell), ' ');
+      if (i != 0U) {
+        result += "  ";
+      }
+      if (row == 0U) {
+        result += header_style;
+      } else if (i == 0U) {
+        result += name_style;
+      }
+      // Names are aligned to the left and numbers to the right.
+      result += i == 0U ? cell + padding : padding + cell;
+      if (row == 0U || i == 0U) {
+        result += reset_style;
+      }
+    }
+    result += '\n';
+  }
+  return result;
+}
+
+void Phase::write_trace(const filesystem::path& t_path) {
+  ofstream file(t_path);
+  if (!file) {
+    throw filesystem::filesystem_error("couldn't open trace file", t_path,
+        error_code(errno, generic_category()));
+  }
+
+  const auto pid = getpid();
+  file << "{\"traceEvents\":[";
+  bool first = true;
+  for (const auto& record : get_records()) {
+    file << (first ? "" : ",") << "\n{\"name\":\"" << escape_json(record.name)
+        << "\",\"ph\":\"X\",\"ts\":" << format_microseconds(record.start)
+        << ",\"dur\":" << format_microseconds(record.duration)
+        << ",\"pid\":" << pid
+        << ",\"tid\":" << record.thread << '}';
+    first = false;
+  }
+  file << "\n]}\n";
+  if (!file) {
+    throw filesystem::filesystem_error("couldn't write trace file", t_path,
+        error_code(errno, generic_category()));
+  }
+}
+
+void Phase::report_at_exit(ostream& t_ostream,
+    optional<filesystem::path> t_trace_path) {
+  auto& registry = get_registry();
+  lock_guard lock(registry.mut);
+  const bool registered = registry.report_ostream != nullptr;
+  registry.report_ostream = &t_ostream;
+  registry.trace_path = move(t_trace_path);
+
+  if (!registered) {
+    atexit([] {
+      auto& registry = get_registry();
+      *registry.report_ostream << format_summary() << flush;
+      if (registry.trace_path) {
+        try {
+          write_trace(*registry.trace_path);
+        } catch (const filesystem::filesystem_error& e) {
+          *registry.report_ostream << e.what() << endl;
+        }
+      }
+    });
+  }
+}
@@ -15,11 +15,16 @@
  * limitations under the License.
  */
 
+#include <array>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
+#include <stdexcept>
+#include <vector>
 
+#include "fcli/internal/statistics.hpp"
 #include "fcli/progress.hpp"
+#include "fcli/recording.hpp"
 #include "fcli/text.hpp"
 
 using namespace std;
@@ -29,14 +34,53 @@ using namespace chrono_literals;
 using namespace fcli;
 using namespace fcli::internal;
 
+namespace {
+  // Incremented when default styles are changed to rebuild default skins.
+  atomic<unsigned> default_styles_version;
+  // Don't use milliseconds::max() as it leads to overflow.
+  constexpr milliseconds MAX_WAIT_TIME = 1h;
+} // Namespace.
+
+struct Progress::Skin {
+  // Formatted ones.
+  styles_t styles;
+  Indicator indicator{get_indicator(BuiltInIndicator::_DEFAULT)};
+  string
+      success_symbol{get_success_symbol(SuccessSymbol::_DEFAULT)},
+      failure_symbol{get_failure_symbol(FailureSymbol::_DEFAULT)};
+  // Indicator frames surrounded by styles, placed one after another.
+  string frames;
+  vector<size_t> frame_ends;
+
+  // Must be called after changing styles or the indicator.
+  void render_frames() {
+    frames.clear();
+    frame_ends.clear();
+    for (const auto& frame : indicator.frames) {
+      frames += styles.get(Style::INDICATOR) +
+          frame.substr(0U, Indicator::MAX_FRAME_SIZE) +
+          styles.get(Style::PLAIN);
+      frame_ends.push_back(frames.length());
+    }
+  }
+
+  [[nodiscard]] auto get_frame(size_t t_index) const -> string_view {
+    if (t_index >= frame_ends.size()) {
+      return {};
+    }
+    const auto begin = t_index == 0U ? 0U : frame_ends[t_index - 1U];
+    return string_view(frames).substr(begin, frame_ends[t_index] - begin);
+  }
+};
+
 Progress::Progress(string_view t_text, bool t_determined,
     unsigned short t_width,
     const optional<Terminal::ColorsSupport>& t_colors_support,
     const Palette& t_palette):
 
-    m_text(t_text), m_determined(t_determined),
-    m_width(min(t_width, MAX_WIDTH)),
-    m_formatted_styles(format_default_styles(t_colors_support, t_palette)) {
+    m_text(t_text), m_text_width(Text::visible_width(t_text)),
+    m_determined(t_determined), m_width(min(t_width, MAX_WIDTH)),
+    m_skin(get_default_skin(t_colors_support, t_palette)) {
 
   if (t_width < MIN_WIDTH) {
     throw no_space_error();
@@ -47,7 +91,8 @@ Progress::Progress(const Progress& t_other):
     m_determined(t_other.m_determined.load()),
     m_width(t_other.m_width.load()),
     m_append_dots(t_other.m_append_dots.load()),
-    m_info_update_interval(t_other.m_info_update_interval.load()) {
+    m_info_update_interval(t_other.m_info_update_interval.load()),
+    m_driver(t_other.m_driver.load()) {
 
   copy_percents(t_other);
   lock_guard lock(t_other.m_mut);
@@ -60,6 +105,7 @@ auto Progress::operator=(const Progress& t_other) -> Progress& {
     m_width = t_other.m_width.load();
     m_append_dots = t_other.m_append_dots.load();
     m_info_update_interval = t_other.m_info_update_interval.load();
+    m_driver = t_other.m_driver.load();
 
     copy_percents(t_other);
     scoped_lock locks{m_mut, t_other.m_mut};
@@ -84,13 +130,14 @@ void Progress::copy_non_atomic(const Progress& t_other) {
   } else {
     m_text = t_other.m_text;
   }
-  m_formatted_styles = t_other.m_formatted_styles;
-
-  m_indicator = t_other.m_indicator;
+  m_text_width = Text::visible_width(m_text);
+  m_skin = t_other.m_skin;
   m_invalidate_frame_it = true;
-
-  m_success_symbol = t_other.m_success_symbol;
-  m_failure_symbol = t_other.m_failure_symbol;
+  m_clock = t_other.m_clock;
+  m_stall_timeout = t_other.m_stall_timeout;
+  m_stall_min_rate = t_other.m_stall_min_rate;
+  m_stall_window_start.reset();
+  m_stalled = false;
 }
 
 void Progress::show() {
@@ -98,9 +145,26 @@ void Progress::show() {
     return;
   }
 
-  m_hidden = m_force_update = false;
+  m_state = State::RUNNING;
   m_invalidate_frame_it = true;
-  m_updater = thread(&Progress::update, this);
+  m_mut.lock();
+  m_prev_frame_time.reset();
+  m_stall_window_start.reset();
+  m_printed_width = 0U;
+  m_printed_lines = 0U;
+  if (m_recorder) {
+    m_recorder->record(get_now(), recording::Type::SHOW);
+  }
+  m_mut.unlock();
+
+  if (m_driver == Driver::THREAD) {
+    m_hidden = m_force_update = false;
+    m_updater = thread(&Progress::update, this);
+  } else {
+    m_hidden = false;
+    // The first frame should be drawn immediately.
+    notify();
+  }
 }
 
 void Progress::hide() {
@@ -113,25 +177,93 @@ void Progress::hide() {
   if (m_updater.joinable()) {
     m_updater.join();
   }
+  lock_guard lock(m_mut);
+  // Does nothing if the frame is erased by the updater.
+  erase_frame();
+  if (m_recorder) {
+    m_recorder->record(get_now(), recording::Type::HIDE);
+  }
 }
 
 void Progress::finish(bool t_success, string_view t_message) {
   hide();
+  m_state = t_success ? State::SUCCEEDED : State::FAILED;
+  const auto result = format_result(t_success, t_message);
+  m_ostream << result << endl;
+
+  lock_guard lock(m_mut);
+  const ScopeTimer timer(m_statistics.get(),
+      &ProgressStatistics::lock_nanoseconds);
+  count(m_statistics.get(), &ProgressStatistics::bytes_written,
+      result.length() + 1U);
+  if (m_recorder) {
+    const auto now = get_now();
+    m_recorder->record(now, recording::Type::FINISH, t_success, t_message);
+    m_recorder->record(now, recording::Type::OUTPUT, false, result + '\n');
+  }
+  call_frame_handlers({});
+}
+
+auto Progress::format_result(bool t_success, string_view t_message) const ->
+    string {
+  lock_guard lock(m_mut);
+  const ScopeTimer timer(m_statistics.get(),
+      &ProgressStatistics::lock_nanoseconds);
 
+  const auto& styles = m_skin->styles;
   string prefix = " ";
   if (t_success) {
-    prefix += m_formatted_styles[Style::SUCCESS_SYMBOL] + m_success_symbol;
+    prefix += styles.get(Style::SUCCESS_SYMBOL) + m_skin->success_symbol;
   } else {
-    prefix += m_formatted_styles[Style::FAILURE_SYMBOL] + m_failure_symbol;
+    prefix += styles.get(Style::FAILURE_SYMBOL) + m_skin->failure_symbol;
   }
-  prefix += m_formatted_styles[Style::PLAIN] + ' ';
+  prefix += styles.get(Style::PLAIN) + ' ';
+  return prefix + string(t_message);
+}
 
-  m_ostream << prefix + string(t_message) << endl;
+auto Progress::detect_stall(time_point_t t_now, double t_percents)
+    -> milliseconds {
+  const auto restart = [this, t_now, t_percents] {
+    m_stall_window_start = t_now;
+    m_stall_window_percents = t_percents;
+    return m_stall_timeout;
+  };
+
+  // Complete progress can't stall.
+  if (!m_stall_window_start || t_percents >= MAX_PERCENTS) {
+    set_stalled(false);
+    return restart();
+  }
+
+  const auto growth = t_percents - m_stall_window_percents;
+  if (m_stall_min_rate == 0.0 && growth > 0.0) {
+    // Any growth means the progress is alive.
+    set_stalled(false);
+    return restart();
+  }
+
+  const auto elapsed = t_now - *m_stall_window_start;
+  if (elapsed >= m_stall_timeout) {
+    set_stalled(growth <=
+        m_stall_min_rate * duration<double>(elapsed).count());
+    return restart();
+  }
+  return ceil<milliseconds>(m_stall_timeout - elapsed);
+}
+
+void Progress::set_stalled(bool t_stalled) {
+  if (m_stalled.exchange(t_stalled) != t_stalled && m_stall_handler) {
+    m_stall_handler(t_stalled);
+  }
 }
 
 void Progress::notify() {
+  count(m_statistics.get(), &ProgressStatistics::notifications);
   m_force_update_mut.lock();
   m_force_update = true;
+  if (m_wakeup_handler) {
+    m_wakeup_handler();
+  }
   m_force_update_mut.unlock();
   m_force_update_cv.notify_one();
 }
@@ -169,190 +301,353 @@ auto Progress::operator=(const pair<string, double>& t_info) -> Progress& {
  * Main logic.
  */
 
-void Progress::update() {
-  // Used to measure passed time.
-  auto prev_time_point = steady_clock::now();
-  milliseconds
-      // Maximum time to wait for next update.
-      wait_time,
-      // Passed time after waiting.
-      passed_time,
-      // Set maximum value to immediately update indicator.
-      update_frame_passed_time = milliseconds::max(),
-      update_dots_passed_time;
-
-  decltype(Indicator::frames)::const_iterator frame_it;
-  // Current number of displayed dots. If text size is more than
-  // space_for_text + MAX_DOTS, then static MAX_DOTS dots will be displayed.
-  size_t dots_count = 0U;
-
-  unsigned short space_for_text = 0U;
-  size_t loading_bar_end_pos = 0U;
-  string indicator, text, dots, percents, result;
-
-  ostringstream percents_oss;
-  percents_oss << fixed;
-  percents_oss.precision(1);
+auto Progress::render_frame() -> string {
+  lock_guard lock(m_mut);
+  const ScopeTimer timer(m_statistics.get(),
+      &ProgressStatistics::lock_nanoseconds);
+  return build_frame(get_now());
+}
 
-  // Cached values (that used at least twice during
-  // progress generation) of atomic members.
-  bool determined_cached = false;
-  unsigned short width_cached = 0U;
-  double percents_cached = 0.0;
-  milliseconds info_update_interval_cached;
-  time_point<steady_clock> next_info_update_cached;
+auto Progress::next_deadline() const -> time_point_t {
+  if (m_hidden || m_driver != Driver::EXTERNAL) {
+    return time_point_t::max();
+  }
 
-  // Don't use milliseconds::max() as it leads to overflow.
-  constexpr milliseconds MAX_WAIT_TIME = 1h;
+  m_force_update_mut.lock();
+  const bool force_update = m_force_update;
+  m_force_update_mut.unlock();
+  lock_guard lock(m_mut);
+  const ScopeTimer timer(m_statistics.get(),
+      &ProgressStatistics::lock_nanoseconds);
+
+  if (force_update || !m_prev_frame_time) {
+    // The epoch is in the past for any clock.
+    return {};
+  }
+  return *m_prev_frame_time + m_wait_time;
+}
+
+auto Progress::step(time_point_t t_now) -> bool {
+  // Deadline is the maximum if the progress isn't driven externally.
+  if (next_deadline() > t_now) {
+    count(m_statistics.get(), &ProgressStatistics::frames_skipped);
+    return false;
+  }
+  render_once(t_now);
+  return true;
+}
+
+void Progress::render_once(time_point_t t_now) {
+  if (m_hidden || m_driver != Driver::EXTERNAL) {
+    count(m_statistics.get(), &ProgressStatistics::frames_skipped);
+    return;
+  }
+
+  m_force_update_mut.lock();
+  m_force_update = false;
+  m_force_update_mut.unlock();
+
+  lock_guard lock(m_mut);
+  const ScopeTimer timer(m_statistics.get(),
+      &ProgressStatistics::lock_nanoseconds);
+  draw_frame(t_now);
+}
+
+void Progress::set_recorder(shared_ptr<Recorder> t_recorder) {
+  lock_guard lock(m_mut);
+  m_recorder = move(t_recorder);
+  m_recording = m_recorder != nullptr;
+  if (!m_recorder) {
+    return;
+  }
+  const auto now = get_now();
+  m_recorder->record(now, recording::Type::TEXT, false, m_text);
+  m_recorder->record_value(now, recording::Type::PERCENTS, m_percents.load());
+  m_recorder->record(now, recording::Type::DETERMINED, m_determined);
+  m_recorder->record_value(now, recording::Type::WIDTH, m_width.load());
+  if (!m_hidden) {
+    m_recorder->record(now, recording::Type::SHOW);
+  }
+}
+
+void Progress::set_wakeup_handler(function<void()> t_handler) {
+  lock_guard lock(m_force_update_mut);
+  m_wakeup_handler = move(t_handler);
+}
+
+auto Progress::add_frame_handler(
+    function<void(const Snapshot&)> t_handler) -> size_t {
+  lock_guard lock(m_mut);
+  const auto id = m_next_frame_handler_id++;
+  m_frame_handlers.emplace(id, move(t_handler));
+  return id;
+}
+
+void Progress::remove_frame_handler(size_t t_id) {
+  lock_guard lock(m_mut);
+  m_frame_handlers.erase(t_id);
+}
+
+void Progress::update() {
+  milliseconds wait_time;
 
   while (true) {
-    // Wait ONLY for new changes outside if no part
-    // of the progress should be updated automatically.
-    wait_time = MAX_WAIT_TIME;
-    determined_cached = m_determined;
-    percents_cached = m_percents;
-    info_update_interval_cached = m_info_update_interval;
-    next_info_update_cached = m_next_info_update;
-    space_for_text = width_cached = m_width;
-
-    /*
-     * Begin of progress generation.
-     */
-
-    m_mut.lock();
-
-    if (determined_cached) {
-      // Empty stream and reset any error flags.
-      percents_oss.str({});
-      percents_oss.clear();
-
-      // Is it time to release all pending values?
-      if (next_info_update_cached <= prev_time_point) {
-        const auto pending_percents = m_pending_percents.load();
-        // Is there pending percents value?
-        if (pending_percents >= 0.0) {
-          m_percents = percents_cached = pending_percents;
-          m_pending_percents = -1.0;
-          m_next_info_update = prev_time_point + info_update_interval_cached;
-        }
-      }
-      percents_oss << percents_cached << '%';
-      percents = percents_oss.str();
+    {
+      lock_guard lock(m_mut);
+      const ScopeTimer timer(m_statistics.get(),
+          &ProgressStatistics::lock_nanoseconds);
+      draw_frame(get_now());
+      wait_time = m_wait_time;
+    }
 
-      // Plus one space that will be placed later.
-      space_for_text -= percents.length() + 1U;
-    } else {
-      // Iterator invalidates when new indicator is set.
-      if (m_invalidate_frame_it) {
-        frame_it = m_indicator.frames.cbegin();
-        m_invalidate_frame_it = false;
-        // Immediately show new frame.
-        update_frame_passed_time = m_indicator.update_interval;
-      } else {
-        update_frame_passed_time += passed_time;
-      }
+    unique_lock update_lock(m_force_update_mut);
+    m_force_update_cv.wait_for(update_lock, wait_time,
+        [this] { return m_force_update; });
+    m_force_update = false;
+    update_lock.unlock();
+    count(m_statistics.get(), &ProgressStatistics::updater_wakeups);
+
+    if (m_hidden) {
+      lock_guard lock(m_mut);
+      erase_frame();
+      return;
+    }
+  }
+}
 
-      if (update_frame_passed_time >= m_indicator.update_interval) {
-        update_frame_passed_time = 0ms;
+void Progress::draw_frame(time_point_t t_now) {
+  const auto terminal_width = m_terminal_width.load();
+  if (terminal_width != 0U && terminal_width < MIN_WIDTH) {
+    // Frame can't fit the terminal, so it isn't drawn until it's widened
+    // (the width change notifies the updater).
+    erase_frame();
+    m_prev_frame_time = t_now;
+    m_wait_time = MAX_WAIT_TIME;
+    return;
+  }
 
-        // Don't store formatted styles here as they can be changed and
-        // user will wait for new indicator iteration to see changes.
-        indicator = frame_it->substr(0U, Indicator::MAX_FRAME_SIZE);
-        // 2U is spaces around indicator.
-        space_for_text -= 2U + m_indicator.fixed_visible_length;
+  const auto frame = build_frame(t_now);
+  const auto output = build_erase() + frame;
+  m_ostream << output << flush;
+  count(m_statistics.get(), &ProgressStatistics::bytes_written,
+      output.length());
+  if (m_recorder) {
+    m_recorder->record(t_now, recording::Type::OUTPUT, false, output);
+  }
+  call_frame_handlers(frame);
+  m_printed_width = m_width;
+  m_printed_lines = static_cast<size_t>(count(frame.cbegin(), frame.cend(),
+      '\n')) + 1U;
+}
 
-        if (++frame_it == m_indicator.frames.cend()) {
-          frame_it = m_indicator.frames.cbegin();
-        }
-      }
-      wait_time = m_indicator.update_interval - update_frame_passed_time;
+void Progress::call_frame_handlers(string_view t_frame) {
+  if (m_frame_handlers.empty()) {
+    return;
+  }
+  const Snapshot snapshot{m_text, m_percents, m_determined, m_state, t_frame};
+  for (auto& [id, handler] : m_frame_handlers) {
+    handler(snapshot);
+  }
+}
+
+auto Progress::build_erase() -> string {
+  if (!m_resized.exchange(false)) {
+    return get_empty_lines(m_printed_width, m_printed_lines);
+  }
+
+  // A reflowing terminal wraps each printed line into several rows.
+  size_t rows = m_printed_lines;
+  if (const size_t terminal_width = m_terminal_width;
+      terminal_width != 0U && m_printed_width > terminal_width) {
+    rows *= (m_printed_width + terminal_width - 1U) / terminal_width;
+  }
+
+  constexpr string_view CLEAR_LINE = "\r\033[2K", CURSOR_UP = "\033[1A";
+  string erase(CLEAR_LINE);
+  for (size_t i = 1U; i < rows; ++i) {
+    erase += string(CURSOR_UP) + string(CLEAR_LINE);
+  }
+  return erase;
+}
+
+void Progress::erase_frame() {
+  if (m_printed_lines != 0U) {
+    const auto erase = build_erase();
+    m_ostream << erase << flush;
+    count(m_statistics.get(), &ProgressStatistics::bytes_written,
+        erase.length());
+    if (m_recorder) {
+      m_recorder->record(get_now(), recording::Type::OUTPUT, false,
+          erase);
     }
+    m_printed_width = 0U;
+    m_printed_lines = 0U;
+  }
+}
 
-    if (m_append_dots) {
-      space_for_text -= MAX_DOTS;
+auto Progress::build_frame(time_point_t t_now) -> string {
+  count(m_statistics.get(), &ProgressStatistics::frames_rendered);
+  // Passed time since the previous frame.
+  const auto passed_time = m_prev_frame_time ?
+      duration_cast<milliseconds>(t_now - *m_prev_frame_time) : 0ms;
+  m_prev_frame_time = t_now;
 
-      if (space_for_text < m_text.length()) {
-        // Use static dots if text doesn't fit terminal width.
-        dots = string(MAX_DOTS, '.');
-      } else {
-        update_dots_passed_time += passed_time;
+  // Wait ONLY for new changes outside if no part
+  // of the progress should be updated automatically.
+  auto wait_time = MAX_WAIT_TIME;
 
-        if (update_dots_passed_time >= DOTS_UPDATE_INTERVAL) {
-          update_dots_passed_time = 0ms;
+  // Cached values (that used at least twice during
+  // progress generation) of atomic members.
+  const bool determined_cached = m_determined;
+  const unsigned short width_cached = m_width;
+  const auto info_update_interval_cached = m_info_update_interval.load();
+  const auto next_info_update_cached = m_next_info_update.load();
 
-          if (++dots_count > MAX_DOTS) {
-            dots_count = 0U;
-          }
-          dots = string(dots_count, '.');
-        }
-        wait_time =
-            min(DOTS_UPDATE_INTERVAL - update_dots_passed_time, wait_time);
+  unsigned short space_for_text = width_cached;
+  string percents, result;
+
+  if (m_percents_source) {
+    m_percents = clamp(m_percents_source(), 0.0, MAX_PERCENTS);
+    wait_time = SOURCE_POLL_INTERVAL;
+  }
+  double percents_cached = m_percents;
+
+  if (determined_cached) {
+    // Is it time to release all pending values?
+    if (next_info_update_cached <= t_now) {
+      const auto pending_percents = m_pending_percents.load();
+      // Is there pending percents value?
+      if (pending_percents >= 0.0) {
+        m_percents = percents_cached = pending_percents;
+        m_pending_percents = -1.0;
+        m_next_info_update = t_now + info_update_interval_cached;
       }
-    } else {
-      dots.clear();
     }
 
-    if (next_info_update_cached <= prev_time_point) {
-      if (m_pending_text) {
-        m_text = *m_pending_text;
-        m_pending_text.reset();
-        m_next_info_update = prev_time_point + info_update_interval_cached;
-      }
+    ostringstream percents_oss;
+    percents_oss << fixed;
+    percents_oss.precision(1);
+    percents_oss << percents_cached << '%';
+    percents = percents_oss.str();
+
+    // Plus one space that will be placed later.
+    space_for_text -= percents.length() + 1U;
+
+    if (m_stall_timeout != 0ms) {
+      wait_time = min(detect_stall(t_now, percents_cached), wait_time);
+    }
+  } else {
+    // Rate of an undetermined progress is unknown.
+    m_stall_window_start.reset();
+    set_stalled(false);
+
+    // Iterator invalidates when new indicator is set.
+    const auto& indicator = m_skin->indicator;
+    if (m_invalidate_frame_it) {
+      m_next_frame_index = 0U;
+      m_invalidate_frame_it = false;
+      // Immediately show new frame.
+      m_frame_passed_time = indicator.update_interval;
     } else {
-      wait_time = min(duration_cast<milliseconds>(
-          next_info_update_cached - prev_time_point), wait_time);
+      m_frame_passed_time += passed_time;
     }
-    // Trim text from the end if need.
-    text = m_text.substr(0U, space_for_text);
-
-    if (determined_cached) {
-      result = text + dots;
-      result += string(width_cached -
-          (result.length() + percents.length() + 1U), ' ') + ' ';
-
-      loading_bar_end_pos = static_cast<size_t>(
-          round(static_cast<double>(width_cached) *
-          (percents_cached / MAX_PERCENTS)));
-
-      if (loading_bar_end_pos >= result.length()) {
-        percents.insert(loading_bar_end_pos - result.length(),
-            m_formatted_styles[Style::PLAIN] +
-            m_formatted_styles[Style::PERCENTS]);
-      } else {
-        result.insert(loading_bar_end_pos, m_formatted_styles[Style::PLAIN]);
+
+    if (m_frame_passed_time >= indicator.update_interval) {
+      m_frame_passed_time = 0ms;
+
+      m_frame_index = m_next_frame_index;
+      if (++m_next_frame_index >= m_skin->frame_ends.size()) {
+        m_next_frame_index = 0U;
       }
+    }
+    // 2U is spaces around indicator.
+    space_for_text -= 2U + indicator.fixed_visible_length;
+    wait_time = min(
+        indicator.update_interval - m_frame_passed_time, wait_time);
+  }
 
-      result = m_formatted_styles[Style::PLAIN] +
-          m_formatted_styles[Style::LOADING_BAR] + result +
-          m_formatted_styles[Style::PERCENTS] + percents;
+  if (m_append_dots) {
+    space_for_text -= MAX_DOTS;
+
+    if (space_for_text < m_text_width) {
+      // Use static dots if text doesn't fit terminal width.
+      m_dots = string(MAX_DOTS, '.');
     } else {
-      result = ' ' + m_formatted_styles[Style::INDICATOR] + indicator +
-          m_formatted_styles[Style::PLAIN] + ' ' + text + dots;
-    }
+      m_dots_passed_time += passed_time;
 
-    /*
-     * End of progress generation.
-     */
+      if (m_dots_passed_time >= DOTS_UPDATE_INTERVAL) {
+        m_dots_passed_time = 0ms;
 
-    m_ostream << get_empty_line(width_cached) + result << flush;
-    m_mut.unlock();
+        if (++m_dots_count > MAX_DOTS) {
+          m_dots_count = 0U;
+        }
+        m_dots = string(m_dots_count, '.');
+      }
+      wait_time =
+          min(DOTS_UPDATE_INTERVAL - m_dots_passed_time, wait_time);
+    }
+  } else {
+    m_dots.clear();
+  }
 
-    unique_lock update_lock(m_force_update_mut);
-    m_force_update_cv.wait_for(update_lock, wait_time,
-        [this] { return m_force_update; });
-    m_force_update = false;
-    update_lock.unlock();
+  if (next_info_update_cached <= t_now) {
+    if (m_pending_text) {
+      m_text = *m_pending_text;
+      m_text_width = Text::visible_width(m_text);
+      m_pending_text.reset();
+      m_next_info_update = t_now + info_update_interval_cached;
+    }
+  } else {
+    wait_time = min(duration_cast<milliseconds>(
+        next_info_update_cached - t_now), wait_time);
+  }
+  m_wait_time = wait_time;
+
+  const auto& styles = m_skin->styles;
+  // Trim text from the end if need.
+  string_view text = m_text;
+  auto text_width = m_text_width;
+  if (text_width > space_for_text) {
+    text = Text::truncate_to_width(text, space_for_text);
+    text_width = Text::visible_width(text);
+  }
 
-    if (m_hidden) {
-      lock_guard lock(m_mut);
-      m_ostream << get_empty_line(width_cached) << flush;
-      return;
+  if (determined_cached) {
+    result = string(text) + m_dots;
+    const auto result_width = text_width + m_dots.length();
+    result += string(width_cached -
+        (result_width + percents.length() + 1U), ' ') + ' ';
+
+    const auto loading_bar_end_pos = static_cast<size_t>(
+        round(static_cast<double>(width_cached) *
+        (percents_cached / MAX_PERCENTS)));
+
+    // Text is measured in columns, so the bar end is found by them too.
+    if (const auto padded_width = width_cached - percents.length();
+        loading_bar_end_pos >= padded_width) {
+      percents.insert(loading_bar_end_pos - padded_width,
+          styles.get(Style::PLAIN) + styles.get(Style::PERCENTS));
+    } else {
+      result.insert(Text::truncate_to_width(result, loading_bar_end_pos)
+          .length(), styles.get(Style::PLAIN));
     }
 
-    passed_time = duration_cast<milliseconds>(
-        steady_clock::now() - prev_time_point);
-    prev_time_point = steady_clock::now();
+    result = styles.get(Style::PLAIN) +
+        styles.get(m_stalled ? Style::STALLED : Style::LOADING_BAR) +
+        result + styles.get(Style::PERCENTS) + percents;
+  } else {
+    // Frame is rendered with styles beforehand.
+    result = ' ' + string(m_skin->get_frame(m_frame_index)) + ' ' +
+        string(text) + m_dots;
+  }
+
+  if (m_show_stage_text && m_root_stage) {
+    result += '\n' + styles.get(Style::PLAIN) +
+        string(STAGE_TEXT_INDENT) + string(Text::truncate_to_width(
+        m_root_stage->get_active_text(),
+        width_cached - STAGE_TEXT_INDENT.length()));
   }
+  return result;
 }
 
 /*
@@ -366,6 +661,14 @@ auto Progress::get_text() const -> string {
 
 void Progress::set_determined(bool t_determined) {
   m_determined = t_determined;
+  // Don't lock the mutex if nothing is recorded.
+  if (m_recording) {
+    lock_guard lock(m_mut);
+    if (m_recorder) {
+      m_recorder->record(get_now(), recording::Type::DETERMINED,
+          t_determined);
+    }
+  }
   notify();
 }
 
@@ -374,9 +677,82 @@ void Progress::set_width(unsigned short t_width) {
     throw no_space_error();
   }
   m_width = min(t_width, MAX_WIDTH);
+  if (m_recording) {
+    lock_guard lock(m_mut);
+    if (m_recorder) {
+      m_recorder->record_value(get_now(), recording::Type::WIDTH,
+          m_width.load());
+    }
+  }
+  notify();
+}
+
+void Progress::set_driver(Driver t_driver) {
+  if (m_driver == t_driver) {
+    return;
+  }
+  const bool shown = !m_hidden;
+  hide();
+  m_driver = t_driver;
+  if (shown) {
+    show();
+  }
+}
+
+auto Progress::get_clock() const -> clock_func_t {
+  lock_guard lock(m_mut);
+  return m_clock;
+}
+
+void Progress::set_clock(clock_func_t t_clock) {
+  lock_guard lock(m_mut);
+  m_clock = move(t_clock);
+  notify();
+}
+
+void Progress::set_auto_width(bool t_enable) {
+  lock_guard lock(m_mut);
+  if (t_enable == m_width_listener_id.has_value()) {
+    return;
+  }
+
+  if (t_enable) {
+    m_width_listener_id = Terminal::subscribe_width(
+        [this] (unsigned short width) { apply_terminal_width(width); });
+    apply_terminal_width(Terminal::get_cached_width());
+  } else {
+    Terminal::unsubscribe_width(*m_width_listener_id);
+    m_width_listener_id.reset();
+    m_terminal_width = 0U;
+  }
+}
+
+auto Progress::is_auto_width() const -> bool {
+  lock_guard lock(m_mut);
+  return m_width_listener_id.has_value();
+}
+
+void Progress::apply_terminal_width(unsigned short t_width) {
+  if (t_width == 0U) {
+    // Width is unknown.
+    return;
+  }
+  if (m_terminal_width.exchange(t_width) == t_width) {
+    return;
+  }
+  // Frames aren't drawn while the terminal is narrower than MIN_WIDTH.
+  m_width = clamp(t_width, MIN_WIDTH, MAX_WIDTH);
+  m_resized = true;
   notify();
 }
 
+auto Progress::get_statistics() const -> Statistics::ProgressCounters {
+  if (m_statistics) {
+    return m_statistics->load();
+  }
+  return {};
+}
+
 auto Progress::get_ostream() -> ostream& {
   lock_guard lock(m_mut);
   return m_ostream;
@@ -393,10 +769,21 @@ void Progress::set_info(const optional<string>& t_text,
     t_percents = clamp(*t_percents, 0.0, MAX_PERCENTS);
   }
   lock_guard lock(m_mut);
+  const ScopeTimer timer(m_statistics.get(),
+      &ProgressStatistics::lock_nanoseconds);
+  if (m_recorder) {
+    const auto now = get_now();
+    if (t_text) {
+      m_recorder->record(now, recording::Type::TEXT, false, *t_text);
+    }
+    if (t_percents) {
+      m_recorder->record_value(now, recording::Type::PERCENTS, *t_percents);
+    }
+  }
 
   if (const auto update_interval = m_info_update_interval.load();
       update_interval != 0ms) {
-    const auto current_time = steady_clock::now();
+    const auto current_time = get_now();
     if (m_next_info_update.load() > current_time) {
       if (t_text) {
         m_pending_text = t_text;
@@ -411,8 +798,10 @@ void Progress::set_info(const optional<string>& t_text,
 
   if (t_text) {
     m_text = *t_text;
+    m_text_width = Text::visible_width(m_text);
   } else if (m_pending_text) {
     m_text = *m_pending_text;
+    m_text_width = Text::visible_width(m_text);
   }
   m_pending_text.reset();
 
@@ -427,11 +816,52 @@ void Progress::set_info(const optional<string>& t_text,
   notify();
 }
 
+auto Progress::set_percents_source(function<double()> t_source) ->
+    function<double()> {
+  lock_guard lock(m_mut);
+  swap(m_percents_source, t_source);
+  notify();
+  return t_source;
+}
+
+auto Progress::add_stage(double t_weight, string_view t_text) -> Stage {
+  lock_guard lock(m_mut);
+  if (!m_root_stage) {
+    if (m_percents_source) {
+      throw logic_error("percents source is already set");
+    }
+    m_root_stage.emplace();
+    m_percents_source = [root = *m_root_stage] {
+      return root.get_percents();
+    };
+    notify();
+  }
+  return m_root_stage->add_stage(t_weight, t_text);
+}
+
+void Progress::set_stage_text_shown(bool t_show) {
+  m_show_stage_text = t_show;
+  notify();
+}
+
+void Progress::set_stall_detection(milliseconds t_timeout,
+    double t_min_rate, function<void(bool)> t_handler) {
+  lock_guard lock(m_mut);
+  // Stall ends for the previous handler.
+  set_stalled(false);
+  m_stall_timeout = t_timeout;
+  m_stall_min_rate = max(t_min_rate, 0.0);
+  m_stall_handler = move(t_handler);
+  m_stall_window_start.reset();
+  notify();
+}
+
 void Progress::set_info_update_interval(milliseconds t_interval) {
+  lock_guard lock(m_mut);
   m_info_update_interval = t_interval;
   const auto
       next_info_update = m_next_info_update.load(),
-      current_time = steady_clock::now();
+      current_time = get_now();
   if (next_info_update > current_time) {
     const auto update_wait_time =
         duration_cast<milliseconds>(next_info_update - current_time);
@@ -455,23 +885,55 @@ auto Progress::get_pending_percents() const -> optional<double> {
 
 auto Progress::get_indicator() const -> Indicator {
   lock_guard lock(m_mut);
-  return m_indicator;
+  return m_skin->indicator;
 }
 
 void Progress::set_indicator(const Indicator& t_indicator) {
-  lock_guard lock(m_mut);
-  m_indicator = t_indicator;
-  m_invalidate_frame_it = true;
-  notify();
+  change_skin([this, &t_indicator] (Skin& t_skin) {
+    t_skin.indicator = t_indicator;
+    m_invalidate_frame_it = true;
+  });
 }
 
 void Progress::set_style(Style t_part, string_view t_style,
     const optional<Terminal::ColorsSupport>& t_colors_support,
     const Palette& t_palette) {
 
+  const auto style =
+      Text::format_copy(string(t_style), t_colors_support, t_palette);
+  change_skin([t_part, &style] (Skin& t_skin) {
+    t_skin.styles.set(t_part, style);
+  });
+}
+
+auto Progress::get_success_symbol() const -> string {
+  lock_guard lock(m_mut);
+  return m_skin->success_symbol;
+}
+
+void Progress::set_success_symbol(string_view t_symbol) {
+  change_skin([t_symbol] (Skin& t_skin) {
+    t_skin.success_symbol = t_symbol;
+  });
+}
+
+auto Progress::get_failure_symbol() const -> string {
+  lock_guard lock(m_mut);
+  return m_skin->failure_symbol;
+}
+
+void Progress::set_failure_symbol(string_view t_symbol) {
+  change_skin([t_symbol] (Skin& t_skin) {
+    t_skin.failure_symbol = t_symbol;
+  });
+}
+
+void Progress::change_skin(const function<void(Skin&)>& t_change) {
   lock_guard lock(m_mut);
-  m_formatted_styles.set(t_part,
-      Text::format_copy(string(t_style), t_colors_support, t_palette));
+  auto skin = make_shared<Skin>(*m_skin);
+  t_change(*skin);
+  skin->render_frames();
+  m_skin = move(skin);
   notify();
 }
 
@@ -479,16 +941,74 @@ void Progress::set_style(Style t_part, string_view t_style,
  * Static functions.
  */
 
-auto Progress::format_default_styles(
+auto Progress::get_empty_lines(unsigned short t_width, size_t t_count) ->
+    string {
+  constexpr string_view CURSOR_UP = "\033[1A";
+  string result;
+  for (size_t i = 1U; i < t_count; ++i) {
+    result += '\r' + string(t_width, ' ') + string(CURSOR_UP);
+  }
+  return result + get_empty_line(t_width);
+}
+
+auto Progress::get_default_skin(
     const optional<Terminal::ColorsSupport>& t_colors_support,
-    const Palette& t_palette) -> styles_t {
+    const Palette& t_palette) -> shared_ptr<const Skin> {
+
+  struct Entry {
+    optional<Terminal::ColorsSupport> colors_support;
+    Palette palette;
+    shared_ptr<const Skin> skin;
+  };
+  // Leaked, so progresses can be created by destructors of static objects.
+  static auto& entries = *new vector<Entry>();
+  static auto& entries_mut = *new mutex();
+  static unsigned entries_version = 0U;
+
+  const auto is_same_palette = [&t_palette] (const Palette& t_other) {
+    const auto get_colors = [] (const Palette& t_colors) {
+      return array{t_colors.red, t_colors.green, t_colors.yellow,
+          t_colors.blue, t_colors.magenta, t_colors.cyan, t_colors.dim};
+    };
+    const auto colors = get_colors(t_palette), other_colors =
+        get_colors(t_other);
+    return equal(colors.cbegin(), colors.cend(), other_colors.cbegin(),
+        [] (const Palette::Color& t_first, const Palette::Color& t_second) {
+          return t_first.code == t_second.code &&
+              t_first.invert_text == t_second.invert_text;
+        });
+  };
+
+  lock_guard lock(entries_mut);
+  if (const auto version = default_styles_version.load();
+      version != entries_version) {
+    entries.clear();
+    entries_version = version;
+  }
+  for (const auto& entry : entries) {
+    if (entry.colors_support == t_colors_support &&
+        is_same_palette(entry.palette)) {
+      return entry.skin;
+    }
+  }
 
-  styles_t formatted_styles;
-  s_default_styles->for_each([&] (Style name, string& style) {
-    formatted_styles.set(name,
-        Text::format_copy(style, t_colors_support, t_palette));
+  auto skin = make_shared<Skin>();
+  s_default_styles->for_each([&] (Style t_name, string& t_style) {
+    skin->styles.set(t_name,
+        Text::format_copy(t_style, t_colors_support, t_palette));
   });
-  return formatted_styles;
+  skin->render_frames();
+  entries.push_back({t_colors_support, t_palette, skin});
+  return skin;
+}
+
+auto Progress::get_default_style(Style t_name) -> string {
+  return s_default_styles->get(t_name);
+}
+
+void Progress::set_default_style(Style t_name, string_view t_style) {
+  s_default_styles->set(t_name, string(t_style));
+  ++default_styles_version;
 }
 
 auto Progress::get_indicator(BuiltInIndicator t_name) -> Indicator {
@@ -0,0 +1,231 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <streambuf>
+#include <system_error>
+#include <thread>
+
+#include "fcli/progress.hpp"
+#include "fcli/recording.hpp"
+#include "fcli/virtual_clock.hpp"
+
+using namespace std;
+using namespace chrono;
+
+using namespace fcli;
+using namespace fcli::internal;
+
+namespace {
+  // Forwards output to another buffer and counts written bytes.
+  class CountingStreambuf : public streambuf {
+  public:
+    explicit CountingStreambuf(streambuf& t_target): m_target(t_target) {}
+
+    [[nodiscard]] inline auto get_bytes() const { return m_bytes; }
+
+  protected:
+    auto overflow(int_type t_char) -> int_type override {
+      if (traits_type::eq_int_type(t_char, traits_type::eof())) {
+        return traits_type::not_eof(t_char);
+      }
+      ++m_bytes;
+      return m_target.sputc(traits_type::to_char_type(t_char));
+    }
+
+    auto xsputn(const char* t_str, streamsize t_count) -> streamsize override {
+      m_bytes += static_cast<uintmax_t>(t_count);
+      return m_target.sputn(t_str, t_count);
+    }
+
+    auto sync() -> int override { return m_target.pubsync(); }
+
+  private:
+    streambuf& m_target;
+    uintmax_t m_bytes{};
+  };
+
+  [[nodiscard]] auto get_cpu_time() -> nanoseconds {
+    timespec time{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+    return seconds(time.tv_sec) + nanoseconds(time.tv_nsec);
+  }
+
+  template<typename T>
+  [[nodiscard]] auto read_value(const string& t_payload) -> T {
+    if (t_payload.size() != sizeof(T)) {
+      throw Replayer::format_error();
+    }
+    T value;
+    memcpy(&value, t_payload.data(), sizeof(T));
+    return value;
+  }
+} // Namespace.
+
+/*
+ * Recorder.
+ */
+
+Recorder::Recorder(const filesystem::path& t_path):
+    m_path(t_path), m_file(t_path, ios::binary | ios::trunc) {
+  m_file.write(recording::MAGIC.data(),
+      static_cast<streamsize>(recording::MAGIC.size()));
+  if (!m_file) {
+    throw filesystem::filesystem_error("couldn't create recording", t_path,
+        error_code(errno, generic_category()));
+  }
+}
+
+void Recorder::flush() {
+  lock_guard lock(m_mut);
+  if (!m_file.flush()) {
+    throw filesystem::filesystem_error("couldn't write recording", m_path,
+        error_code(errno, generic_category()));
+  }
+}
+
+void Recorder::record(time_point_t t_now, type_t t_type, bool t_flag,
+    string_view t_payload) {
+  lock_guard lock(m_mut);
+  if (!m_start) {
+    m_start = t_now;
+  }
+  // A clock of the progress can be changed, but events must stay ordered.
+  m_last_time = max(m_last_time, duration_cast<nanoseconds>(t_now - *m_start));
+  const recording::Header header{static_cast<uint64_t>(m_last_time.count()),
+      static_cast<uint32_t>(t_payload.size()), t_type, t_flag, 0U};
+  m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  m_file.write(t_payload.data(), static_cast<streamsize>(t_payload.size()));
+}
+
+/*
+ * Replayer.
+ */
+
+Replayer::Replayer(const filesystem::path& t_path) {
+  ifstream file(t_path, ios::binary);
+  if (!file) {
+    throw filesystem::filesystem_error("couldn't open recording", t_path,
+        error_code(errno, generic_category()));
+  }
+
+  string magic(recording::MAGIC.size(), '\0');
+  file.read(magic.data(), static_cast<streamsize>(magic.size()));
+  if (!file || magic != recording::MAGIC) {
+    throw format_error();
+  }
+
+  recording::Header header{};
+  while (file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    if (header.type >= recording::Type::_COUNT) {
+      throw format_error();
+    }
+    Event event{nanoseconds(header.nanoseconds), header.type,
+        header.flag != 0U, string(header.payload_size, '\0')};
+    if (!file.read(event.payload.data(),
+        static_cast<streamsize>(event.payload.size()))) {
+      throw format_error();
+    }
+    m_events.push_back(move(event));
+  }
+  // Truncated header.
+  if (file.gcount() != 0) {
+    throw format_error();
+  }
+}
+
+auto Replayer::run(ostream& t_ostream, double t_speed) const -> Report {
+  using recording::Type;
+
+  CountingStreambuf buffer(*t_ostream.rdbuf());
+  ostream stream(&buffer);
+  VirtualClock clock;
+  Progress progress("", true, stream);
+  atomic<size_t> frames{};
+  progress.add_frame_handler([&frames] (const Progress::Snapshot& t_frame) {
+    if (t_frame.state == Progress::State::RUNNING) {
+      ++frames;
+    }
+  });
+
+  const bool virtual_time = t_speed <= 0.0;
+  if (virtual_time) {
+    progress.set_clock(clock.get_function());
+    progress.set_driver(Progress::Driver::EXTERNAL);
+  }
+
+  Report report{m_events.size(), 0U, 0U, 0U, {}, {}};
+  const auto cpu_start = get_cpu_time();
+  const auto start = steady_clock::now();
+
+  for (const auto& event : m_events) {
+    if (virtual_time) {
+      // Draw frames that are due before the event.
+      const auto time = Progress::time_point_t(event.time);
+      for (auto deadline = progress.next_deadline(); deadline <= time;
+          deadline = progress.next_deadline()) {
+        clock.set(max(deadline, clock.now()));
+        progress.render_once(clock.now());
+      }
+      clock.set(max(time, clock.now()));
+    } else {
+      this_thread::sleep_until(start + duration_cast<nanoseconds>(
+          duration<double, nano>(static_cast<double>(event.time.count()) /
+          t_speed)));
+    }
+
+    switch (event.type) {
+      case Type::TEXT:
+        progress.set_text(event.payload);
+        break;
+      case Type::PERCENTS:
+        progress.set_percents(read_value<double>(event.payload));
+        break;
+      case Type::DETERMINED:
+        progress.set_determined(event.flag);
+        break;
+      case Type::WIDTH:
+        progress.set_width(read_value<unsigned short>(event.payload));
+        break;
+      case Type::SHOW:
+        progress.show();
+        break;
+      case Type::HIDE:
+        progress.hide();
+        break;
+      case Type::FINISH:
+        progress.finish(event.flag, event.payload);
+        break;
+      case Type::OUTPUT:
+        report.recorded_bytes += event.payload.size();
+        break;
+      case Type::_COUNT:
+        break;
+    }
+  }
+  progress.hide();
+
+  report.cpu_time = get_cpu_time() - cpu_start;
+  report.duration = steady_clock::now() - start;
+  report.frames = frames;
+  report.bytes = buffer.get_bytes();
+  return report;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <poll.h>
+#include <sys/uio.h>
+#include <system_error>
+#include <unistd.h>
+
+#include "fcli/remote_progress.hpp"
+
+using namespace fcli;
+using namespace fcli::internal;
+using namespace std;
+
+RemoteProgress::RemoteProgress(int t_out_file_desc, string_view t_text,
+    bool t_determined): m_out_file_desc(t_out_file_desc),
+    m_process_id(static_cast<uint32_t>(getpid())) {
+  send(type_t::CREATE, t_determined, t_text.data(), t_text.size(), false);
+}
+
+RemoteProgress::~RemoteProgress() {
+  if (!m_finished) {
+    try {
+      send(type_t::REMOVE, false, nullptr, 0U, false);
+    } catch (...) {
+      // Parent can be already gone, nothing to do.
+    }
+  }
+}
+
+void RemoteProgress::finish(bool t_success, string_view t_message) {
+  if (m_finished) {
+    return;
+  }
+  send(type_t::FINISH, t_success, t_message.data(), t_message.size(), false);
+  m_finished = true;
+}
+
+auto RemoteProgress::operator++() -> RemoteProgress& {
+  set_percents(m_percents + 1.0);
+  return *this;
+}
+
+auto RemoteProgress::operator+=(double t_percents) -> RemoteProgress& {
+  set_percents(m_percents + t_percents);
+  return *this;
+}
+
+auto RemoteProgress::operator=(double t_percents) -> RemoteProgress& {
+  set_percents(t_percents);
+  return *this;
+}
+
+auto RemoteProgress::operator=(string_view t_text) -> RemoteProgress& {
+  set_text(t_text);
+  return *this;
+}
+
+void RemoteProgress::set_text(string_view t_text) {
+  if (!m_finished) {
+    m_pending_text = t_text;
+    m_text_pending = true;
+    send_pending(true);
+  }
+}
+
+void RemoteProgress::set_percents(double t_percents) {
+  constexpr double MAX_PERCENTS = 100.0;
+  m_percents = clamp(t_percents, 0.0, MAX_PERCENTS);
+  if (!m_finished) {
+    m_percents_pending = true;
+    send_pending(true);
+  }
+}
+
+void RemoteProgress::set_determined(bool t_determined) {
+  if (!m_finished) {
+    send(type_t::DETERMINED, t_determined, nullptr, 0U, false);
+    send_pending(true);
+  }
+}
+
+void RemoteProgress::flush() {
+  if (!m_finished) {
+    send_pending(false);
+  }
+}
+
+auto RemoteProgress::send_pending(bool t_optional) -> bool {
+  constexpr double TENTHS = 10.0;
+
+  if (m_text_pending) {
+    if (!send(type_t::TEXT, false, m_pending_text.data(),
+        m_pending_text.size(), t_optional)) {
+      return false;
+    }
+    m_text_pending = false;
+  }
+
+  if (m_percents_pending) {
+    if (const auto tenths = lround(m_percents * TENTHS);
+        tenths != m_sent_tenths) {
+      if (!send(type_t::PERCENTS, false, &m_percents, sizeof(m_percents),
+          t_optional)) {
+        return false;
+      }
+      m_sent_tenths = tenths;
+    }
+    m_percents_pending = false;
+  }
+  return true;
+}
+
+auto RemoteProgress::send(type_t t_type, bool t_flag, const void* t_payload,
+    size_t t_payload_size, bool t_optional) -> bool {
+  using namespace remote_protocol;
+
+  t_payload_size = min(t_payload_size, MAX_PAYLOAD_SIZE);
+  const Header header{m_process_id, m_id, t_type, static_cast<uint8_t>(t_flag),
+      static_cast<uint16_t>(t_payload_size)};
+
+  // Single write for pipes, so the message is never interleaved with others.
+  array<iovec, 2U> parts{{
+    {const_cast<Header*>(&header), sizeof(header)},
+    {const_cast<void*>(t_payload), t_payload_size}
+  }};
+  auto* part = parts.data();
+  int parts_count = t_payload_size == 0U ? 1 : 2;
+  bool started = false;
+
+  while (true) {
+    const auto written = writev(m_out_file_desc, part, parts_count);
+    if (written > 0) {
+      started = true;
+      // Stream sockets can take a part of the message, the rest must follow.
+      for (auto rest = static_cast<size_t>(written); rest != 0U;) {
+        const auto taken = min(rest, part->iov_len);
+        part->iov_base = static_cast<char*>(part->iov_base) + taken;
+        part->iov_len -= taken;
+        rest -= taken;
+        if (part->iov_len == 0U) {
+          ++part;
+          --parts_count;
+        }
+      }
+      if (parts_count == 0) {
+        return true;
+      }
+      continue;
+    }
+
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      throw system_error(errno, generic_category(),
+          "couldn't send progress update");
+    }
+    if (t_optional && !started) {
+      return false;
+    }
+    pollfd poll_fd{m_out_file_desc, POLLOUT, 0};
+    poll(&poll_fd, 1U, -1);
+  }
+}
@@ -0,0 +1,330 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "fcli/internal/unicode.hpp"
+#include "fcli/screen.hpp"
+
+using namespace std;
+
+using namespace fcli;
+using namespace fcli::internal;
+
+namespace {
+  constexpr string_view
+      RESET_STYLE = "\033[0m",
+      SYNC_BEGIN = "\033[?2026h",
+      SYNC_END = "\033[?2026l";
+  // Skipped cells are rewritten instead of moving over them up to this gap.
+  constexpr int MAX_REWRITTEN_GAP = 3;
+
+  // Right half of a wide character.
+  constexpr Screen::Cell CONTINUATION{{}, 0U, 0U, 0U};
+
+  void append_number(string& t_str, int t_number) {
+    t_str += to_string(t_number);
+  }
+} // Namespace.
+
+Screen::Screen(unsigned short t_width, unsigned short t_height,
+    ostream& t_ostream): m_ostream(t_ostream), m_width(t_width),
+    m_height(t_height), m_front(size_t{t_width} * t_height),
+    m_back(m_front.size()) {}
+
+Screen::~Screen() {
+  set_alternate(false);
+}
+
+void Screen::clear() {
+  fill(m_back.begin(), m_back.end(), Cell());
+}
+
+auto Screen::draw_text(unsigned short t_x, unsigned short t_y,
+    string_view t_text, unsigned short t_max_width) -> unsigned short {
+  if (t_x >= m_width || t_y >= m_height) {
+    return 0U;
+  }
+  const auto end_x = static_cast<unsigned short>(
+      min(unsigned{m_width}, unsigned{t_x} + t_max_width));
+  auto x = t_x, y = t_y;
+  uint16_t style = 0U;
+  string style_sequence;
+  // Last written cell, combining characters are appended to it.
+  Cell* previous = nullptr;
+
+  for (size_t pos = 0U; pos != t_text.size();) {
+    const char c = t_text[pos];
+    if (c == '\033') {
+      const auto end = unicode::skip_escape(t_text, pos);
+      const auto sequence = t_text.substr(pos, end - pos);
+      if (sequence.size() >= 3U && sequence[1] == '[' &&
+          sequence.back() == 'm') {
+        const auto parameters = sequence.substr(2U, sequence.size() - 3U);
+        if (parameters.empty() || parameters == "0" ||
+            parameters.rfind("0;", 0U) == 0U) {
+          style_sequence.clear();
+        }
+        if (!parameters.empty() && parameters != "0") {
+          style_sequence += sequence;
+        }
+        style = add_style(style_sequence);
+      }
+      pos = end;
+      continue;
+    }
+    if (c == '\n') {
+      if (++y == m_height) {
+        break;
+      }
+      x = t_x;
+      previous = nullptr;
+      ++pos;
+      continue;
+    }
+
+    char32_t code_point = 0U;
+    auto length = static_cast<unsigned char>(c) < 0x80U ?
+        1U : unicode::decode(t_text, pos, code_point);
+    Cell cell;
+    cell.style = style;
+    if (length == 0U) {
+      // Invalid byte is shown as the replacement character.
+      constexpr string_view REPLACEMENT = "\xEF\xBF\xBD";
+      copy(REPLACEMENT.cbegin(), REPLACEMENT.cend(), cell.glyph.begin());
+      cell.glyph_size = REPLACEMENT.size();
+      length = 1U;
+    } else {
+      if (length == 1U) {
+        code_point = static_cast<unsigned char>(c);
+      }
+      cell.width = static_cast<uint8_t>(unicode::get_width(code_point));
+      copy_n(t_text.data() + pos, length, cell.glyph.begin());
+      cell.glyph_size = static_cast<uint8_t>(length);
+    }
+    pos += length;
+
+    if (cell.width == 0U) {
+      // Combining characters are kept if they fit, controls are skipped.
+      if (code_point >= 0x300U && previous != nullptr &&
+          previous->glyph_size + length <= previous->glyph.size()) {
+        copy_n(cell.glyph.cbegin(), length,
+            previous->glyph.begin() + previous->glyph_size);
+        previous->glyph_size = static_cast<uint8_t>(
+            previous->glyph_size + length);
+      }
+      continue;
+    }
+    if (x + cell.width > end_x) {
+      // Skip the rest of the line.
+      const auto line_end = t_text.find('\n', pos);
+      pos = line_end == string_view::npos ? t_text.size() : line_end;
+      continue;
+    }
+
+    put(x, y, cell);
+    if (cell.width == 2U) {
+      auto continuation = CONTINUATION;
+      continuation.style = style;
+      put(static_cast<unsigned short>(x + 1U), y, continuation);
+    }
+    previous = &m_back[size_t{y} * m_width + x];
+    x = static_cast<unsigned short>(x + cell.width);
+  }
+  return static_cast<unsigned short>(
+      min<unsigned>(y, m_height - 1U) - t_y + 1U);
+}
+
+auto Screen::draw_progress(unsigned short t_x, unsigned short t_y,
+    Progress& t_progress) -> unsigned short {
+  return draw_text(t_x, t_y, t_progress.render_frame(),
+      t_progress.get_width());
+}
+
+auto Screen::present() -> size_t {
+  m_output.clear();
+  m_cursor_x = m_cursor_y = -1;
+  if (m_synchronized) {
+    m_output += SYNC_BEGIN;
+  }
+  const auto header_size = m_output.size();
+
+  if (m_clear_pending) {
+    m_output += RESET_STYLE;
+    m_output += "\033[H\033[2J";
+    fill(m_front.begin(), m_front.end(), Cell());
+    m_clear_pending = false;
+  }
+
+  uint16_t style = 0U;
+  for (unsigned short y = 0U; y != m_height; ++y) {
+    const auto row = size_t{y} * m_width;
+    for (unsigned short x = 0U; x != m_width; ++x) {
+      const auto& cell = m_back[row + x];
+      // Right halves are written with their characters.
+      if (cell.width == 0U) {
+        continue;
+      }
+      if (cell == m_front[row + x] && (cell.width == 1U ||
+          m_back[row + x + 1U] == m_front[row + x + 1U])) {
+        continue;
+      }
+
+      // Rewriting of a few unchanged cells is shorter than moving over them.
+      const auto gap = x - m_cursor_x;
+      if (m_cursor_y == y && gap > 0 && gap <= MAX_REWRITTEN_GAP &&
+          all_of(m_back.cbegin() + static_cast<long>(row) + m_cursor_x,
+          m_back.cbegin() + static_cast<long>(row + x),
+          [style] (const Cell& t_cell) {
+            return t_cell.style == style && t_cell.width == 1U &&
+                t_cell.glyph_size == 1U;
+          })) {
+        for (auto i = static_cast<size_t>(m_cursor_x); i != x; ++i) {
+          m_output += m_back[row + i].glyph[0];
+        }
+      } else {
+        move_cursor(x, y);
+      }
+
+      if (cell.style != style) {
+        style = cell.style;
+        m_output += RESET_STYLE;
+        m_output += m_styles[style];
+      }
+      m_output.append(cell.glyph.data(), cell.glyph_size);
+      m_cursor_x = x + cell.width;
+      m_cursor_y = y;
+      // Cursor stays in the last column until the next character.
+      if (m_cursor_x >= m_width) {
+        m_cursor_x = m_cursor_y = -1;
+      }
+    }
+  }
+  if (style != 0U) {
+    m_output += RESET_STYLE;
+  }
+
+  if (m_output.size() == header_size) {
+    m_output.clear();
+  } else if (m_synchronized) {
+    m_output += SYNC_END;
+  }
+  if (!m_output.empty()) {
+    m_ostream.write(m_output.data(),
+        static_cast<streamsize>(m_output.size()));
+    m_ostream.flush();
+  }
+  m_front = m_back;
+  return m_output.size();
+}
+
+void Screen::invalidate() {
+  m_clear_pending = true;
+}
+
+auto Screen::get_cell(unsigned short t_x, unsigned short t_y) const ->
+    const Cell& {
+  if (t_x >= m_width || t_y >= m_height) {
+    throw out_of_range("cell is outside of the screen");
+  }
+  return m_back[size_t{t_y} * m_width + t_x];
+}
+
+void Screen::resize(unsigned short t_width, unsigned short t_height) {
+  m_width = t_width;
+  m_height = t_height;
+  m_front.assign(size_t{t_width} * t_height, Cell());
+  m_back.assign(m_front.size(), Cell());
+  m_clear_pending = true;
+}
+
+void Screen::set_alternate(bool t_enable) {
+  if (m_alternate == t_enable) {
+    return;
+  }
+  m_alternate = t_enable;
+  // Cursor is hidden on the alternate screen.
+  m_ostream << (t_enable ? "\033[?1049h\033[?25l" : "\033[?25h\033[?1049l")
+      << flush;
+  m_clear_pending = true;
+}
+
+void Screen::put(unsigned short t_x, unsigned short t_y, const Cell& t_cell) {
+  const auto row = size_t{t_y} * m_width;
+  auto& target = m_back[row + t_x];
+  // Halves of an overwritten wide character become spaces.
+  if (target.width == 0U && t_cell.width != 0U && t_x != 0U) {
+    m_back[row + t_x - 1U] = Cell();
+  }
+  if (target.width == 2U && t_cell.width != 2U && t_x + 1U < m_width) {
+    m_back[row + t_x + 1U] = Cell();
+  }
+  target = t_cell;
+}
+
+auto Screen::add_style(string_view t_sequence) -> uint16_t {
+  if (t_sequence.empty()) {
+    return 0U;
+  }
+  const string sequence(t_sequence);
+  if (const auto it = m_style_ids.find(sequence); it != m_style_ids.cend()) {
+    return it->second;
+  }
+  // Identifiers are exhausted, new styles are shown as plain.
+  if (m_styles.size() > numeric_limits<uint16_t>::max()) {
+    return 0U;
+  }
+  const auto id = static_cast<uint16_t>(m_styles.size());
+  m_styles.push_back(sequence);
+  m_style_ids.emplace(sequence, id);
+  return id;
+}
+
+void Screen::move_cursor(unsigned short t_x, unsigned short t_y) {
+  if (m_cursor_x == t_x && m_cursor_y == t_y) {
+    return;
+  }
+
+  string absolute = "\033[";
+  append_number(absolute, t_y + 1);
+  absolute += ';';
+  append_number(absolute, t_x + 1);
+  absolute += 'H';
+
+  string relative;
+  if (m_cursor_y == t_y) {
+    if (t_x == 0U) {
+      relative = "\r";
+    } else {
+      const auto distance = t_x - m_cursor_x;
+      relative = "\033[";
+      if (abs(distance) != 1) {
+        append_number(relative, abs(distance));
+      }
+      relative += distance > 0 ? 'C' : 'D';
+    }
+  } else if (m_cursor_y >= 0 && t_y == m_cursor_y + 1 && t_x == 0U) {
+    relative = "\r\n";
+  }
+
+  m_output += !relative.empty() && relative.size() < absolute.size() ?
+      relative : absolute;
+  m_cursor_x = t_x;
+  m_cursor_y = t_y;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "fcli/stage.hpp"
+
+using namespace fcli;
+using namespace std;
+
+Stage::Stage(): m_node(make_shared<Node>()) {
+  m_node->root = m_node.get();
+  m_node->weight = MAX_PERCENTS;
+  m_node->span = ROOT_SPAN;
+}
+
+Stage::Node::~Node() {
+  if (root != nullptr && root != this) {
+    lock_guard lock(root->active_mut);
+    Node* expected = this;
+    root->active.compare_exchange_strong(expected, nullptr);
+  }
+}
+
+auto Stage::add_stage(double t_weight, string_view t_text) const -> Stage {
+  auto node = make_shared<Node>();
+  node->parent = m_node;
+  node->root = m_node->root;
+  node->weight = clamp(t_weight, 0.0, MAX_PERCENTS);
+  node->span = llround(static_cast<double>(m_node->span) *
+      (node->weight / MAX_PERCENTS));
+  node->text = t_text;
+  return Stage(move(node));
+}
+
+void Stage::set_percents(double t_percents) const {
+  const auto units = llround(static_cast<double>(m_node->span) *
+      (clamp(t_percents, 0.0, MAX_PERCENTS) / MAX_PERCENTS));
+  const auto delta = units - m_node->own.exchange(units);
+
+  // Ancestors are kept alive by the parent pointers.
+  for (auto* n = m_node.get(); n != nullptr; n = n->parent.get()) {
+    n->done.fetch_add(delta, memory_order_relaxed);
+  }
+  m_node->root->active.store(m_node.get(), memory_order_release);
+}
+
+auto Stage::get_percents() const -> double {
+  if (m_node->span == 0) {
+    return 0.0;
+  }
+  const auto done = m_node->done.load(memory_order_relaxed);
+  return clamp(static_cast<double>(done) /
+      static_cast<double>(m_node->span) * MAX_PERCENTS, 0.0, MAX_PERCENTS);
+}
+
+void Stage::set_text(string_view t_text) const {
+  m_node->text_mut.lock();
+  m_node->text = t_text;
+  m_node->text_mut.unlock();
+  m_node->root->active.store(m_node.get(), memory_order_release);
+}
+
+auto Stage::get_text() const -> string {
+  lock_guard lock(m_node->text_mut);
+  return m_node->text;
+}
+
+auto Stage::get_active_text() const -> string {
+  lock_guard active_lock(m_node->root->active_mut);
+  const auto* active = m_node->root->active.load(memory_order_acquire);
+  if (active == nullptr) {
+    return {};
+  }
+  lock_guard text_lock(active->text_mut);
+  return active->text;
+}
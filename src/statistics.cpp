@@ -0,0 +1,167 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "fcli/internal/statistics.hpp"
+#include "fcli/statistics.hpp"
+
+using namespace std;
+using namespace chrono;
+
+using namespace fcli;
+using namespace fcli::internal;
+
+TextStatistics internal::text_statistics;
+
+namespace {
+  struct Registry {
+    mutex mut;
+    vector<shared_ptr<ProgressStatistics>> progresses;
+    // Counters of destroyed progresses.
+    Statistics::ProgressCounters retired{};
+
+    // Attention: it doesn't lock mutex automatically.
+    void retire_destroyed() {
+      const auto destroyed = [this] (const auto& t_statistics) {
+        // The registry holds the last reference.
+        if (t_statistics.use_count() != 1L) {
+          return false;
+        }
+        retired += t_statistics->load();
+        return true;
+      };
+      progresses.erase(remove_if(progresses.begin(), progresses.end(),
+          destroyed), progresses.end());
+    }
+  };
+
+  // Leaked, so progresses can be created by destructors of static objects.
+  auto get_registry() -> Registry& {
+    static auto& registry = *new Registry();
+    return registry;
+  }
+
+  class Dumper {
+  public:
+    Dumper() = default;
+    ~Dumper() { stop(); }
+
+    Dumper(const Dumper&) = delete;
+    auto operator=(const Dumper&) -> Dumper& = delete;
+    Dumper(Dumper&&) = delete;
+    auto operator=(Dumper&&) -> Dumper& = delete;
+
+    void start(function<void(const Statistics::Snapshot&)> t_handler,
+        milliseconds t_interval) {
+      stop();
+      if (!t_handler) {
+        return;
+      }
+      m_stop = false;
+      m_thread = thread([this, handler = move(t_handler), t_interval] {
+        unique_lock lock(m_mut);
+        while (!m_cv.wait_for(lock, t_interval, [this] { return m_stop; })) {
+          lock.unlock();
+          handler(Statistics::get_snapshot());
+          lock.lock();
+        }
+      });
+    }
+
+    void stop() {
+      if (!m_thread.joinable()) {
+        return;
+      }
+      m_mut.lock();
+      m_stop = true;
+      m_mut.unlock();
+      m_cv.notify_one();
+      m_thread.join();
+    }
+
+  private:
+    thread m_thread;
+    mutex m_mut;
+    condition_variable m_cv;
+    bool m_stop{};
+  };
+} // Namespace.
+
+auto Statistics::ProgressCounters::operator+=(const ProgressCounters& t_other)
+    -> ProgressCounters& {
+  notifications += t_other.notifications;
+  frames_rendered += t_other.frames_rendered;
+  frames_skipped += t_other.frames_skipped;
+  bytes_written += t_other.bytes_written;
+  updater_wakeups += t_other.updater_wakeups;
+  lock_time += t_other.lock_time;
+  return *this;
+}
+
+auto ProgressStatistics::load() const -> Statistics::ProgressCounters {
+  return {notifications.load(), frames_rendered.load(),
+      frames_skipped.load(), bytes_written.load(), updater_wakeups.load(),
+      nanoseconds(lock_nanoseconds.load())};
+}
+
+auto Statistics::is_enabled() -> bool {
+  return STATISTICS_ENABLED;
+}
+
+auto Statistics::get_snapshot() -> Snapshot {
+  Snapshot snapshot{steady_clock::now(), {}, {text_statistics.calls.load(),
+      text_statistics.bytes_in.load(), text_statistics.bytes_out.load(),
+      nanoseconds(text_statistics.nanoseconds.load())}};
+
+  auto& registry = get_registry();
+  lock_guard lock(registry.mut);
+  registry.retire_destroyed();
+  snapshot.progresses = registry.retired;
+  for (const auto& statistics : registry.progresses) {
+    snapshot.progresses += statistics->load();
+  }
+  return snapshot;
+}
+
+void Statistics::set_dump_handler(function<void(const Snapshot&)> t_handler,
+    milliseconds t_interval) {
+  static Dumper dumper;
+  static mutex dumper_mut;
+  lock_guard lock(dumper_mut);
+  dumper.start(move(t_handler), t_interval);
+}
+
+auto Statistics::register_progress() -> shared_ptr<ProgressStatistics> {
+  if constexpr (!STATISTICS_ENABLED) {
+    return nullptr;
+  }
+
+  auto statistics = make_shared<ProgressStatistics>();
+  auto& registry = get_registry();
+  lock_guard lock(registry.mut);
+  // Amortize removing of destroyed progresses.
+  if (registry.progresses.size() == registry.progresses.capacity()) {
+    registry.retire_destroyed();
+  }
+  registry.progresses.push_back(statistics);
+  return statistics;
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "fcli/table.hpp"
+#include "fcli/text.hpp"
+
+using namespace fcli;
+using namespace std;
+
+Table::Table(vector<Column> t_columns, ostream& t_ostream,
+    const optional<Terminal::ColorsSupport>& t_colors_support,
+    const Palette& t_palette):
+    m_columns(move(t_columns)), m_ostream(t_ostream),
+    m_colors_support(t_colors_support), m_palette(t_palette),
+    m_reset(Text::format_copy("<r>", t_colors_support, t_palette)) {
+  m_styles.reserve(m_columns.size());
+  m_widths.reserve(m_columns.size());
+
+  for (const auto& column : m_columns) {
+    m_styles.push_back(
+        Text::format_copy(column.style, m_colors_support, m_palette));
+
+    auto width = Text::visible_width(
+        Text::format_copy(column.header, m_colors_support, m_palette));
+    if (column.max_width != 0U) {
+      width = min(width, column.max_width);
+    }
+    m_widths.push_back(max(width, column.min_width));
+  }
+}
+
+Table::~Table() {
+  flush();
+}
+
+void Table::add_row(initializer_list<string_view> t_cells) {
+  if (t_cells.size() > m_columns.size()) {
+    throw out_of_range("Row has more cells than the table has columns");
+  }
+
+  size_t column = 0U;
+  for (const auto cell : t_cells) {
+    append_cell(column++, cell);
+  }
+  end_row();
+}
+
+void Table::add_row(const vector<string>& t_cells) {
+  if (t_cells.size() > m_columns.size()) {
+    throw out_of_range("Row has more cells than the table has columns");
+  }
+
+  for (size_t column = 0U; column != t_cells.size(); ++column) {
+    append_cell(column, t_cells[column]);
+  }
+  end_row();
+}
+
+void Table::flush() {
+  if (m_held_rows != 0U || !m_header_printed) {
+    print_held();
+  }
+  if (!m_buffer.empty()) {
+    m_ostream.write(m_buffer.data(), static_cast<streamsize>(m_buffer.size()));
+    m_buffer.clear();
+  }
+  m_ostream.flush();
+}
+
+void Table::set_separator(string_view t_separator) {
+  m_separator = Text::format_copy(string(t_separator),
+      m_colors_support, m_palette);
+}
+
+void Table::append_cell(size_t t_column, string_view t_cell) {
+  // Text::format changes nothing if there are no specifiers.
+  const bool specified = t_cell.find_first_of("<~") != string_view::npos;
+  if (specified) {
+    m_cell.assign(t_cell);
+    Text::format(m_cell, m_colors_support, m_palette);
+    t_cell = m_cell;
+  }
+
+  auto width = Text::visible_width(t_cell);
+  const auto max_width = m_columns[t_column].max_width;
+  if (max_width != 0U && width > max_width) {
+    t_cell = Text::truncate_to_width(t_cell, max_width);
+    width = Text::visible_width(t_cell);
+  }
+
+  const auto& style = m_styles[t_column];
+  m_held += style;
+  m_held += t_cell;
+  if (specified || !style.empty()) {
+    m_held += m_reset;
+  }
+  m_held_cells.push_back({m_held.size(), width});
+}
+
+void Table::end_row() {
+  // Missing cells are empty.
+  while (m_held_cells.size() != (m_held_rows + 1U) * m_columns.size()) {
+    m_held_cells.push_back({m_held.size(), 0U});
+  }
+  ++m_held_rows;
+  ++m_rows_count;
+
+  if (m_held_rows >= m_look_ahead) {
+    print_held();
+  }
+}
+
+void Table::print_held() {
+  const auto columns_count = m_columns.size();
+  for (size_t i = 0U; i != m_held_cells.size(); ++i) {
+    auto& width = m_widths[i % columns_count];
+    width = max(width, m_held_cells[i].width);
+  }
+
+  if (!m_header_printed) {
+    m_header_printed = true;
+    const bool has_header = any_of(m_columns.cbegin(), m_columns.cend(),
+        [](const auto& column) { return !column.header.empty(); });
+
+    if (has_header) {
+      const auto style = Text::format_copy(m_header_style,
+          m_colors_support, m_palette);
+      string header;
+      for (size_t column = 0U; column != columns_count; ++column) {
+        header = Text::format_copy(m_columns[column].header,
+            m_colors_support, m_palette);
+        const auto max_width = m_columns[column].max_width;
+        string_view cell = header;
+        if (max_width != 0U) {
+          cell = Text::truncate_to_width(cell, max_width);
+        }
+        const auto width = Text::visible_width(cell);
+        header = style + string(cell) + (style.empty() ? "" : m_reset);
+        print_cell(column, header, width);
+      }
+      m_buffer += '\n';
+    }
+  }
+
+  size_t start = 0U;
+  for (size_t i = 0U; i != m_held_cells.size(); ++i) {
+    const auto& cell = m_held_cells[i];
+    print_cell(i % columns_count,
+        string_view(m_held).substr(start, cell.end - start), cell.width);
+    start = cell.end;
+
+    if ((i + 1U) % columns_count == 0U) {
+      m_buffer += '\n';
+    }
+  }
+  if (columns_count == 0U) {
+    m_buffer.append(m_held_rows, '\n');
+  }
+
+  m_held.clear();
+  m_held_cells.clear();
+  m_held_rows = 0U;
+
+  if (m_buffer.size() >= BUFFER_SIZE) {
+    m_ostream.write(m_buffer.data(), static_cast<streamsize>(m_buffer.size()));
+    m_buffer.clear();
+  }
+}
+
+void Table::print_cell(size_t t_column, string_view t_cell, size_t t_width) {
+  if (t_column != 0U) {
+    m_buffer += m_separator;
+  }
+
+  const auto padding = m_widths[t_column] - t_width;
+  const bool last = t_column + 1U == m_columns.size();
+  size_t left_padding = 0U;
+  switch (m_columns[t_column].alignment) {
+    case Alignment::LEFT:
+      break;
+    case Alignment::RIGHT:
+      left_padding = padding;
+      break;
+    case Alignment::CENTER:
+      left_padding = padding / 2U;
+      break;
+  }
+
+  // Trailing spaces of the last column are useless.
+  if (last && t_width == 0U) {
+    left_padding = 0U;
+  }
+  m_buffer.append(left_padding, ' ');
+  m_buffer += t_cell;
+  if (!last) {
+    m_buffer.append(padding - left_padding, ' ');
+  }
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include "fcli/task_pool.hpp"
+
+using namespace fcli;
+using namespace std;
+using namespace string_literals;
+
+void TaskPool::Handle::set_percents(double t_percents) {
+  constexpr double MAX_PERCENTS = 100.0;
+  m_status.percents = clamp(t_percents, 0.0, MAX_PERCENTS);
+}
+
+TaskPool::TaskPool(unsigned short t_width, ostream& t_ostream,
+    unsigned t_workers): m_ostream(t_ostream), m_overall({}, true, t_ostream) {
+
+  m_overall.set_width(t_width);
+  m_overall.set_percents_source([this] {
+    constexpr double MAX_PERCENTS = 100.0;
+    const auto submitted = m_submitted.load();
+    if (submitted == 0U) {
+      return 0.0;
+    }
+    return static_cast<double>(m_finished) /
+        static_cast<double>(submitted) * MAX_PERCENTS;
+  });
+
+  if (t_workers == 0U) {
+    t_workers = max(thread::hardware_concurrency(), 1U);
+  }
+  m_workers.reserve(t_workers);
+  for (unsigned i = 0U; i != t_workers; ++i) {
+    auto worker = make_unique<Worker>();
+    worker->progress = make_unique<Progress>("", false, t_ostream);
+    worker->progress->set_width(t_width);
+    m_workers.push_back(move(worker));
+  }
+  // Start threads only when all workers are constructed.
+  for (auto& w : m_workers) {
+    w->thread = thread(&TaskPool::work, this, ref(*w));
+  }
+  m_renderer = thread(&TaskPool::render, this);
+}
+
+TaskPool::~TaskPool() {
+  wait();
+  m_mut.lock();
+  m_shutdown = true;
+  m_mut.unlock();
+  m_tasks_cv.notify_all();
+  m_render_cv.notify_one();
+
+  for (auto& w : m_workers) {
+    w->thread.join();
+  }
+  m_renderer.join();
+}
+
+void TaskPool::submit(string_view t_name, task_t t_task) {
+  m_mut.lock();
+  m_tasks.emplace_back(t_name, move(t_task));
+  ++m_submitted;
+  m_rendering = true;
+  m_mut.unlock();
+  m_tasks_cv.notify_one();
+  m_render_cv.notify_one();
+}
+
+auto TaskPool::wait() -> size_t {
+  unique_lock lock(m_mut);
+  m_finished_cv.wait(lock, [this] { return m_finished == m_submitted; });
+  // Next tasks will be counted from scratch.
+  m_submitted = m_finished = 0U;
+  const auto failed = exchange(m_failed, 0U);
+  if (m_rendering) {
+    m_rendering = false;
+    ++m_stop_requests;
+    m_render_cv.notify_one();
+  }
+  // Status lines are erased by the last frame.
+  const auto request = m_stop_requests;
+  m_finished_cv.wait(lock, [this, request] { return m_stops_done >= request; });
+  return failed;
+}
+
+void TaskPool::for_each_worker(const function<void(Progress&)>& t_function) {
+  for (auto& w : m_workers) {
+    t_function(*w->progress);
+  }
+}
+
+void TaskPool::work(Worker& t_worker) {
+  while (true) {
+    unique_lock lock(m_mut);
+    m_tasks_cv.wait(lock, [this] { return m_shutdown || !m_tasks.empty(); });
+    if (m_tasks.empty()) {
+      // Shutdown is requested.
+      return;
+    }
+    auto [name, task] = move(m_tasks.front());
+    m_tasks.pop_front();
+    lock.unlock();
+
+    Handle handle(t_worker.status);
+    handle.set_text(name);
+    t_worker.status.percents = -1.0;
+    t_worker.busy = true;
+
+    Result result{true, {}};
+    try {
+      task(handle);
+    } catch (const exception& e) {
+      result = {false, ": "s + e.what()};
+    } catch (...) {
+      result.success = false;
+    }
+    result.message.insert(0U, handle.get_result_message().value_or(name));
+    t_worker.busy = false;
+
+    lock.lock();
+    if (!result.success) {
+      ++m_failed;
+    }
+    m_results.push_back(move(result));
+    ++m_finished;
+    lock.unlock();
+
+    m_render_cv.notify_one();
+    m_finished_cv.notify_all();
+  }
+}
+
+void TaskPool::render() {
+  unique_lock lock(m_mut);
+  while (true) {
+    // Rendering can be stopped before the renderer wakes up.
+    const auto stops = m_stops_done;
+    m_render_cv.wait(lock, [this, stops]
+        { return m_shutdown || m_rendering || m_stop_requests != stops; });
+    if (!m_rendering && m_stop_requests == stops) {
+      // Shutdown is requested.
+      return;
+    }
+    // Tasks can be submitted again before the stop is noticed.
+    while (m_stop_requests == stops) {
+      lock.unlock();
+      draw(false);
+      lock.lock();
+      m_render_cv.wait_for(lock, RENDER_INTERVAL, [this, stops]
+          { return m_stop_requests != stops || !m_results.empty(); });
+    }
+    lock.unlock();
+    draw(true);
+    lock.lock();
+    m_stops_done = m_stop_requests;
+    m_finished_cv.notify_all();
+  }
+}
+
+void TaskPool::draw(bool t_last) {
+  vector<Result> results;
+  m_mut.lock();
+  results.swap(m_results);
+  m_mut.unlock();
+
+  auto output = m_live_area.erase();
+  for (const auto& r : results) {
+    output += m_overall.format_result(r.success, r.message) + '\n';
+  }
+
+  string frames;
+  if (!t_last) {
+    for (auto& w : m_workers) {
+      if (w->busy) {
+        apply_status(*w);
+        frames += w->progress->render_frame() + '\n';
+      }
+    }
+    frames += m_overall.render_frame();
+  }
+  m_live_area.set_drawn(frames);
+  output += frames;
+  m_ostream << output << flush;
+}
+
+void TaskPool::apply_status(Worker& t_worker) {
+  auto& progress = *t_worker.progress;
+  if (t_worker.status.text.update()) {
+    progress.set_text(t_worker.status.text.get_front());
+  }
+
+  const auto percents = t_worker.status.percents.load();
+  const bool determined = percents >= 0.0;
+  if (progress.is_determined() != determined) {
+    progress.set_determined(determined);
+  }
+  if (determined) {
+    progress.set_percents(percents);
+  }
+}
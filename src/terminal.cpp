@@ -15,15 +15,275 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <filesystem>
+#include <map>
+#include <mutex>
 #include <stdexcept>
 #include <sys/ioctl.h>
+#include <system_error>
+#include <termios.h>
+#include <thread>
 
 #include "fcli/terminal.hpp"
 
 using namespace fcli;
 using namespace std;
+using namespace chrono;
+
+namespace {
+  /*
+   * State of the width watcher. Members that are used by the signal handler
+   * are lock-free atomics or are written only before installation.
+   */
+
+  atomic<int> s_watched_fd{STDOUT_FILENO};
+  atomic<unsigned short> s_cached_width{};
+  static_assert(decltype(s_cached_width)::is_always_lock_free);
+  // Self-pipe that wakes up the dispatcher from the signal handler.
+  array<int, 2> s_wakeup_pipe{-1, -1};
+  struct sigaction s_prev_action{};
+  once_flag s_install_flag;
+
+  struct Listeners {
+    // Held while listeners are called.
+    mutex mut;
+    map<size_t, function<void(unsigned short)>> functions;
+    size_t next_id{};
+  };
+
+  // Never destroyed as the dispatcher thread can outlive static objects.
+  auto get_listeners() -> Listeners& {
+    static auto* listeners = new Listeners;
+    return *listeners;
+  }
+
+  auto query_width(int t_file_desc) noexcept -> unsigned short {
+    struct winsize size{};
+    if (ioctl(t_file_desc, TIOCGWINSZ, &size) != 0) {
+      return 0U;
+    }
+    return size.ws_col;
+  }
+
+  void wake_up_dispatcher() noexcept {
+    const char byte = 0;
+    // Pipe is non-blocking, so write never blocks. If the pipe is full, the
+    // dispatcher is going to wake up anyway, so result can be ignored.
+    [[maybe_unused]] const auto written = write(s_wakeup_pipe[1], &byte, 1U);
+  }
+
+  void handle_sigwinch(int t_signal, siginfo_t* t_info, void* t_context) {
+    // Only async-signal-safe functions are called here.
+    const int saved_errno = errno;
+    s_cached_width = query_width(s_watched_fd);
+    wake_up_dispatcher();
+
+    if ((s_prev_action.sa_flags & SA_SIGINFO) != 0) {
+      if (s_prev_action.sa_sigaction != nullptr) {
+        s_prev_action.sa_sigaction(t_signal, t_info, t_context);
+      }
+    } else if (s_prev_action.sa_handler != SIG_DFL &&
+        s_prev_action.sa_handler != SIG_IGN) {
+      s_prev_action.sa_handler(t_signal);
+    }
+    errno = saved_errno;
+  }
+
+  // Initial width is passed as the thread can start after it is changed.
+  void dispatch_width(unsigned short t_initial_width) {
+    unsigned short dispatched_width = t_initial_width;
+    array<char, 64U> buffer{};
+
+    while (true) {
+      if (read(s_wakeup_pipe[0], buffer.data(), buffer.size()) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
+      }
+
+      const unsigned short width = s_cached_width;
+      if (width == dispatched_width) {
+        continue;
+      }
+      dispatched_width = width;
+
+      auto& listeners = get_listeners();
+      lock_guard lock(listeners.mut);
+      for (auto& [id, function] : listeners.functions) {
+        function(width);
+      }
+    }
+  }
+
+  void install_watcher() {
+    call_once(s_install_flag, [] {
+      if (pipe2(s_wakeup_pipe.data(), O_CLOEXEC) != 0 ||
+          fcntl(s_wakeup_pipe[1], F_SETFL, O_NONBLOCK) != 0) {
+        throw system_error(errno, generic_category(),
+            "couldn't create pipe for the width watcher");
+      }
+      s_cached_width = query_width(s_watched_fd);
+      thread(dispatch_width, s_cached_width.load()).detach();
+
+      struct sigaction action{};
+      action.sa_sigaction = handle_sigwinch;
+      action.sa_flags = SA_RESTART | SA_SIGINFO;
+      sigemptyset(&action.sa_mask);
+      sigaction(SIGWINCH, &action, &s_prev_action);
+    });
+  }
+
+  /*
+   * Persistent profiles.
+   */
+
+  // Increment when the layout or the detection is changed.
+  constexpr uint32_t PROFILE_VERSION = 2U;
+  constexpr array<char, 4U> PROFILE_MAGIC{'F', 'C', 'L', 'P'};
+  // Read at once, longer keys aren't loaded.
+  constexpr size_t MAX_PROFILE_SIZE = 4096U;
+
+  // Followed by the key. Native byte order is used.
+  struct ProfileHeader {
+    array<char, 4U> magic;
+    uint32_t version;
+    uint32_t key_size;
+    uint32_t quirks;
+    // Zero if unknown, otherwise ColorsSupport plus one.
+    uint8_t colors_support;
+    uint8_t direct_color;
+    // Theme::Name or NO_THEME.
+    uint8_t theme;
+    uint8_t reserved;
+  };
+  // The user palette can't be restored, so the theme isn't applied.
+  constexpr uint8_t NO_THEME = 0xFFU;
+  static_assert(sizeof(ProfileHeader) == 20U);
+
+  // Returns nothing if neither XDG_CACHE_HOME nor HOME is set.
+  auto get_profile_path(string_view t_key) -> optional<filesystem::path> {
+    filesystem::path directory;
+    if (const char* cache = getenv("XDG_CACHE_HOME");
+        cache != nullptr && *cache == '/') {
+      directory = cache;
+    } else if (const char* home = getenv("HOME");
+        home != nullptr && *home != '\0') {
+      directory = filesystem::path(home) / ".cache";
+    } else {
+      return {};
+    }
+
+    // FNV-1a, the key is compared after reading.
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char c : t_key) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    array<char, 17U> hash_hex{};
+    snprintf(hash_hex.data(), hash_hex.size(), "%016llx",
+        static_cast<unsigned long long>(hash));
+    return directory / "fcli" / ("terminal-" + string(hash_hex.data()));
+  }
+
+  /*
+   * Terminal query.
+   */
+
+  // DA1 is the last one as all terminals answer it.
+  constexpr string_view QUERY_REQUESTS =
+      "\033]11;?\033\\" "\033[>0q" "\033[c";
+  constexpr string_view DA1_REPLY_START = "\033[?";
+  // Prefixes of XTVERSION replies of terminals that support 24-bit colors.
+  constexpr array<string_view, 7U> DIRECT_COLOR_TERMINALS{
+    "WezTerm", "contour", "foot", "ghostty", "iTerm2", "kitty", "tmux"
+  };
+
+  /*
+   * Returns the body of an OSC or DCS reply that begins with the start. It's
+   * terminated by ST or, for OSC, by BEL.
+   */
+  auto find_reply(string_view t_input, string_view t_start) ->
+      optional<string_view> {
+    const auto start = t_input.find(t_start);
+    if (start == string_view::npos) {
+      return {};
+    }
+    const auto body = t_input.substr(start + t_start.size());
+    const auto end = min(body.find("\033\\"), body.find('\a'));
+    if (end == string_view::npos) {
+      return {};
+    }
+    return body.substr(0U, end);
+  }
+
+  // Returns parameters of the DA1 reply.
+  auto find_device_attributes(string_view t_input) -> optional<vector<int>> {
+    for (auto start = t_input.find(DA1_REPLY_START);
+        start != string_view::npos;
+        start = t_input.find(DA1_REPLY_START, start + 1U)) {
+      vector<int> attributes{0};
+      auto i = start + DA1_REPLY_START.size();
+      for (; i != t_input.size() && (isdigit(
+          static_cast<unsigned char>(t_input[i])) || t_input[i] == ';'); ++i) {
+        if (t_input[i] == ';') {
+          attributes.push_back(0);
+        } else {
+          attributes.back() = attributes.back() * 10 + (t_input[i] - '0');
+        }
+      }
+      // Other CSI replies have the same start.
+      if (i != t_input.size() && t_input[i] == 'c') {
+        return attributes;
+      }
+    }
+    return {};
+  }
+
+  // Parses "rgb:RRRR/GGGG/BBBB", components have 1-4 hex digits.
+  auto parse_luma(string_view t_color) -> optional<double> {
+    if (t_color.rfind("rgba:", 0U) == 0U) {
+      t_color.remove_prefix(5U);
+    } else if (t_color.rfind("rgb:", 0U) == 0U) {
+      t_color.remove_prefix(4U);
+    } else {
+      return {};
+    }
+
+    array<double, 3U> components{};
+    for (auto& component : components) {
+      const auto end = min(t_color.find('/'), t_color.size());
+      if (end == 0U || end > 4U) {
+        return {};
+      }
+      unsigned value = 0U;
+      for (const char digit : t_color.substr(0U, end)) {
+        if (!isxdigit(static_cast<unsigned char>(digit))) {
+          return {};
+        }
+        value = value * 16U + static_cast<unsigned>(isdigit(
+            static_cast<unsigned char>(digit)) ? digit - '0' :
+            tolower(static_cast<unsigned char>(digit)) - 'a' + 10);
+      }
+      component = value / static_cast<double>((1U << end * 4U) - 1U);
+      t_color.remove_prefix(min(end + 1U, t_color.size()));
+    }
+    // Rec. 709 weights.
+    return 0.2126 * components[0] + 0.7152 * components[1] +
+        0.0722 * components[2];
+  }
+} // Namespace.
 
 auto Terminal::get_width() const -> unsigned short {
   struct winsize size{};
@@ -35,6 +295,44 @@ auto Terminal::get_width() const -> unsigned short {
   return size.ws_col;
 }
 
+auto Terminal::get_height() const -> unsigned short {
+  struct winsize size{};
+  const int err = ioctl(m_out_file_desc, TIOCGWINSZ, &size);
+
+  if (err != 0) {
+    throw runtime_error("couldn't get terminal height");
+  }
+  return size.ws_row;
+}
+
+auto Terminal::get_cached_width() -> unsigned short {
+  install_watcher();
+  return s_cached_width;
+}
+
+void Terminal::watch_width(int t_out_file_desc) {
+  install_watcher();
+  s_watched_fd = t_out_file_desc;
+  s_cached_width = query_width(t_out_file_desc);
+  wake_up_dispatcher();
+}
+
+auto Terminal::subscribe_width(function<void(unsigned short)> t_listener) ->
+    size_t {
+  install_watcher();
+  auto& listeners = get_listeners();
+  lock_guard lock(listeners.mut);
+  const auto id = listeners.next_id++;
+  listeners.functions.emplace(id, move(t_listener));
+  return id;
+}
+
+void Terminal::unsubscribe_width(size_t t_id) {
+  auto& listeners = get_listeners();
+  lock_guard lock(listeners.mut);
+  listeners.functions.erase(t_id);
+}
+
 auto Terminal::find_out_supported_colors() const -> optional<ColorsSupport> {
   optional<ColorsSupport> colors_support;
 
@@ -42,6 +340,15 @@ auto Terminal::find_out_supported_colors() const -> optional<ColorsSupport> {
     return colors_support;
   }
 
+  if (const auto capabilities = get_capabilities()) {
+    if (capabilities->direct_color || capabilities->colors >= 256) {
+      colors_support = ColorsSupport::HAS_256_COLORS;
+    } else if (capabilities->colors >= 8) {
+      colors_support = ColorsSupport::HAS_8_COLORS;
+    }
+    return colors_support;
+  }
+
   constexpr size_t COLORED_TERMS_COUNT = 14U;
   constexpr array<string_view, COLORED_TERMS_COUNT> colored_terms{
     "ansi", "color", "console", "cygwin", "gnome", "konsole", "kterm",
@@ -62,6 +369,255 @@ auto Terminal::find_out_supported_colors() const -> optional<ColorsSupport> {
   return colors_support;
 }
 
+auto Terminal::get_capabilities() const -> optional<Capabilities> {
+  return internal::terminfo::get_cached(m_name);
+}
+
+auto Terminal::load_profile() const -> optional<Profile> {
+  const auto key = get_profile_key();
+  const auto path = get_profile_path(key);
+  if (!path) {
+    return {};
+  }
+  const int file_desc = open(path->c_str(), O_RDONLY | O_CLOEXEC);
+  if (file_desc < 0) {
+    return {};
+  }
+  array<char, MAX_PROFILE_SIZE> buffer{};
+  const auto size = pread(file_desc, buffer.data(), buffer.size(), 0);
+  close(file_desc);
+
+  ProfileHeader header{};
+  if (size < static_cast<ssize_t>(sizeof(header))) {
+    return {};
+  }
+  memcpy(&header, buffer.data(), sizeof(header));
+  const string_view stored_key(buffer.data() + sizeof(header),
+      static_cast<size_t>(size) - sizeof(header));
+  if (header.magic != PROFILE_MAGIC || header.version != PROFILE_VERSION ||
+      stored_key != key || header.colors_support > 2U ||
+      (header.theme >= static_cast<uint8_t>(Theme::Name::_COUNT) &&
+      header.theme != NO_THEME)) {
+    return {};
+  }
+
+  Profile profile;
+  if (header.colors_support != 0U) {
+    profile.colors_support =
+        static_cast<ColorsSupport>(header.colors_support - 1U);
+  }
+  profile.direct_color = header.direct_color != 0U;
+  profile.theme = header.theme == NO_THEME ?
+      Theme::Name::_USER : static_cast<Theme::Name>(header.theme);
+  profile.quirks = header.quirks;
+  return profile;
+}
+
+void Terminal::store_profile(const Profile& t_profile) const {
+  const auto key = get_profile_key();
+  const auto path = get_profile_path(key);
+  if (!path) {
+    throw filesystem::filesystem_error("cache directory is unknown",
+        make_error_code(errc::no_such_file_or_directory));
+  }
+  filesystem::create_directories(path->parent_path());
+
+  ProfileHeader header{PROFILE_MAGIC, PROFILE_VERSION,
+      static_cast<uint32_t>(key.size()), t_profile.quirks, 0U,
+      t_profile.direct_color, NO_THEME, 0U};
+  if (t_profile.colors_support) {
+    header.colors_support =
+        static_cast<uint8_t>(static_cast<int>(*t_profile.colors_support) + 1);
+  }
+  if (t_profile.theme < Theme::Name::_COUNT) {
+    header.theme = static_cast<uint8_t>(t_profile.theme);
+  }
+
+  // Renaming makes concurrent readers see a complete file.
+  auto temp_path = *path;
+  temp_path += ".tmp" + to_string(getpid());
+  string content(sizeof(header), '\0');
+  memcpy(content.data(), &header, sizeof(header));
+  content += key;
+  const int file_desc = open(temp_path.c_str(),
+      O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (file_desc < 0) {
+    throw filesystem::filesystem_error("couldn't write profile", temp_path,
+        error_code(errno, generic_category()));
+  }
+  // Error number is taken at the failed call.
+  int error = 0;
+  for (size_t written = 0U; written != content.size();) {
+    const auto size = write(file_desc, content.data() + written,
+        content.size() - written);
+    if (size < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      error = errno;
+      break;
+    }
+    written += static_cast<size_t>(size);
+  }
+  if (close(file_desc) != 0 && error == 0) {
+    error = errno;
+  }
+  if (error != 0) {
+    error_code ignored;
+    filesystem::remove(temp_path, ignored);
+    throw filesystem::filesystem_error("couldn't write profile", temp_path,
+        error_code(error, generic_category()));
+  }
+  filesystem::rename(temp_path, *path);
+}
+
+auto Terminal::get_profile() const -> Profile {
+  if (auto profile = load_profile()) {
+    return *profile;
+  }
+
+  Profile profile;
+  profile.colors_support = find_out_supported_colors();
+  const auto colorterm = getenv("COLORTERM");
+  const auto capabilities = get_capabilities();
+  profile.direct_color = colorterm == "truecolor" || colorterm == "24bit" ||
+      (capabilities && capabilities->direct_color);
+  profile.theme = Theme::get_theme();
+  try {
+    store_profile(profile);
+  } catch (const filesystem::filesystem_error&) {
+    // It's only a cache.
+  }
+  return profile;
+}
+
+void Terminal::apply_profile(const Profile& t_profile) {
+  if (t_profile.colors_support) {
+    cache_colors_support(*t_profile.colors_support);
+  } else {
+    uncache_colors_support();
+  }
+  if (t_profile.theme < Theme::Name::_COUNT) {
+    Theme::set_theme(t_profile.theme);
+  }
+}
+
+auto Terminal::get_profile_key() const -> string {
+  string key = m_name;
+  for (const auto* variable :
+      {"COLORTERM", "TERM_PROGRAM", "TERM_PROGRAM_VERSION"}) {
+    key += '\0' + getenv(variable);
+  }
+  return key;
+}
+
+auto Terminal::QueryResult::suggest_theme(
+    const optional<ColorsSupport>& t_colors_support) const -> Theme::Name {
+  if (t_colors_support != ColorsSupport::HAS_256_COLORS || !background_luma) {
+    return Theme::Name::DEFAULT;
+  }
+  return *background_luma > 0.5 ?
+      Theme::Name::MATERIAL_LIGHT : Theme::Name::MATERIAL_DARK;
+}
+
+auto Terminal::query(int t_in_file_desc, milliseconds t_timeout) const ->
+    QueryResult {
+  if (isatty(t_in_file_desc) != 1 || isatty(m_out_file_desc) != 1) {
+    return {};
+  }
+  termios saved{};
+  if (tcgetattr(t_in_file_desc, &saved) != 0) {
+    return {};
+  }
+  auto raw = saved;
+  // Replies mustn't be echoed or wait for a new line.
+  raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+  raw.c_cc[VMIN] = 0U;
+  raw.c_cc[VTIME] = 0U;
+  if (tcsetattr(t_in_file_desc, TCSANOW, &raw) != 0) {
+    return {};
+  }
+
+  const auto deadline = steady_clock::now() + t_timeout;
+  bool sent = true;
+  for (auto requests = QUERY_REQUESTS; !requests.empty();) {
+    const auto written =
+        write(m_out_file_desc, requests.data(), requests.size());
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      sent = false;
+      break;
+    }
+    requests.remove_prefix(static_cast<size_t>(written));
+  }
+
+  string input;
+  array<char, 256U> buffer{};
+  while (sent && !find_device_attributes(input)) {
+    const auto remaining = ceil<milliseconds>(deadline - steady_clock::now());
+    if (remaining <= 0ms) {
+      break;
+    }
+    pollfd poll_file_desc{t_in_file_desc, POLLIN, 0};
+    const int ready = poll(&poll_file_desc, 1U,
+        static_cast<int>(remaining.count()));
+    if (ready < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ready <= 0) {
+      break;
+    }
+    const auto size = read(t_in_file_desc, buffer.data(), buffer.size());
+    if (size < 0 && (errno == EINTR || errno == EAGAIN)) {
+      continue;
+    }
+    if (size <= 0) {
+      break;
+    }
+    input.append(buffer.data(), static_cast<size_t>(size));
+  }
+  if (sent && !find_device_attributes(input)) {
+    // Replies that are already received would be echoed or read by the
+    // shell in the saved mode.
+    tcflush(t_in_file_desc, TCIFLUSH);
+  }
+  tcsetattr(t_in_file_desc, TCSANOW, &saved);
+
+  auto result = parse_replies(input);
+  if (const auto colorterm = getenv("COLORTERM");
+      colorterm == "truecolor" || colorterm == "24bit") {
+    result.direct_color = true;
+  }
+  return result;
+}
+
+auto Terminal::query_async(int t_in_file_desc, milliseconds t_timeout) const
+    -> future<QueryResult> {
+  return async(launch::async, [terminal = *this, t_in_file_desc, t_timeout] {
+    return terminal.query(t_in_file_desc, t_timeout);
+  });
+}
+
+auto Terminal::parse_replies(string_view t_input) -> QueryResult {
+  QueryResult result;
+  if (const auto color = find_reply(t_input, "\033]11;")) {
+    result.background_luma = parse_luma(*color);
+  }
+  if (const auto version = find_reply(t_input, "\033P>|")) {
+    result.version = *version;
+    result.direct_color = any_of(DIRECT_COLOR_TERMINALS.cbegin(),
+        DIRECT_COLOR_TERMINALS.cend(), [&version] (string_view t_name) {
+          return version->rfind(t_name, 0U) == 0U;
+        });
+  }
+  if (auto attributes = find_device_attributes(t_input)) {
+    result.device_attributes = move(*attributes);
+  }
+  return result;
+}
+
 auto Terminal::getenv(string_view t_name) -> string {
   const auto val = std::getenv(string(t_name).c_str());
 
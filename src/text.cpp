@@ -16,8 +16,11 @@
  */
 
 #include <cctype>
+#include <limits>
 #include <map>
 
+#include "fcli/internal/statistics.hpp"
+#include "fcli/internal/unicode.hpp"
 #include "fcli/text.hpp"
 
 using namespace fcli;
@@ -28,6 +31,11 @@ void Text::format(
     const optional<Terminal::ColorsSupport>& t_colors_support,
     Palette t_palette) {
   using namespace string_literals;
+  using namespace internal;
+
+  count(&text_statistics, &TextStatistics::calls);
+  count(&text_statistics, &TextStatistics::bytes_in, t_str.length());
+  const ScopeTimer timer(&text_statistics, &TextStatistics::nanoseconds);
 
   constexpr string_view
       ESC_SEQ_START = "\033[",
@@ -132,6 +140,7 @@ void Text::format(
     }
     replace_specifier(t_str, "~"s + upper_letter + '~', esc_seq);
   }
+  count(&text_statistics, &TextStatistics::bytes_out, t_str.length());
 }
 
 auto Text::format_copy(
@@ -143,6 +152,16 @@ auto Text::format_copy(
   return t_str;
 };
 
+auto Text::visible_width(string_view t_str) -> size_t {
+  return internal::unicode::measure(t_str,
+      numeric_limits<size_t>::max()).width;
+}
+
+auto Text::truncate_to_width(string_view t_str, size_t t_width)
+    -> string_view {
+  return t_str.substr(0U, internal::unicode::measure(t_str, t_width).length);
+}
+
 void Text::replace_specifier(string& t_str,
     string_view t_from, string_view t_to) {
   if (t_from.empty()) {
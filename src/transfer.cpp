@@ -0,0 +1,276 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+#include "fcli/transfer.hpp"
+
+using namespace fcli;
+using namespace std;
+using namespace chrono;
+
+namespace {
+  // Closes the descriptor on destruction.
+  struct FileDesc {
+    int value;
+
+    explicit FileDesc(int t_value): value(t_value) {}
+    ~FileDesc() {
+      if (value >= 0) {
+        close(value);
+      }
+    }
+    FileDesc(const FileDesc&) = delete;
+    auto operator=(const FileDesc&) -> FileDesc& = delete;
+    FileDesc(FileDesc&&) = delete;
+    auto operator=(FileDesc&&) -> FileDesc& = delete;
+  };
+} // Namespace.
+
+auto fcli::format_size(uintmax_t t_bytes) -> string {
+  constexpr array<const char*, 7U> UNITS{
+    "B", "KiB", "MiB", "GiB", "TiB", "PiB", "EiB"
+  };
+  constexpr double FACTOR = 1024.0;
+
+  if (t_bytes < static_cast<uintmax_t>(FACTOR)) {
+    return to_string(t_bytes) + " B";
+  }
+  auto size = static_cast<double>(t_bytes);
+  size_t unit = 0U;
+  while (size >= FACTOR && unit + 1U != UNITS.size()) {
+    size /= FACTOR;
+    ++unit;
+  }
+
+  array<char, 16U> buffer{};
+  snprintf(buffer.data(), buffer.size(), "%.1f %s", size, UNITS.at(unit));
+  return buffer.data();
+}
+
+/*
+ * ByteProgress.
+ */
+
+ByteProgress::ByteProgress(Progress& t_progress, uintmax_t t_total):
+    m_progress(t_progress), m_text(t_progress.get_text()),
+    m_clock(t_progress.get_clock()), m_total(t_total) {
+
+  if (!m_clock) {
+    m_clock = steady_clock::now;
+  }
+  m_start_time = m_clock();
+  m_progress.set_determined(m_total != 0U);
+  update(m_start_time);
+}
+
+ByteProgress::~ByteProgress() {
+  m_progress.set_text(m_text);
+}
+
+void ByteProgress::add(uintmax_t t_bytes) {
+  m_done += t_bytes;
+  if (const auto now = m_clock();
+      now >= m_next_update || (m_total != 0U && m_done >= m_total)) {
+    update(now);
+  }
+}
+
+void ByteProgress::update(Progress::time_point_t t_now) {
+  constexpr double MAX_PERCENTS = 100.0;
+
+  auto info = m_text + " (" + format_size(m_done);
+  if (m_total != 0U) {
+    info += " / " + format_size(m_total);
+  }
+  if (const auto elapsed = duration<double>(t_now - m_start_time).count();
+      elapsed > 0.0) {
+    info += ", " + format_size(static_cast<uintmax_t>(
+        static_cast<double>(m_done) / elapsed)) + "/s";
+  }
+  info += ')';
+
+  const double percents = m_total == 0U ? 0.0 :
+      static_cast<double>(m_done) / static_cast<double>(m_total) *
+      MAX_PERCENTS;
+  m_progress = pair(info, percents);
+  m_next_update = t_now + UPDATE_INTERVAL;
+}
+
+/*
+ * Copying.
+ */
+
+auto fcli::copy_file(const filesystem::path& t_from,
+    const filesystem::path& t_to, Progress& t_progress) -> uintmax_t {
+  constexpr size_t CHUNK_SIZE = 8U * 1024U * 1024U;
+  const auto fail = [&t_from, &t_to] (const char* t_message) {
+    throw filesystem::filesystem_error(t_message, t_from, t_to,
+        error_code(errno, generic_category()));
+  };
+
+  const FileDesc in(open(t_from.c_str(), O_RDONLY | O_CLOEXEC));
+  if (in.value < 0) {
+    fail("couldn't open source file");
+  }
+  struct stat info{};
+  if (fstat(in.value, &info) != 0) {
+    fail("couldn't get source file status");
+  }
+  if (!S_ISREG(info.st_mode)) {
+    errno = EINVAL;
+    fail("source isn't a regular file");
+  }
+
+  const FileDesc out(open(t_to.c_str(),
+      O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, info.st_mode & ALLPERMS));
+  if (out.value < 0) {
+    fail("couldn't open destination file");
+  }
+
+  ByteProgress byte_progress(t_progress,
+      static_cast<uintmax_t>(info.st_size));
+  bool use_sendfile = false;
+  while (true) {
+    ssize_t copied = -1;
+    if (!use_sendfile) {
+      copied = copy_file_range(in.value, nullptr, out.value, nullptr,
+          CHUNK_SIZE, 0U);
+      // Not supported for these files (for example, before Linux 5.3 across
+      // file systems), nothing is copied yet in that case.
+      if (copied < 0 && (errno == EXDEV || errno == ENOSYS ||
+          errno == EINVAL || errno == EOPNOTSUPP) &&
+          byte_progress.get_done() == 0U) {
+        use_sendfile = true;
+        continue;
+      }
+    } else {
+      copied = sendfile(out.value, in.value, nullptr, CHUNK_SIZE);
+    }
+
+    if (copied < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      fail("couldn't copy file");
+    }
+    if (copied == 0) {
+      break;
+    }
+    byte_progress.add(static_cast<uintmax_t>(copied));
+  }
+  return byte_progress.get_done();
+}
+
+/*
+ * ProgressStreambuf.
+ */
+
+ProgressStreambuf::ProgressStreambuf(streambuf& t_wrapped,
+    Progress& t_progress, uintmax_t t_total): m_wrapped(t_wrapped),
+    m_byte_progress(t_progress, t_total) {}
+
+ProgressStreambuf::~ProgressStreambuf() {
+  flush_put_area();
+}
+
+auto ProgressStreambuf::underflow() -> int_type {
+  if (gptr() != egptr()) {
+    return traits_type::to_int_type(*gptr());
+  }
+  m_get_buffer.resize(static_cast<size_t>(BUFFER_SIZE));
+  const auto size = m_wrapped.sgetn(m_get_buffer.data(), BUFFER_SIZE);
+  if (size <= 0) {
+    return traits_type::eof();
+  }
+  m_byte_progress.add(static_cast<uintmax_t>(size));
+  setg(m_get_buffer.data(), m_get_buffer.data(), m_get_buffer.data() + size);
+  return traits_type::to_int_type(*gptr());
+}
+
+auto ProgressStreambuf::xsgetn(char_type* t_data, streamsize t_size)
+    -> streamsize {
+  // Buffered data goes first.
+  const auto buffered = min(t_size, static_cast<streamsize>(egptr() - gptr()));
+  traits_type::copy(t_data, gptr(), static_cast<size_t>(buffered));
+  gbump(static_cast<int>(buffered));
+  if (buffered == t_size) {
+    return t_size;
+  }
+
+  const auto rest = t_size - buffered;
+  if (rest < BUFFER_SIZE) {
+    return buffered + streambuf::xsgetn(t_data + buffered, rest);
+  }
+  const auto size = max(m_wrapped.sgetn(t_data + buffered, rest),
+      streamsize{});
+  m_byte_progress.add(static_cast<uintmax_t>(size));
+  return buffered + size;
+}
+
+auto ProgressStreambuf::overflow(int_type t_char) -> int_type {
+  if (m_put_buffer.empty()) {
+    m_put_buffer.resize(static_cast<size_t>(BUFFER_SIZE));
+  } else if (!flush_put_area()) {
+    return traits_type::eof();
+  }
+  setp(m_put_buffer.data(), m_put_buffer.data() + m_put_buffer.size());
+
+  if (!traits_type::eq_int_type(t_char, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(t_char);
+    pbump(1);
+  }
+  return traits_type::not_eof(t_char);
+}
+
+auto ProgressStreambuf::xsputn(const char_type* t_data, streamsize t_size)
+    -> streamsize {
+  if (t_size < BUFFER_SIZE) {
+    return streambuf::xsputn(t_data, t_size);
+  }
+  if (!flush_put_area()) {
+    return 0;
+  }
+  const auto size = max(m_wrapped.sputn(t_data, t_size), streamsize{});
+  m_byte_progress.add(static_cast<uintmax_t>(size));
+  return size;
+}
+
+auto ProgressStreambuf::sync() -> int {
+  if (!flush_put_area()) {
+    return -1;
+  }
+  return m_wrapped.pubsync();
+}
+
+auto ProgressStreambuf::flush_put_area() -> bool {
+  const auto size = static_cast<streamsize>(pptr() - pbase());
+  if (size == 0) {
+    return true;
+  }
+  const auto written = max(m_wrapped.sputn(pbase(), size), streamsize{});
+  m_byte_progress.add(static_cast<uintmax_t>(written));
+  setp(m_put_buffer.data(), m_put_buffer.data() + m_put_buffer.size());
+  return written == size;
+}
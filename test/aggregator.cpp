@@ -0,0 +1,208 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fcli/aggregator.hpp"
+#include "fcli/internal/remote_protocol.hpp"
+#include "fcli/remote_progress.hpp"
+
+using namespace fcli;
+using namespace std;
+using namespace chrono_literals;
+
+TEST_CASE("Aggregation") {
+  ostringstream oss;
+  array<int, 2U> first{}, second{};
+  REQUIRE(pipe(first.data()) == 0);
+  REQUIRE(pipe(second.data()) == 0);
+
+  const auto child = fork();
+  REQUIRE(child >= 0);
+  if (child == 0) {
+    close(first.at(0U));
+    close(second.at(0U));
+    close(second.at(1U));
+    {
+      RemoteProgress done(first.at(1U), "child", true);
+      RemoteProgress lost(first.at(1U), "lost", false);
+      done = 50.0;
+      done.set_text("child task");
+      done.finish(true, "child done");
+      // Lost progress is removed by the destructor.
+    }
+    RemoteProgress(first.at(1U), "killed", false).finish(false, "error");
+    _exit(0);
+  }
+  close(first.at(1U));
+
+  {
+    Aggregator aggregator(40U, oss);
+    aggregator.set_create_handler([] (Progress& progress) {
+      progress.set_style(Progress::Style::PLAIN, "", {});
+      progress.set_style(Progress::Style::SUCCESS_SYMBOL, "", {});
+      progress.set_style(Progress::Style::FAILURE_SYMBOL, "", {});
+    });
+    aggregator.add_source(first.at(0U));
+    aggregator.add_source(second.at(0U));
+    CHECK(aggregator.get_sources_count() == 2U);
+
+    {
+      RemoteProgress unfinished(second.at(1U), "parent", false);
+      unfinished = "parent task";
+      while (aggregator.get_progresses_count() == 0U
+          || aggregator.get_sources_count() != 1U) {
+        aggregator.poll(10ms);
+      }
+      CHECK(aggregator.get_progresses_count() == 1U);
+      // Writer goes away without finishing.
+      close(second.at(1U));
+    }
+    aggregator.run();
+    CHECK(aggregator.get_sources_count() == 0U);
+    CHECK(aggregator.get_progresses_count() == 0U);
+    CHECK_FALSE(aggregator.poll(0ms));
+  }
+  waitpid(child, nullptr, 0);
+
+  const auto output = oss.str();
+  CHECK(output.find(" + child done\n") != string::npos);
+  CHECK(output.find(" - error\n") != string::npos);
+  CHECK(output.find(" - parent task\n") != string::npos);
+  CHECK(output.find(" - lost") == string::npos);
+}
+
+TEST_CASE("Postponed remote updates") {
+  using namespace internal::remote_protocol;
+
+  array<int, 2U> fds{};
+  REQUIRE(pipe(fds.data()) == 0);
+  REQUIRE(fcntl(fds.at(0U), F_SETFL, O_NONBLOCK) == 0);
+  REQUIRE(fcntl(fds.at(1U), F_SETFL, O_NONBLOCK) == 0);
+  // Returns types of the received messages.
+  const auto receive = [&fds] {
+    vector<char> data(MAX_MESSAGE_SIZE * 64U);
+    string received;
+    ssize_t size = 0;
+    while ((size = read(fds.at(0U), data.data(), data.size())) > 0) {
+      received.append(data.data(), static_cast<size_t>(size));
+    }
+    vector<Type> types;
+    for (size_t pos = 0U; pos < received.size();) {
+      Header header{};
+      memcpy(&header, received.data() + pos, sizeof(header));
+      types.push_back(header.type);
+      pos += sizeof(header) + header.payload_size;
+    }
+    return types;
+  };
+
+  const auto fill = [&fds] {
+    const string bytes(MAX_MESSAGE_SIZE, 'x');
+    for (size_t size = bytes.size(); size != 0U; size /= 2U) {
+      while (write(fds.at(1U), bytes.data(), size) != -1) {}
+    }
+    REQUIRE(errno == EAGAIN);
+  };
+  const auto drain = [&fds] {
+    array<char, MAX_MESSAGE_SIZE> data{};
+    while (read(fds.at(0U), data.data(), data.size()) > 0) {}
+  };
+
+  RemoteProgress progress(fds.at(1U), "child", true);
+  CHECK(receive() == vector{Type::CREATE});
+
+  fill();
+  progress = 100.0;
+  progress.set_text("done");
+  drain();
+  // Latest values are sent with the next update.
+  progress.set_determined(true);
+  CHECK(receive() == vector{Type::DETERMINED, Type::TEXT, Type::PERCENTS});
+
+  fill();
+  progress = 50.0;
+  drain();
+  progress.flush();
+  CHECK(receive() == vector{Type::PERCENTS});
+  progress.flush();
+  CHECK(receive().empty());
+
+  progress.finish(true, {});
+  close(fds.at(0U));
+  close(fds.at(1U));
+}
+
+TEST_CASE("Remote updates through stream socket") {
+  using namespace internal::remote_protocol;
+
+  array<int, 2U> fds{};
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()) == 0);
+  REQUIRE(fcntl(fds.at(1U), F_SETFL, O_NONBLOCK) == 0);
+  const int buffer_size = 1;
+  REQUIRE(setsockopt(fds.at(1U), SOL_SOCKET, SO_SNDBUF,
+      &buffer_size, sizeof(buffer_size)) == 0);
+
+  // Socket is read in small blocks, so messages are taken in parts.
+  string received;
+  thread reader([&fds, &received] {
+    array<char, 100U> data{};
+    ssize_t size = 0;
+    while ((size = read(fds.at(0U), data.data(), data.size())) > 0) {
+      received.append(data.data(), static_cast<size_t>(size));
+    }
+  });
+  constexpr unsigned UPDATES = 100U;
+  {
+    RemoteProgress progress(fds.at(1U), "child", false);
+    const string text(MAX_PAYLOAD_SIZE, 'x');
+    for (unsigned i = 0U; i != UPDATES; ++i) {
+      progress.set_determined(i % 2U == 0U);
+      progress.set_text(text);
+    }
+    progress.flush();
+    progress.finish(true, text);
+  }
+  close(fds.at(1U));
+  reader.join();
+  close(fds.at(0U));
+
+  // Messages aren't split by others.
+  unsigned determined = 0U;
+  size_t pos = 0U;
+  for (; pos + sizeof(Header) <= received.size();) {
+    Header header{};
+    memcpy(&header, received.data() + pos, sizeof(header));
+    CHECK(header.type <= Type::REMOVE);
+    determined += header.type == Type::DETERMINED ? 1U : 0U;
+    pos += sizeof(header) + header.payload_size;
+  }
+  CHECK(pos == received.size());
+  CHECK(determined == UPDATES);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "doctest/doctest.h"
+#include "fcli/exporter.hpp"
+
+using namespace doctest;
+using namespace fcli;
+using namespace std;
+
+TEST_CASE("Export progresses") {
+  const auto path = "/tmp/fcli-test-" + to_string(getpid());
+  ostringstream oss;
+  Progress first("first", true, oss), second("second", false, oss);
+  first.set_driver(Progress::Driver::EXTERNAL);
+  first = 42.0;
+
+  {
+    Exporter exporter(path, 1U);
+    exporter.attach(first);
+    CHECK_THROWS_AS(exporter.attach(second), out_of_range);
+
+    auto records = Exporter::read(path);
+    REQUIRE(records.size() == 1U);
+    CHECK(records[0].pid == getpid());
+    CHECK(records[0].text == "first");
+    CHECK(records[0].percents == Approx(42.0));
+    CHECK(records[0].determined);
+    CHECK(records[0].state == Progress::State::RUNNING);
+
+    // Updated on every frame.
+    first.show();
+    first = pair("updated", 50.0);
+    first.render_once(first.next_deadline());
+    CHECK(Exporter::read(path)[0].text == "updated");
+    first.finish(false, {});
+    CHECK(Exporter::read(path)[0].state == Progress::State::FAILED);
+
+    exporter.detach(first);
+    CHECK(Exporter::read(path).empty());
+    exporter.attach(second);
+    CHECK(Exporter::read(path)[0].text == "second");
+    exporter.detach(second);
+  }
+  // File is removed by the exporter.
+  CHECK_THROWS(static_cast<void>(Exporter::read(path)));
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fcli/fuzzy_matcher.hpp"
+
+using namespace fcli;
+using namespace std;
+
+namespace {
+  auto get_top_indices(const FuzzyMatcher& t_matcher) {
+    vector<size_t> indices;
+    for (const auto& match : t_matcher.get_top()) {
+      indices.push_back(match.index);
+    }
+    return indices;
+  }
+} // Namespace.
+
+TEST_CASE("Rank fuzzy matches") {
+  FuzzyMatcher matcher({"fxxxxxb", "foobar", "foo_bar", "FooBar", "baz"});
+  CHECK(matcher.get_matches_count() == 5U);
+  CHECK(get_top_indices(matcher) == vector<size_t>{0U, 1U, 2U, 3U, 4U});
+
+  // Word boundaries and camel case humps are preferred.
+  matcher.set_query("fb");
+  CHECK(matcher.get_matches_count() == 4U);
+  CHECK(get_top_indices(matcher) == vector<size_t>{3U, 2U, 1U, 0U});
+  CHECK(matcher.get_positions(2U) == vector<size_t>{0U, 4U});
+  CHECK(matcher.get_positions(4U).empty());
+
+  // Uppercase letters make the query case-sensitive.
+  matcher.set_query("fB");
+  CHECK(matcher.get_matches_count() == 0U);
+  matcher.set_query("FB");
+  CHECK(get_top_indices(matcher) == vector<size_t>{3U});
+
+  // The shortest occurrence is scored.
+  matcher.set_query("ar");
+  CHECK(matcher.get_positions(1U) == vector<size_t>{4U, 5U});
+
+  matcher.set_top_count(1U);
+  matcher.set_query("");
+  CHECK(get_top_indices(matcher) == vector<size_t>{0U});
+}
+
+TEST_CASE("Incremental and parallel matching") {
+  vector<string> candidates;
+  for (size_t i = 0U; i != 100'000U; ++i) {
+    candidates.push_back("host-" + to_string(i * 7919U % 100'003U) +
+        ".region-" + to_string(i % 13U) + ".example.com");
+  }
+  FuzzyMatcher incremental(candidates);
+  incremental.set_top_count(20U);
+  for (const auto* query : {"h", "h1", "h12", "h12r", "h12r7"}) {
+    incremental.set_query(query);
+  }
+
+  FuzzyMatcher fresh(candidates);
+  fresh.set_top_count(20U);
+  fresh.set_query("h12r7");
+  REQUIRE(fresh.get_matches_count() != 0U);
+  CHECK(incremental.get_matches_count() == fresh.get_matches_count());
+  CHECK(get_top_indices(incremental) == get_top_indices(fresh));
+
+  // Top is extended from all matches.
+  incremental.set_top_count(40U);
+  CHECK(incremental.get_top().size() == 40U);
+  for (size_t i = 1U; i != incremental.get_top().size(); ++i) {
+    CHECK(incremental.get_top()[i - 1U].score >=
+        incremental.get_top()[i].score);
+  }
+  FuzzyMatcher wide(candidates);
+  wide.set_top_count(40U);
+  wide.set_query("h12r7");
+  CHECK(get_top_indices(incremental) == get_top_indices(wide));
+
+  // Many matches are rescored on all cores.
+  incremental.set_query("hr");
+  wide.set_query("hr");
+  REQUIRE(wide.get_matches_count() > 32U * 1024U);
+  incremental.set_top_count(80U);
+  wide.set_top_count(80U);
+  FuzzyMatcher wider(candidates);
+  wider.set_top_count(80U);
+  wider.set_query("hr");
+  CHECK(get_top_indices(incremental) == get_top_indices(wider));
+  CHECK(get_top_indices(wide) == get_top_indices(wider));
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fcli/fuzzy_select.hpp"
+
+using namespace fcli;
+using namespace std;
+
+namespace {
+  auto get_row(const Screen& t_screen, unsigned short t_y) {
+    string row;
+    for (unsigned short x = 0U; x != t_screen.get_width(); ++x) {
+      const auto& cell = t_screen.get_cell(x, t_y);
+      row.append(cell.glyph.data(), cell.glyph_size);
+    }
+    return row.substr(0U, row.find_last_not_of(' ') + 1U);
+  }
+
+  auto make_character(char32_t t_code_point, uint8_t t_modifiers = 0U) {
+    Input::Event event;
+    event.code_point = t_code_point;
+    event.modifiers = t_modifiers;
+    return event;
+  }
+
+  auto make_key(Input::Key t_key) {
+    Input::Event event;
+    event.key = t_key;
+    return event;
+  }
+} // Namespace.
+
+TEST_CASE("Choose candidate by query") {
+  ostringstream oss;
+  Screen screen(20U, 4U, oss);
+  FuzzySelect select({"alpha", "beta", "gamma", "delta"},
+      Terminal::ColorsSupport::HAS_256_COLORS);
+  select.draw(screen);
+  CHECK(get_row(screen, 1U) == "4/4");
+  CHECK(get_row(screen, 2U) == "> alpha");
+  CHECK(get_row(screen, 3U) == "  beta");
+
+  CHECK(select.handle(make_character(U'l')));
+  CHECK(select.handle(make_character(U'Ф')));
+  CHECK(select.handle(make_key(Input::Key::BACKSPACE)));
+  CHECK(select.get_query() == "l");
+  CHECK(select.handle(make_character(U't')));
+  select.draw(screen);
+  CHECK(get_row(screen, 0U) == "> lt");
+  CHECK(get_row(screen, 1U) == "1/4");
+  CHECK(get_row(screen, 2U) == "> delta");
+  // Matched characters are highlighted.
+  CHECK(screen.get_cell(4U, 2U).style != screen.get_cell(3U, 2U).style);
+
+  CHECK(select.handle(make_character(U'u', Input::CTRL)));
+  CHECK(select.handle(make_key(Input::Key::DOWN)));
+  CHECK(select.handle(make_key(Input::Key::DOWN)));
+  select.draw(screen);
+  // Selection is scrolled into the visible window.
+  CHECK(get_row(screen, 2U) == "  beta");
+  CHECK(get_row(screen, 3U) == "> gamma");
+
+  CHECK_FALSE(select.handle(make_key(Input::Key::ENTER)));
+  CHECK(select.is_chosen());
+  CHECK(select.get_selected() == 2U);
+
+  // Top is doubled while scrolling past it.
+  vector<string> candidates(300U, "item");
+  FuzzySelect scrolled(candidates);
+  scrolled.set_query("i");
+  scrolled.draw(screen);
+  for (size_t i = 0U; i != FuzzyMatcher::DEFAULT_TOP_COUNT; ++i) {
+    CHECK(scrolled.handle(make_key(Input::Key::DOWN)));
+  }
+  CHECK(scrolled.get_matcher().get_top_count() ==
+      2U * FuzzyMatcher::DEFAULT_TOP_COUNT);
+  CHECK(scrolled.get_selected() == FuzzyMatcher::DEFAULT_TOP_COUNT);
+
+  FuzzySelect cancelled({"a"});
+  CHECK_FALSE(cancelled.handle(make_character(U'c', Input::CTRL)));
+  CHECK(cancelled.is_cancelled());
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <system_error>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+#include "doctest/doctest.h"
+#include "fcli/input.hpp"
+
+using namespace fcli;
+using namespace std;
+
+TEST_CASE("Read input from terminal") {
+  using namespace chrono_literals;
+
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  REQUIRE(master >= 0);
+  REQUIRE(grantpt(master) == 0);
+  REQUIRE(unlockpt(master) == 0);
+  const int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  REQUIRE(slave >= 0);
+
+  termios saved{};
+  REQUIRE(tcgetattr(slave, &saved) == 0);
+  {
+    Input input(slave, Terminal(slave));
+    termios raw{};
+    REQUIRE(tcgetattr(slave, &raw) == 0);
+    CHECK((raw.c_lflag & (ICANON | ECHO | ISIG)) == 0U);
+
+    string written(64U, '\0');
+    written.resize(static_cast<size_t>(
+        read(master, written.data(), written.size())));
+    CHECK(written == "\033[?2004h");
+
+    CHECK_FALSE(input.wait(0ms).has_value());
+    REQUIRE(write(master, "q\033[D\033", 5U) == 5);
+    auto event = input.wait(1s);
+    REQUIRE(event.has_value());
+    CHECK(event->code_point == U'q');
+    CHECK(input.wait(1s)->key == Input::Key::LEFT);
+    // The escape key alone is completed after the timeout.
+    CHECK(input.wait(1s)->key == Input::Key::ESCAPE);
+
+    unsigned events_count = 0U;
+    thread stopper([&input] {
+      this_thread::sleep_for(10ms);
+      input.stop();
+    });
+    REQUIRE(write(master, "ab", 2U) == 2);
+    input.run([&events_count] (const Input::Event&) { ++events_count; });
+    stopper.join();
+    CHECK(events_count == 2U);
+  }
+  termios restored{};
+  REQUIRE(tcgetattr(slave, &restored) == 0);
+  CHECK(restored.c_lflag == saved.c_lflag);
+
+  close(slave);
+  close(master);
+
+  CHECK_THROWS_AS(Input(-1), system_error);
+}
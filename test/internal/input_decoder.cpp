@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <deque>
+#include <string>
+#include <string_view>
+
+#include "doctest/doctest.h"
+#include "fcli/internal/input_decoder.hpp"
+
+using namespace fcli;
+using namespace fcli::internal;
+using namespace std;
+
+using Key = Input::Key;
+
+namespace {
+  // Feeds data byte by byte, so all states are kept between calls.
+  auto decode_bytes(InputDecoder& t_decoder, string_view t_data) {
+    deque<Input::Event> events;
+    for (size_t i = 0U; i != t_data.size(); ++i) {
+      t_decoder.feed(t_data.substr(i, 1U), events);
+    }
+    return events;
+  }
+} // Namespace.
+
+TEST_CASE("Decode characters and control keys") {
+  InputDecoder decoder;
+  deque<Input::Event> events;
+  decoder.feed("a\xD0\xAF\xF0\x9F\x98\x80\r\t\x7F\x03\xFF", events);
+  REQUIRE(events.size() == 8U);
+  CHECK(events[0].code_point == U'a');
+  CHECK(events[1].code_point == U'Я');
+  CHECK(events[2].code_point == U'\U0001F600');
+  CHECK(events[3].key == Key::ENTER);
+  CHECK(events[4].key == Key::TAB);
+  CHECK(events[5].key == Key::BACKSPACE);
+  CHECK(events[6].code_point == U'c');
+  CHECK(events[6].modifiers == Input::CTRL);
+  CHECK(events[7].code_point == 0xFFFDU);
+
+  // Split character and the interrupted one.
+  events = decode_bytes(decoder, "\xE4\xB8\xAD\xE4x");
+  REQUIRE(events.size() == 3U);
+  CHECK(events[0].code_point == U'中');
+  CHECK(events[1].code_point == 0xFFFDU);
+  CHECK(events[2].code_point == U'x');
+}
+
+TEST_CASE("Decode escape sequences") {
+  InputDecoder decoder;
+  auto events = decode_bytes(decoder,
+      "\033[A\033[1;5C\033OP\033[3~\033[24;2~\033[Z\033[97;3u\033[?9z");
+  REQUIRE(events.size() == 8U);
+  CHECK(events[0].key == Key::UP);
+  CHECK(events[0].modifiers == 0U);
+  CHECK(events[1].key == Key::RIGHT);
+  CHECK(events[1].modifiers == Input::CTRL);
+  CHECK(events[2].key == Key::F1);
+  CHECK(events[3].key == Key::DELETE);
+  CHECK(events[4].key == Key::F12);
+  CHECK(events[4].modifiers == Input::SHIFT);
+  CHECK(events[5].key == Key::TAB);
+  CHECK(events[5].modifiers == Input::SHIFT);
+  CHECK(events[6].code_point == U'a');
+  CHECK(events[6].modifiers == Input::ALT);
+  CHECK(events[7].key == Key::UNKNOWN);
+  CHECK(events[7].text == "\033[?9z");
+
+  // Escape key alone is completed by the timeout of the caller.
+  events = decode_bytes(decoder, "\033x\033");
+  REQUIRE(events.size() == 1U);
+  CHECK(events[0].code_point == U'x');
+  CHECK(events[0].modifiers == Input::ALT);
+  CHECK(decoder.is_pending());
+  decoder.flush(events);
+  CHECK_FALSE(decoder.is_pending());
+  CHECK(events.back().key == Key::ESCAPE);
+
+  // Sequence interrupted by another one.
+  events = decode_bytes(decoder, "\033[1\033[B");
+  REQUIRE(events.size() == 2U);
+  CHECK(events[0].key == Key::UNKNOWN);
+  CHECK(events[1].key == Key::DOWN);
+}
+
+TEST_CASE("Decode paste and mouse") {
+  InputDecoder decoder;
+  auto events = decode_bytes(decoder,
+      "\033[200~a\033[Ab\r\033[201~\033[<0;10;5M\033[<64;1;1M\033[<2;3;4m");
+  REQUIRE(events.size() == 4U);
+  CHECK(events[0].key == Key::PASTE);
+  CHECK(events[0].text == "a\033[Ab\r");
+
+  using Action = Input::Mouse::Action;
+  CHECK(events[1].key == Key::MOUSE);
+  CHECK(events[1].mouse.action == Action::PRESS);
+  CHECK(events[1].mouse.x == 9U);
+  CHECK(events[1].mouse.y == 4U);
+  CHECK(events[2].mouse.action == Action::SCROLL_UP);
+  CHECK(events[3].mouse.action == Action::RELEASE);
+  CHECK(events[3].mouse.button == 2U);
+
+  // Paste is never completed by the timeout.
+  decoder.feed("\033[200~abc", events);
+  CHECK_FALSE(decoder.is_pending());
+  decoder.feed("\033[201~z", events);
+  CHECK(events[4].text == "abc");
+  CHECK(events[5].code_point == U'z');
+}
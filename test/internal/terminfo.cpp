@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+#include "doctest/doctest.h"
+#include "fcli/internal/terminfo.hpp"
+
+using namespace fcli::internal;
+using namespace std;
+
+namespace {
+  void put_number(string& t_entry, int t_value, size_t t_size) {
+    for (size_t i = 0U; i != t_size; ++i) {
+      t_entry += static_cast<char>(static_cast<uint32_t>(t_value) >> i * 8U);
+    }
+  }
+
+  void align(string& t_entry) {
+    if (t_entry.size() % 2U != 0U) {
+      t_entry += '\0';
+    }
+  }
+
+  // Entry with colors, sgr0, setaf and the extended Tc capability.
+  auto build_entry(bool t_numbers_32_bit, int t_colors) -> string {
+    constexpr string_view NAMES("test|Test terminal", 19U);
+    constexpr string_view TABLE("\033[m\0\033[3%p1%dm", 14U);
+    constexpr int STRINGS_COUNT = 361;
+    const size_t number_size = t_numbers_32_bit ? 4U : 2U;
+
+    string entry;
+    for (const int value : {t_numbers_32_bit ? 01036 : 0432,
+        static_cast<int>(NAMES.size()), 1, 14, STRINGS_COUNT,
+        static_cast<int>(TABLE.size())}) {
+      put_number(entry, value, 2U);
+    }
+    entry += NAMES;
+    // The only boolean makes the numbers section unaligned.
+    entry += '\1';
+    align(entry);
+    for (int i = 0; i != 14; ++i) {
+      put_number(entry, i == 13 ? t_colors : -1, number_size);
+    }
+    for (int i = 0; i != STRINGS_COUNT; ++i) {
+      put_number(entry, i == 39 ? 0 : i == 359 ? 4 : -1, 2U);
+    }
+    entry += TABLE;
+
+    // Extended: one boolean named "Tc".
+    align(entry);
+    for (const int value : {1, 0, 0, 1, 3}) {
+      put_number(entry, value, 2U);
+    }
+    entry += '\1';
+    align(entry);
+    put_number(entry, 0, 2U);
+    entry += string_view("Tc", 3U);
+    return entry;
+  }
+} // Namespace.
+
+TEST_CASE("Terminfo entries") {
+  for (const bool numbers_32_bit : {false, true}) {
+    const auto capabilities =
+        terminfo::parse(build_entry(numbers_32_bit, 256));
+    REQUIRE(capabilities.has_value());
+    CHECK(capabilities->colors == 256);
+    CHECK(capabilities->direct_color);
+    CHECK(capabilities->exit_attributes == "\033[m");
+    CHECK(capabilities->set_foreground == "\033[3%p1%dm");
+    CHECK(capabilities->set_background.empty());
+  }
+
+  // Any truncation is detected.
+  const auto entry = build_entry(false, 8);
+  for (size_t size = 0U; size < 750U; size += 13U) {
+    CHECK_FALSE(terminfo::parse(entry.substr(0U, size)).has_value());
+  }
+  CHECK_FALSE(terminfo::parse(string(entry.size(), '\0')).has_value());
+
+  const auto directory = filesystem::temp_directory_path() /
+      ("fcli-terminfo-" + to_string(getpid()));
+  filesystem::create_directories(directory / "f");
+  ofstream(directory / "f" / "fcli-test", ios::binary) << entry;
+  setenv("TERMINFO", directory.c_str(), 1);
+
+  const auto loaded = terminfo::get_cached("fcli-test");
+  filesystem::remove_all(directory);
+  unsetenv("TERMINFO");
+  REQUIRE(loaded.has_value());
+  CHECK(loaded->colors == 8);
+  // Result is cached.
+  CHECK(terminfo::get_cached("fcli-test").has_value());
+  CHECK_FALSE(terminfo::load("fcli-missing").has_value());
+  CHECK_FALSE(terminfo::load("../fcli-test").has_value());
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <string>
+#include <thread>
+
+#include "doctest/doctest.h"
+#include "fcli/internal/triple_buffer.hpp"
+
+using namespace fcli::internal;
+using namespace std;
+
+TEST_CASE("Triple buffer") {
+  TripleBuffer<string> buffer;
+  CHECK_FALSE(buffer.update());
+
+  buffer.get_back() = "first";
+  buffer.publish();
+  buffer.get_back() = "second";
+  buffer.publish();
+  // Only the last value is taken.
+  REQUIRE(buffer.update());
+  CHECK(buffer.get_front() == "second");
+  CHECK_FALSE(buffer.update());
+  CHECK(buffer.get_front() == "second");
+
+  // Values are never torn or taken out of order.
+  constexpr int COUNT = 100'000;
+  thread writer([&buffer] {
+    for (int i = 1; i <= COUNT; ++i) {
+      buffer.get_back() = to_string(i);
+      buffer.publish();
+    }
+  });
+  int last = 0;
+  while (last != COUNT) {
+    if (buffer.update()) {
+      const auto value = stoi(buffer.get_front());
+      REQUIRE(value > last);
+      last = value;
+    }
+  }
+  writer.join();
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fcli/internal/work_stealing.hpp"
+
+using namespace fcli::internal;
+using namespace std;
+
+TEST_CASE("Each index is processed exactly once") {
+  constexpr size_t COUNT = 10'000U;
+  vector<atomic<unsigned>> visits(COUNT);
+
+  WorkStealing scheduler(COUNT, 4U, 7U);
+  REQUIRE(scheduler.get_workers() == 4U);
+  scheduler.run([&visits] (size_t first, size_t last) {
+    // Uneven load makes workers steal.
+    if (first < COUNT / 4U) {
+      this_thread::sleep_for(chrono::microseconds(50));
+    }
+    for (auto i = first; i != last; ++i) {
+      ++visits[i];
+    }
+  });
+
+  CHECK(scheduler.get_done() == COUNT);
+  CHECK_FALSE(scheduler.is_cancelled());
+  for (const auto& v : visits) {
+    REQUIRE(v == 1U);
+  }
+}
+
+TEST_CASE("Cancellation") {
+  WorkStealing empty(0U, 2U);
+  CHECK(empty.get_workers() == 1U);
+  CHECK_NOTHROW(empty.run([] (size_t, size_t) {}));
+
+  WorkStealing scheduler(1'000U, 2U, 1U);
+  CHECK_THROWS_AS(scheduler.run([] (size_t first, size_t) {
+    if (first == 10U) {
+      throw runtime_error("");
+    }
+  }), runtime_error);
+  CHECK(scheduler.is_cancelled());
+  CHECK(scheduler.get_done() < 1'000U);
+
+  WorkStealing predicate(1'000U, 2U, 1U);
+  predicate.run([] (size_t, size_t) {}, [] { return true; });
+  CHECK(predicate.is_cancelled());
+  CHECK(predicate.get_done() == 0U);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fcli/output_arbiter.hpp"
+
+using namespace fcli;
+using namespace std;
+
+TEST_CASE("Output arbitration") {
+  ostringstream oss;
+  {
+    OutputArbiter arbiter(oss);
+    arbiter.print("first");
+
+    Progress progress("progress", true, arbiter.get_ostream(), {});
+    progress.set_append_dots(false);
+    arbiter.attach(progress);
+
+    vector<thread> threads;
+    for (int i = 0; i != 4; ++i) {
+      threads.emplace_back([&arbiter, i] {
+        auto& stream = arbiter.get_ostream();
+        // Each thread has its own stream.
+        CHECK(&stream == &arbiter.get_ostream());
+        stream << hex;
+        for (int j = 0; j != 50; ++j) {
+          stream << "line " << i << ' ' << j << endl;
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    arbiter.finish(progress, true, "done");
+    // Formatting state of other threads isn't shared.
+    arbiter.get_ostream() << 10 << " incomplete";
+  }
+
+  const auto output = oss.str();
+  CHECK(output.rfind("first\n", 0U) == 0U);
+  // Lines of different threads aren't mixed.
+  for (int i = 0; i != 4; ++i) {
+    for (int j = 0; j != 50; ++j) {
+      ostringstream line;
+      line << hex << "line " << i << ' ' << j << '\n';
+      CHECK(output.find(line.str()) != string::npos);
+    }
+  }
+  CHECK(output.find(" + done\n") != string::npos);
+  CHECK(output.size() - output.rfind("10 incomplete\n") ==
+      string("10 incomplete\n").size());
+}
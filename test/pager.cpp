@@ -0,0 +1,218 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+#include "doctest/doctest.h"
+#include "fcli/pager.hpp"
+
+using namespace fcli;
+using namespace std;
+
+namespace {
+  auto get_row(const Screen& t_screen, unsigned short t_y) {
+    string row;
+    for (unsigned short x = 0U; x != t_screen.get_width(); ++x) {
+      const auto& cell = t_screen.get_cell(x, t_y);
+      row.append(cell.glyph.data(), cell.glyph_size);
+    }
+    return row.substr(0U, row.find_last_not_of(' ') + 1U);
+  }
+
+  auto make_character(char32_t t_code_point) {
+    Input::Event event;
+    event.code_point = t_code_point;
+    return event;
+  }
+
+  // Gives the initial content, then blocks until the end is released.
+  class BlockingBuffer: public streambuf {
+  public:
+    explicit BlockingBuffer(string t_content): m_content(move(t_content)) {
+      setg(m_content.data(), m_content.data(),
+          m_content.data() + m_content.size());
+    }
+
+    void release() {
+      lock_guard lock(m_mut);
+      m_released = true;
+      m_released_cv.notify_all();
+    }
+
+  protected:
+    auto underflow() -> int_type override {
+      unique_lock lock(m_mut);
+      m_released_cv.wait(lock, [this] { return m_released; });
+      return traits_type::eof();
+    }
+
+  private:
+    string m_content;
+    mutex m_mut;
+    condition_variable m_released_cv;
+    bool m_released{};
+  };
+
+  void wait_lines(const Pager& t_pager, size_t t_count) {
+    const auto deadline = chrono::steady_clock::now() + 5s;
+    while (t_pager.get_lines_count() != t_count &&
+        chrono::steady_clock::now() < deadline) {
+      this_thread::sleep_for(1ms);
+    }
+  }
+} // Namespace.
+
+TEST_CASE("Page mapped file") {
+  const auto path = filesystem::temp_directory_path() /
+      ("fcli-pager-" + to_string(getpid()));
+  ofstream(path) << "<b>bold<r>\r\n\tx\n\nlast";
+  {
+    Pager pager(path, Terminal::ColorsSupport::HAS_256_COLORS);
+    pager.wait_indexed();
+    CHECK(pager.is_indexed());
+    REQUIRE(pager.get_lines_count() == 4U);
+    CHECK(pager.get_raw_line(0U) == "<b>bold<r>");
+    CHECK(pager.get_line(0U) == "\033[1mbold\033[0m");
+    CHECK(pager.get_line(1U) == string(8U, ' ') + 'x');
+    CHECK(pager.get_raw_line(2U).empty());
+    CHECK(pager.get_raw_line(3U) == "last");
+    CHECK_THROWS_AS(static_cast<void>(pager.get_raw_line(4U)), out_of_range);
+
+    pager.set_formatting(false);
+    CHECK(pager.get_line(0U) == "<b>bold<r>");
+  }
+  filesystem::remove(path);
+
+  CHECK_THROWS_AS(Pager{path}, filesystem::filesystem_error);
+}
+
+TEST_CASE("Search in stream") {
+  stringstream stream;
+  for (unsigned i = 0U; i != 10'000U; ++i) {
+    stream << "line " << i << '\n';
+  }
+  Pager pager(stream);
+  CHECK(pager.find("line 9999", 0U) == 9999U);
+  pager.wait_indexed();
+  CHECK(pager.get_lines_count() == 10'000U);
+  CHECK(pager.find("line 12", 0U) == 12U);
+  // Search starts after the line.
+  CHECK(pager.find("line 12", 12U) == 120U);
+  CHECK(pager.find("line 12", 120U, true) == 12U);
+  CHECK_FALSE(pager.find("line 1", 0U, true).has_value());
+  CHECK_FALSE(pager.find("absent", 0U).has_value());
+}
+
+TEST_CASE("Page available bytes of stream") {
+  BlockingBuffer buffer("first\nsecond\n");
+  istream stream(&buffer);
+  Pager pager(stream);
+  wait_lines(pager, 2U);
+  CHECK(pager.get_lines_count() == 2U);
+  CHECK_FALSE(pager.is_indexed());
+  buffer.release();
+  pager.wait_indexed();
+  CHECK(pager.get_raw_line(0U) == "first");
+}
+
+TEST_CASE("Page descriptor") {
+  array<int, 2U> pipe_file_descs{};
+  REQUIRE(pipe(pipe_file_descs.data()) == 0);
+  const string_view lines = "first\nsecond\n";
+  REQUIRE(write(pipe_file_descs[1U], lines.data(), lines.size()) ==
+      static_cast<ssize_t>(lines.size()));
+  Input::Event enter;
+  enter.key = Input::Key::ENTER;
+  {
+    Pager pager(pipe_file_descs[0U], {});
+    // Lines are available before the end of a pipe.
+    wait_lines(pager, 2U);
+    CHECK(pager.get_lines_count() == 2U);
+    CHECK(pager.get_raw_line(1U) == "second");
+    CHECK_FALSE(pager.is_indexed());
+
+    // Search doesn't wait for the rest of lines.
+    ostringstream oss;
+    Screen screen(30U, 2U, oss);
+    for (const auto c : U"/third") {
+      CHECK(pager.handle(c == U'\0' ? enter : make_character(c)));
+    }
+    pager.draw(screen);
+    CHECK(get_row(screen, 1U) == "Searching...");
+    const string_view rest = "third\n";
+    REQUIRE(write(pipe_file_descs[1U], rest.data(), rest.size()) ==
+        static_cast<ssize_t>(rest.size()));
+    wait_lines(pager, 3U);
+    pager.draw(screen);
+    CHECK(pager.get_top() == 2U);
+    CHECK(get_row(screen, 0U) == "third");
+    // Destruction doesn't wait for the end.
+  }
+  close(pipe_file_descs[0U]);
+  close(pipe_file_descs[1U]);
+}
+
+TEST_CASE("Scroll and search interactively") {
+  stringstream stream;
+  for (unsigned i = 0U; i != 100U; ++i) {
+    stream << "line " << i << '\n';
+  }
+  Pager pager(stream, {});
+  pager.wait_indexed();
+  ostringstream oss;
+  Screen screen(30U, 5U, oss);
+
+  pager.draw(screen);
+  CHECK(get_row(screen, 0U) == "line 0");
+  CHECK(get_row(screen, 4U) == "lines 1-4 of 100");
+
+  CHECK(pager.handle(make_character(U'j')));
+  CHECK(pager.handle(make_character(U' ')));
+  CHECK(pager.get_top() == 5U);
+  CHECK(pager.handle(make_character(U'G')));
+  CHECK(pager.get_top() == 96U);
+
+  for (const auto c : U"?line 42") {
+    if (c != U'\0') {
+      CHECK(pager.handle(make_character(c)));
+    }
+  }
+  pager.draw(screen);
+  CHECK(get_row(screen, 4U) == "?line 42");
+  Input::Event enter;
+  enter.key = Input::Key::ENTER;
+  CHECK(pager.handle(enter));
+  CHECK(pager.get_top() == 42U);
+
+  CHECK(pager.handle(make_character(U'n')));
+  pager.draw(screen);
+  CHECK(get_row(screen, 4U) == "Pattern not found");
+
+  CHECK_FALSE(pager.handle(make_character(U'q')));
+}
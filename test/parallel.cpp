@@ -0,0 +1,81 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fcli/parallel.hpp"
+
+using namespace doctest;
+using namespace fcli;
+using namespace std;
+
+TEST_CASE("Parallel algorithms") {
+  ostringstream oss;
+  Progress progress({}, false, oss);
+
+  vector<int> input(1'000);
+  iota(input.begin(), input.end(), 0);
+  atomic<long> sum{};
+  CHECK(parallel_for(input, [&sum] (int i) { sum += i; }, progress));
+  CHECK(sum == 499'500L);
+  CHECK(progress.is_determined());
+  CHECK(progress.get_percents() == Approx(100.0));
+
+  sum = 0L;
+  CHECK(parallel_for(100U, [&sum] (unsigned i) { sum += i; }, progress,
+      {2U, 3U}));
+  CHECK(sum == 4'950L);
+
+  vector<int> output(input.size());
+  CHECK(parallel_transform(input, output.begin(),
+      [] (int i) { return i * 2; }, progress));
+  for (size_t i = 0U; i != input.size(); ++i) {
+    REQUIRE(output[i] == input[i] * 2);
+  }
+}
+
+TEST_CASE("Parallel algorithms cancellation") {
+  ostringstream oss;
+  Progress progress({}, true, oss);
+
+  CHECK_THROWS_AS(parallel_for(1'000, [] (int i) {
+    if (i == 500) {
+      throw runtime_error("");
+    }
+  }, progress, {1U, 1U}), runtime_error);
+  // Items before the failed one are counted.
+  CHECK(progress.get_percents() == Approx(50.0));
+  CHECK_THROWS_AS(parallel_for(-1, [] (int) {}, progress), out_of_range);
+
+  atomic<int> calls{};
+  CHECK_FALSE(parallel_for(1'000, [&] (int) {
+    if (++calls == 10) {
+      progress.finish(false, "failure");
+    }
+  }, progress, {2U, 1U}));
+  CHECK(calls < 1'000);
+
+  // Failure that happened before the run is ignored.
+  calls = 0;
+  CHECK(parallel_for(1'000, [&calls] (int) { ++calls; }, progress));
+  CHECK(calls == 1'000);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "doctest/doctest.h"
+#include "fcli/phase.hpp"
+
+using namespace fcli;
+using namespace std;
+
+TEST_CASE("Phases profiling") {
+  ostringstream oss;
+  Progress progress("initial", false, oss);
+  {
+    Phase outer(progress, "phase test outer");
+    CHECK(progress.get_text() == "phase test outer");
+    for (int i = 0; i != 300; ++i) {
+      Phase inner("phase test inner");
+    }
+    thread([] { Phase other("phase test \"other\""); }).join();
+  }
+  CHECK(progress.get_text() == "initial");
+
+  size_t outer = 0U, inner = 0U, other = 0U;
+  for (const auto& record : Phase::get_records()) {
+    if (record.name == "phase test outer") {
+      ++outer;
+      CHECK(record.depth == 0U);
+    } else if (record.name == "phase test inner") {
+      ++inner;
+      CHECK(record.depth == 1U);
+    } else if (record.name == "phase test \"other\"") {
+      ++other;
+    }
+  }
+  CHECK(outer == 1U);
+  // More than one chunk of records.
+  CHECK(inner == 300U);
+  CHECK(other == 1U);
+
+  const auto summary = Phase::format_summary({});
+  CHECK(summary.rfind("Phase ", 0U) == 0U);
+  CHECK(summary.find("\nphase test inner ") != string::npos);
+  CHECK(summary.find("  300  ") != string::npos);
+
+  const auto path = filesystem::temp_directory_path() /
+      ("fcli-trace-" + to_string(getpid()) + ".json");
+  Phase::write_trace(path);
+  ifstream file(path);
+  const string trace(istreambuf_iterator<char>(file), {});
+  filesystem::remove(path);
+  CHECK(trace.rfind("{\"traceEvents\":[", 0U) == 0U);
+  CHECK(trace.find("\"name\":\"phase test \\\"other\\\"\",\"ph\":\"X\"") !=
+      string::npos);
+  // Times are exact microseconds with nanoseconds as the fraction.
+  for (const string key : {"\"ts\":", "\"dur\":"}) {
+    const auto start = trace.find(key) + key.size();
+    const auto value = trace.substr(start, trace.find(',', start) - start);
+    REQUIRE(value.size() > 4U);
+    CHECK(value.find_first_not_of("0123456789.") == string::npos);
+    CHECK(value.find('.') == value.size() - 4U);
+  }
+}
+
+TEST_CASE("Bounded phase records") {
+  const auto dropped = Phase::get_dropped_count();
+  thread([] {
+    // Names aren't kept by the caller.
+    string name = "phase test bounded";
+    for (size_t i = 0U; i != Phase::MAX_THREAD_RECORDS + 10U; ++i) {
+      Phase phase(name);
+    }
+  }).join();
+  CHECK(Phase::get_dropped_count() - dropped == 10U);
+
+  size_t bounded = 0U;
+  for (const auto& record : Phase::take_records()) {
+    bounded += record.name == "phase test bounded" ? 1U : 0U;
+  }
+  CHECK(bounded == Phase::MAX_THREAD_RECORDS);
+  // Taken records aren't returned again.
+  CHECK(Phase::get_records().empty());
+
+  { Phase again("phase test again"); }
+  const auto records = Phase::take_records();
+  REQUIRE(records.size() == 1U);
+  CHECK(records.front().name == "phase test again");
+}
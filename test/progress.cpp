@@ -18,12 +18,13 @@
 #include <chrono>
 #include <limits>
 #include <sstream>
-#include <thread>
 #include <utility>
+#include <vector>
 
 #include "doctest/doctest.h"
 #include "fcli/progress.hpp"
 #include "fcli/terminal.hpp"
+#include "fcli/virtual_clock.hpp"
 
 using namespace doctest;
 using namespace fcli;
@@ -71,8 +72,12 @@ TEST_CASE("Update interval of information") {
   using namespace chrono_literals;
 
   ostringstream oss;
+  VirtualClock clock;
   Progress progress({}, true, oss);
+  progress.set_clock(clock.get_function());
+  progress.set_driver(Progress::Driver::EXTERNAL);
   progress.show();
+  CHECK(progress.step(clock.now()));
 
   progress.set_info_update_interval(50ms);
   progress = "abc";
@@ -88,8 +93,13 @@ TEST_CASE("Update interval of information") {
   CHECK(progress_copy.get_text() == "def");
   CHECK(progress_copy.get_percents() == Approx(1.0));
 
-  // Wait for the pending values to be applied.
-  this_thread::sleep_for(75ms);
+  // Pending values are applied by the frame after the interval.
+  CHECK(progress.step(clock.now()));
+  CHECK(progress.get_text() == "abc");
+  clock.advance(49ms);
+  CHECK_FALSE(progress.step(clock.now()));
+  clock.advance(1ms);
+  CHECK(progress.step(clock.now()));
   CHECK(progress.get_text() == "def");
   CHECK(progress.get_percents() == Approx(1.0));
   CHECK_FALSE(progress.get_pending_text().has_value());
@@ -102,3 +112,165 @@ TEST_CASE("Update interval of information") {
   CHECK(progress.get_text() == "xyz");
   CHECK(progress.get_percents() == Approx(100.0));
 }
+
+TEST_CASE("External driver") {
+  using namespace chrono_literals;
+
+  ostringstream oss;
+  Progress progress("abc", false, oss);
+  progress.set_append_dots(false);
+  progress.set_style(Progress::Style::PLAIN, "", {});
+  progress.set_style(Progress::Style::INDICATOR, "", {});
+
+  VirtualClock clock(Progress::time_point_t{1h});
+  progress.set_clock(clock.get_function());
+  unsigned wakeups = 0U;
+  progress.set_wakeup_handler([&wakeups] { ++wakeups; });
+
+  progress.set_driver(Progress::Driver::EXTERNAL);
+  CHECK(progress.next_deadline() == Progress::time_point_t::max());
+  progress.show();
+  CHECK(wakeups != 0U);
+  CHECK(progress.next_deadline() <= clock.now());
+
+  CHECK(progress.step(clock.now()));
+  CHECK(oss.str() == "\r\r - abc");
+  // Next frame of the default indicator.
+  CHECK(progress.next_deadline() == clock.now() + 125ms);
+
+  oss.str({});
+  clock.advance(124ms);
+  CHECK_FALSE(progress.step(clock.now()));
+  CHECK(oss.str().empty());
+  clock.advance(1ms);
+  CHECK(progress.step(clock.now()));
+  CHECK(oss.str() == "\r" + string(Progress().get_width(), ' ') + "\r \\ abc");
+
+  // Pending information uses the injected clock.
+  progress.set_info_update_interval(1s);
+  progress = "def";
+  progress = "ghi";
+  CHECK(progress.get_pending_text() == "ghi");
+  CHECK(progress.next_deadline() <= clock.now());
+  clock.advance(1s);
+  CHECK(progress.step(clock.now()));
+  CHECK(progress.get_text() == "ghi");
+
+  progress.hide();
+  CHECK(progress.next_deadline() == Progress::time_point_t::max());
+}
+
+TEST_CASE("Synchronous stepping") {
+  using namespace chrono_literals;
+
+  ostringstream oss;
+  VirtualClock clock;
+  Progress progress("abc", false, oss);
+  progress.set_clock(clock.get_function());
+  progress.set_driver(Progress::Driver::EXTERNAL);
+  size_t frames = 0U;
+  progress.add_frame_handler([&frames] (const Progress::Snapshot&)
+      { ++frames; });
+  progress.show();
+
+  // Ten minutes of animation without waiting.
+  for (int i = 0; i != 24000; ++i) {
+    clock.advance(25ms);
+    progress.step(clock.now());
+  }
+  // The first frame and then each frame of the indicator.
+  CHECK(frames == 1U + 24000U * 25U / 125U - 1U);
+}
+
+TEST_CASE("Unicode text") {
+  ostringstream oss;
+  Progress progress("\u4E2D\u6587 " + string(100U, 'x'), true, oss);
+  progress.set_width(40U);
+  progress.set_append_dots(false);
+  for (const auto style : {Progress::Style::PLAIN,
+      Progress::Style::LOADING_BAR, Progress::Style::PERCENTS}) {
+    progress.set_style(style, "", {});
+  }
+
+  progress = 50.0;
+  const auto frame = progress.render_frame();
+  CHECK(Text::visible_width(frame) == progress.get_width());
+  CHECK(frame.rfind("\u4E2D\u6587 x", 0U) == 0U);
+}
+
+TEST_CASE("Shared appearance") {
+  using namespace chrono_literals;
+
+  ostringstream oss;
+  // Without colors support all styles are empty.
+  Progress first("abc", false, oss, {});
+  first.set_append_dots(false);
+  Progress second(first);
+
+  second.set_success_symbol("ok");
+  second.set_indicator({1s, 1U, {"*"}});
+  CHECK(first.get_success_symbol() == "+");
+  CHECK(first.format_result(true, "done") == " + done");
+  CHECK(second.format_result(true, "done") == " ok done");
+
+  CHECK(first.render_frame() == " - abc");
+  CHECK(second.render_frame() == " * abc");
+  CHECK(second.get_indicator().frames.front() == "*");
+}
+
+TEST_CASE("Stall detection") {
+  using namespace chrono_literals;
+
+  ostringstream oss;
+  Progress progress("abc", true, oss, {});
+  progress.set_style(Progress::Style::STALLED, "<u>",
+      Terminal::ColorsSupport::HAS_8_COLORS);
+  VirtualClock clock;
+  progress.set_clock(clock.get_function());
+
+  vector<bool> changes;
+  progress.set_stall_detection(1s, 0.0,
+      [&changes] (bool t_stalled) { changes.push_back(t_stalled); });
+  (void)progress.render_frame();
+  clock.advance(999ms);
+  CHECK(progress.render_frame().find("\033[4m") == string::npos);
+  CHECK_FALSE(progress.is_stalled());
+
+  clock.advance(1ms);
+  CHECK(progress.render_frame().find("\033[4m") != string::npos);
+  CHECK(progress.is_stalled());
+
+  // Any growth revives the progress without the minimum rate.
+  progress = 1.0;
+  (void)progress.render_frame();
+  CHECK_FALSE(progress.is_stalled());
+  CHECK(changes == vector{true, false});
+
+  // 1% per second is less than required.
+  progress.set_stall_detection(1s, 2.0);
+  (void)progress.render_frame();
+  clock.advance(1s);
+  progress = 2.0;
+  (void)progress.render_frame();
+  CHECK(progress.is_stalled());
+  clock.advance(1s);
+  progress = 5.0;
+  (void)progress.render_frame();
+  CHECK_FALSE(progress.is_stalled());
+
+  // Disabling of detection ends the stall.
+  changes.clear();
+  progress.set_stall_detection(1s, 0.0,
+      [&changes] (bool t_stalled) { changes.push_back(t_stalled); });
+  (void)progress.render_frame();
+  clock.advance(1s);
+  (void)progress.render_frame();
+  CHECK(progress.is_stalled());
+  progress.set_stall_detection(0ms);
+  CHECK_FALSE(progress.is_stalled());
+  CHECK(changes == vector{true, false});
+
+  clock.advance(1h);
+  (void)progress.render_frame();
+  CHECK_FALSE(progress.is_stalled());
+}
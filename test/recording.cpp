@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "doctest/doctest.h"
+#include "fcli/progress.hpp"
+#include "fcli/recording.hpp"
+#include "fcli/virtual_clock.hpp"
+
+using namespace fcli;
+using namespace std;
+using namespace chrono_literals;
+
+TEST_CASE("Recording and replaying") {
+  const auto path = filesystem::temp_directory_path() /
+      ("fcli-recording-" + to_string(getpid()));
+  ostringstream oss;
+  {
+    Progress progress("Recording", true, oss);
+    progress.set_width(40U);
+    progress.set_recorder(make_shared<Recorder>(path));
+    progress.show();
+    for (int i = 1; i <= 5; ++i) {
+      progress = i * 20.0;
+      this_thread::sleep_for(10ms);
+    }
+    progress.set_text("Recorded");
+    progress.finish(true, "Done");
+  }
+
+  const Replayer replayer(path);
+  // Initial state, show, percents, text and finish at least.
+  CHECK(replayer.get_events_count() >= 12U);
+
+  ostringstream first_output, second_output;
+  const auto first = replayer.run(first_output);
+  const auto second = replayer.run(second_output);
+  CHECK(first.events == replayer.get_events_count());
+  CHECK(first.recorded_bytes == oss.str().length());
+  CHECK(first.frames != 0U);
+  CHECK(first.bytes == first_output.str().length());
+  // Virtual time makes results reproducible.
+  CHECK(second.frames == first.frames);
+  CHECK(second_output.str() == first_output.str());
+  CHECK(first_output.str().find("100.0%") != string::npos);
+  CHECK(first_output.str().find("Done\n") != string::npos);
+
+  ostringstream real_output;
+  const auto real = replayer.run(real_output, 10.0);
+  CHECK(real.frames != 0U);
+  CHECK(real_output.str().find("Done\n") != string::npos);
+
+  ofstream(path, ios::trunc) << "FCLIREC1 truncated";
+  CHECK_THROWS_AS(Replayer{path}, Replayer::format_error);
+  filesystem::remove(path);
+  CHECK_THROWS_AS(Replayer{path}, filesystem::filesystem_error);
+}
+
+TEST_CASE("Recording with the clock of a progress") {
+  using namespace internal::recording;
+
+  const auto path = filesystem::temp_directory_path() /
+      ("fcli-recording-clock-" + to_string(getpid()));
+  ostringstream oss;
+  {
+    Progress progress("Recording", true, oss);
+    VirtualClock clock;
+    progress.set_clock(clock.get_function());
+    progress.set_recorder(make_shared<Recorder>(path));
+    clock.advance(10min);
+    progress.set_text("Recorded");
+  }
+
+  // Time of the last event.
+  ifstream file(path, ios::binary);
+  file.seekg(static_cast<streamoff>(MAGIC.size()));
+  Header header{}, last{};
+  while (file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    last = header;
+    file.seekg(header.payload_size, ios::cur);
+  }
+  filesystem::remove(path);
+  CHECK(last.type == Type::TEXT);
+  CHECK(chrono::nanoseconds(last.nanoseconds) == 10min);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+#include <string>
+
+#include "doctest/doctest.h"
+#include "fcli/progress.hpp"
+#include "fcli/screen.hpp"
+#include "fcli/text.hpp"
+
+using namespace fcli;
+using namespace std;
+
+TEST_CASE("Present only changes") {
+  ostringstream oss;
+  Screen screen(10U, 3U, oss);
+
+  CHECK(screen.draw_text(0U, 0U, "Hello") == 1U);
+  CHECK(screen.present() == oss.str().size());
+  CHECK(oss.str().find("\033[1;1HHello") != string::npos);
+
+  oss.str({});
+  CHECK(screen.present() == 0U);
+  CHECK(oss.str().empty());
+
+  screen.draw_text(1U, 0U, "a");
+  screen.present();
+  CHECK(oss.str() == "\033[1;2Ha");
+
+  // Close changes are joined by rewriting of unchanged cells.
+  oss.str({});
+  screen.draw_text(0U, 0U, "Jelly");
+  screen.present();
+  CHECK(oss.str() == "\033[1;1HJelly");
+
+  oss.str({});
+  screen.invalidate();
+  screen.present();
+  CHECK(oss.str().find("\033[2J") != string::npos);
+}
+
+TEST_CASE("Styles and wide characters") {
+  ostringstream oss;
+  Screen screen(10U, 3U, oss);
+
+  screen.draw_text(0U, 1U, Text::format_copy("<b>B<r>x",
+      Terminal::ColorsSupport::HAS_256_COLORS));
+  CHECK(screen.get_cell(0U, 1U).style != 0U);
+  CHECK(screen.get_cell(1U, 1U).style == 0U);
+  screen.present();
+  CHECK(oss.str().find("\033[1mB\033[0mx") != string::npos);
+
+  CHECK(screen.draw_text(0U, 2U, "日本") == 1U);
+  CHECK(screen.get_cell(0U, 2U).width == 2U);
+  CHECK(screen.get_cell(1U, 2U).width == 0U);
+
+  // Overwritten half of a wide character clears the other one.
+  screen.draw_text(1U, 2U, "a");
+  CHECK(screen.get_cell(0U, 2U) == Screen::Cell());
+
+  // Text is clipped by the maximum width and the screen.
+  screen.draw_text(8U, 0U, "日abc");
+  CHECK(screen.get_cell(8U, 0U).width == 2U);
+  screen.draw_text(0U, 0U, "abcdef", 3U);
+  CHECK(screen.get_cell(2U, 0U).glyph[0] == 'c');
+  CHECK(screen.get_cell(3U, 0U) == Screen::Cell());
+  CHECK_THROWS_AS(static_cast<void>(screen.get_cell(10U, 0U)), out_of_range);
+}
+
+TEST_CASE("Screen modes and progresses") {
+  ostringstream oss;
+  {
+    Screen screen(20U, 2U, oss);
+    screen.set_alternate(true);
+    CHECK(oss.str() == "\033[?1049h\033[?25l");
+
+    Progress progress("abc", false, 20U);
+    CHECK(screen.draw_progress(0U, 1U, progress) == 1U);
+    string row;
+    for (unsigned short x = 0U; x != screen.get_width(); ++x) {
+      const auto& cell = screen.get_cell(x, 1U);
+      row.append(cell.glyph.data(), cell.glyph_size);
+    }
+    CHECK(row.find("abc") != string::npos);
+
+    screen.set_synchronized(true);
+    oss.str({});
+    screen.present();
+    CHECK(oss.str().rfind("\033[?2026h", 0U) == 0U);
+    CHECK(oss.str().find("\033[?2026l") == oss.str().size() - 8U);
+  }
+  CHECK(oss.str().find("\033[?25h\033[?1049l") != string::npos);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "doctest/doctest.h"
+#include "fcli/parallel.hpp"
+#include "fcli/progress.hpp"
+#include "fcli/stage.hpp"
+
+using namespace doctest;
+using namespace fcli;
+using namespace std;
+
+TEST_CASE("Roll-up of weighted stages") {
+  const Stage root;
+  const auto download = root.add_stage(40.0, "download");
+  const auto decompress = root.add_stage(20.0, "decompress");
+  const auto index = root.add_stage(40.0, "index");
+  CHECK(root.get_percents() == Approx(0.0));
+
+  download.set_percents(100.0);
+  CHECK(root.get_percents() == Approx(40.0));
+  CHECK(root.get_active_text() == "download");
+
+  // Nested stages.
+  const auto first = decompress.add_stage(50.0, "first");
+  const auto second = decompress.add_stage(50.0, "second");
+  first.set_percents(100.0);
+  CHECK(decompress.get_percents() == Approx(50.0));
+  CHECK(root.get_percents() == Approx(50.0));
+  CHECK(root.get_active_text() == "first");
+  second.set_percents(50.0);
+  CHECK(root.get_percents() == Approx(55.0));
+  // Percents can decrease.
+  download.set_percents(50.0);
+  CHECK(root.get_percents() == Approx(35.0));
+
+  // Concurrent updates.
+  vector<thread> threads;
+  vector<Stage> parts;
+  for (int i = 0; i != 4; ++i) {
+    parts.push_back(index.add_stage(25.0));
+  }
+  for (const auto& p : parts) {
+    threads.emplace_back([p] {
+      for (int i = 0; i <= 100; ++i) {
+        p.set_percents(i);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  CHECK(index.get_percents() == Approx(100.0));
+  CHECK(root.get_percents() == Approx(75.0));
+
+  {
+    const auto temporary = root.add_stage(0.0, "temporary");
+    temporary.set_text("temporary");
+    CHECK(root.get_active_text() == "temporary");
+  }
+  // Destroyed stage is no longer active.
+  CHECK(root.get_active_text().empty());
+}
+
+TEST_CASE("Progress with stages") {
+  ostringstream oss;
+  Progress progress("parent", true, oss);
+  progress.set_append_dots(false);
+  progress.set_style(Progress::Style::PLAIN, "", {});
+  progress.set_style(Progress::Style::LOADING_BAR, "", {});
+  progress.set_style(Progress::Style::PERCENTS, "", {});
+
+  auto stage = progress.add_stage(50.0, "child");
+  stage = 100.0;
+  CHECK(progress.render_frame().find("50.0%") != string::npos);
+
+  progress.set_stage_text_shown(true);
+  const auto frame = progress.render_frame();
+  CHECK(frame.substr(frame.find('\n')) == "\n   child");
+
+  // Parallel algorithms restore the stages after a run.
+  CHECK(parallel_for(10, [] (int) {}, progress));
+  CHECK(progress.render_frame().find("50.0%") != string::npos);
+
+  Progress other("other", true, oss);
+  other.set_percents_source([] { return 0.0; });
+  CHECK_THROWS_AS(static_cast<void>(other.add_stage(1.0)), logic_error);
+}
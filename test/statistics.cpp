@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#include "doctest/doctest.h"
+#include "fcli/progress.hpp"
+#include "fcli/statistics.hpp"
+#include "fcli/virtual_clock.hpp"
+
+using namespace fcli;
+using namespace std;
+using namespace chrono_literals;
+
+TEST_CASE("Statistics") {
+  const auto before = Statistics::get_snapshot();
+  ostringstream oss;
+  VirtualClock clock;
+  Progress progress("Statistics", true, oss);
+  progress.set_clock(clock.get_function());
+  progress.set_driver(Progress::Driver::EXTERNAL);
+  progress.show();
+
+  for (int i = 0; i != 10; ++i) {
+    progress = i * 10.0;
+    CHECK(progress.step(clock.now()));
+    // Nothing is changed.
+    CHECK_FALSE(progress.step(clock.now()));
+  }
+  progress.finish(true, "Done");
+  constexpr string_view TEXT = "<b>Statistics<r>";
+  [[maybe_unused]] const auto text = Text::format_copy(string(TEXT));
+
+  const auto counters = progress.get_statistics();
+  const auto after = Statistics::get_snapshot();
+  if (!Statistics::is_enabled()) {
+    CHECK(counters.frames_rendered == 0U);
+    CHECK(after.progresses.notifications == 0U);
+    CHECK(after.text.calls == 0U);
+    return;
+  }
+
+  CHECK(counters.frames_rendered == 10U);
+  CHECK(counters.frames_skipped == 10U);
+  CHECK(counters.notifications >= 10U);
+  CHECK(counters.bytes_written == oss.str().length());
+  CHECK(counters.updater_wakeups == 0U);
+  CHECK(counters.lock_time.count() > 0);
+
+  CHECK(after.progresses.frames_rendered >=
+      before.progresses.frames_rendered + 10U);
+  CHECK(after.text.calls > before.text.calls);
+  CHECK(after.text.bytes_in >= before.text.bytes_in + TEXT.length());
+
+  atomic<unsigned> dumps{};
+  Statistics::set_dump_handler(
+      [&dumps] (const Statistics::Snapshot&) { ++dumps; }, 1ms);
+  while (dumps < 2U) {
+    this_thread::yield();
+  }
+  Statistics::set_dump_handler({});
+  const auto stopped = dumps.load();
+  this_thread::sleep_for(10ms);
+  CHECK(dumps == stopped);
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "doctest/doctest.h"
+#include "fcli/table.hpp"
+
+using namespace fcli;
+using namespace std;
+
+TEST_CASE("Table alignment") {
+  ostringstream stream;
+  {
+    Table table({
+      {"Name", {}, Table::Alignment::LEFT, 0U, 0U},
+      {"Size", {}, Table::Alignment::RIGHT, 0U, 0U},
+      {"State", {}, Table::Alignment::CENTER, 0U, 0U}
+    }, stream, {});
+    table.set_separator(" | ");
+    table.add_row({"a", "1", "ok"});
+    table.add_row(vector<string>{"long name", "1024", "failed"});
+    // Missing cells are empty.
+    table.add_row({"b"});
+    CHECK_THROWS_AS(table.add_row({"1", "2", "3", "4"}), out_of_range);
+    CHECK(stream.str().empty());
+  }
+  CHECK(stream.str() ==
+      "Name      | Size | State\n"
+      "a         |    1 |   ok\n"
+      "long name | 1024 | failed\n"
+      "b         |      | \n");
+}
+
+TEST_CASE("Table widths") {
+  ostringstream stream;
+  Table table({
+    {{}, "<b>", Table::Alignment::LEFT, 3U, 0U},
+    {{}, {}, Table::Alignment::LEFT, 0U, 4U},
+    {{}, {}, Table::Alignment::LEFT, 0U, 0U}
+  }, stream, Terminal::ColorsSupport::HAS_8_COLORS);
+  table.set_look_ahead(2U);
+
+  // Specifiers and escape sequences take no space.
+  table.add_row({"~r~x<r>", "中文字", "-"});
+  CHECK(stream.str().empty());
+  table.add_row({"y", "abcdef", "-"});
+  table.flush();
+  CHECK(stream.str() ==
+      "\033[1m\033[31mx\033[0m\033[0m    中文  -\n"
+      "\033[1my\033[0m    abcd  -\n");
+  CHECK(table.get_widths() == vector<size_t>{3U, 4U, 1U});
+
+  // The next window widens the column, but never narrows it.
+  const auto printed = stream.str().size();
+  table.add_row({"wide", "", "-"});
+  table.add_row({"z", "", "-"});
+  table.flush();
+  CHECK(table.get_widths() == vector<size_t>{4U, 4U, 1U});
+  CHECK(table.get_rows_count() == 4U);
+  CHECK(stream.str().substr(printed) ==
+      "\033[1mwide\033[0m        -\n"
+      "\033[1mz\033[0m           -\n");
+}
+
+TEST_CASE("Table streaming") {
+  ostringstream stream;
+  Table table({{"#", {}, Table::Alignment::RIGHT, 0U, 0U}}, stream, {});
+  table.set_look_ahead(10U);
+
+  const string row(100U, 'x');
+  size_t rows = 0U;
+  while (stream.str().empty()) {
+    table.add_row({row});
+    ++rows;
+  }
+  // Printed rows are written in large chunks.
+  CHECK(stream.str().size() >= Table::BUFFER_SIZE);
+  CHECK(rows % 10U == 0U);
+  table.flush();
+  CHECK(stream.str().size() == (rows + 1U) * (row.size() + 1U));
+}
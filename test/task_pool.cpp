@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "doctest/doctest.h"
+#include "fcli/task_pool.hpp"
+
+using namespace fcli;
+using namespace std;
+
+TEST_CASE("Tasks execution") {
+  ostringstream oss;
+  {
+    TaskPool pool(40U, oss, 3U);
+    REQUIRE(pool.get_workers_count() == 3U);
+    pool.get_overall().set_style(Progress::Style::PLAIN, "", {});
+    pool.get_overall().set_style(Progress::Style::SUCCESS_SYMBOL, "", {});
+    pool.get_overall().set_style(Progress::Style::FAILURE_SYMBOL, "", {});
+
+    for (int i = 0; i != 10; ++i) {
+      pool.submit("task " + to_string(i), [i] (TaskPool::Handle& handle) {
+        handle.set_percents(50.0);
+        if (i == 3) {
+          throw runtime_error("error");
+        }
+        if (i == 5) {
+          handle.set_result_message("custom");
+        }
+      });
+    }
+    CHECK(pool.wait() == 1U);
+
+    pool.submit("next", [] (TaskPool::Handle&) {});
+    // Destructor must wait for the task.
+  }
+
+  const auto output = oss.str();
+  CHECK(output.find(" + task 0\n") != string::npos);
+  CHECK(output.find(" - task 3: error\n") != string::npos);
+  CHECK(output.find(" + custom\n") != string::npos);
+  CHECK(output.find(" + next\n") != string::npos);
+}
+
+TEST_CASE("Submit while waiting") {
+  ostringstream oss;
+  TaskPool pool(40U, oss, 2U);
+  thread submitter([&pool] {
+    for (int i = 0; i != 200; ++i) {
+      pool.submit("task", [] (TaskPool::Handle&) {});
+    }
+  });
+  for (int i = 0; i != 200; ++i) {
+    CHECK(pool.wait() == 0U);
+  }
+  submitter.join();
+  CHECK(pool.wait() == 0U);
+}
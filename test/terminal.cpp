@@ -15,10 +15,28 @@
  * limitations under the License.
  */
 
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
 #include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <poll.h>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 
 #include "doctest/doctest.h"
+#include "fcli/progress.hpp"
 #include "fcli/terminal.hpp"
 
 using namespace fcli;
@@ -28,6 +46,7 @@ TEST_CASE("get_width throws exception") {
   // Pass invalid file descriptor.
   Terminal term(-1);
   CHECK_THROWS_AS(static_cast<void>(term.get_width()), runtime_error);
+  CHECK_THROWS_AS(static_cast<void>(term.get_height()), runtime_error);
 }
 
 TEST_CASE("Detect colors support") {
@@ -45,3 +64,247 @@ TEST_CASE("Detect colors support") {
   unsetenv("TERM");
   CHECK_NOTHROW(Terminal());
 }
+
+TEST_CASE("Persistent profiles") {
+  const auto directory = filesystem::temp_directory_path() /
+      ("fcli-cache-" + to_string(getpid()));
+  setenv("XDG_CACHE_HOME", directory.c_str(), 1);
+  setenv("COLORTERM", "truecolor", 1);
+
+  const Terminal term("fcli-profile-test");
+  CHECK_FALSE(term.load_profile().has_value());
+  const auto detected = term.get_profile();
+  CHECK(detected.direct_color);
+  REQUIRE(term.load_profile().has_value());
+
+  Terminal::Profile profile;
+  profile.colors_support = Terminal::ColorsSupport::HAS_256_COLORS;
+  profile.theme = Theme::Name::ARCTIC_DARK;
+  profile.quirks = 5U;
+  term.store_profile(profile);
+  const auto loaded = term.load_profile();
+  REQUIRE(loaded.has_value());
+  CHECK(loaded->colors_support == profile.colors_support);
+  CHECK_FALSE(loaded->direct_color);
+  CHECK(loaded->theme == Theme::Name::ARCTIC_DARK);
+  CHECK(loaded->quirks == 5U);
+  CHECK(term.get_profile().quirks == 5U);
+
+  // The user palette isn't replaced by a theme.
+  const auto theme = Theme::get_theme();
+  auto palette = Theme::get_palette(Theme::Name::MATERIAL_DARK);
+  palette.red.code = 1U;
+  Theme::set_pallete(palette);
+  profile.theme = Theme::get_theme();
+  term.store_profile(profile);
+  const auto user = term.load_profile();
+  REQUIRE(user.has_value());
+  CHECK(user->theme == Theme::Name::_USER);
+  Terminal::apply_profile(*user);
+  CHECK(Theme::get_theme() == Theme::Name::_USER);
+  CHECK(Theme::get_palette().red.code == 1U);
+  Theme::set_theme(theme);
+
+  // Identity includes the variables.
+  setenv("COLORTERM", "", 1);
+  CHECK_FALSE(term.load_profile().has_value());
+  setenv("COLORTERM", "truecolor", 1);
+
+  // Another version stamp.
+  const auto path = *filesystem::directory_iterator(directory / "fcli");
+  fstream file(path.path(), ios::in | ios::out | ios::binary);
+  file.seekp(4);
+  file.put('\x7f');
+  file.close();
+  CHECK_FALSE(term.load_profile().has_value());
+
+  filesystem::remove_all(directory);
+  unsetenv("XDG_CACHE_HOME");
+  unsetenv("COLORTERM");
+}
+
+TEST_CASE("Terminal query") {
+  using namespace chrono_literals;
+
+  auto result = Terminal::parse_replies("typed\033]11;rgb:ffff/ffff/f0f0\a"
+      "\033[?2026;2$y\033P>|kitty(0.26.5)\033\\\033[?62;22c");
+  REQUIRE(result.background_luma.has_value());
+  CHECK(*result.background_luma > 0.9);
+  CHECK(result.version == "kitty(0.26.5)");
+  CHECK(result.direct_color);
+  CHECK(result.device_attributes == vector{62, 22});
+  CHECK(result.suggest_theme(Terminal::ColorsSupport::HAS_256_COLORS) ==
+      Theme::Name::MATERIAL_LIGHT);
+  CHECK(result.suggest_theme(Terminal::ColorsSupport::HAS_8_COLORS) ==
+      Theme::Name::DEFAULT);
+  result = Terminal::parse_replies("\033]11;rgb:10/20/30\033\\");
+  CHECK(*result.background_luma < 0.2);
+  CHECK(result.device_attributes.empty());
+
+  // Not a terminal.
+  array<int, 2> pipe_file_descs{};
+  REQUIRE(pipe(pipe_file_descs.data()) == 0);
+  CHECK_FALSE(Terminal(pipe_file_descs[1]).query(pipe_file_descs[0], 1s)
+      .background_luma.has_value());
+  close(pipe_file_descs[0]);
+  close(pipe_file_descs[1]);
+
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  REQUIRE(master >= 0);
+  REQUIRE(grantpt(master) == 0);
+  REQUIRE(unlockpt(master) == 0);
+  const int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  REQUIRE(slave >= 0);
+  const Terminal terminal(slave, "xterm");
+
+  // Emulator that answers after all requests are received.
+  thread emulator([master] {
+    string requests;
+    array<char, 64U> buffer{};
+    while (requests.find("\033[c") == string::npos) {
+      const auto size = read(master, buffer.data(), buffer.size());
+      REQUIRE(size > 0);
+      requests.append(buffer.data(), static_cast<size_t>(size));
+    }
+    const string_view replies = "\033]11;rgb:0000/0000/0000\033\\"
+        "\033P>|XTerm(367)\033\\\033[?64;1;22c";
+    REQUIRE(write(master, replies.data(), replies.size()) ==
+        static_cast<ssize_t>(replies.size()));
+  });
+  result = terminal.query_async(slave, 5s).get();
+  emulator.join();
+  CHECK(result.background_luma == 0.0);
+  CHECK(result.version == "XTerm(367)");
+  CHECK(result.device_attributes == vector{64, 1, 22});
+  CHECK(result.suggest_theme(Terminal::ColorsSupport::HAS_256_COLORS) ==
+      Theme::Name::MATERIAL_DARK);
+
+  // Nobody answers.
+  const auto start = chrono::steady_clock::now();
+  result = terminal.query(slave, 20ms);
+  CHECK(chrono::steady_clock::now() - start < 1s);
+  CHECK(result.device_attributes.empty());
+
+  // Timeout isn't extended by incomplete replies, which are dropped.
+  thread slow_emulator([master] {
+    string requests;
+    array<char, 64U> buffer{};
+    while (requests.find("\033[c") == string::npos) {
+      const auto size = read(master, buffer.data(), buffer.size());
+      REQUIRE(size > 0);
+      requests.append(buffer.data(), static_cast<size_t>(size));
+    }
+    const string_view reply = "\033[?62";
+    REQUIRE(write(master, reply.data(), reply.size()) ==
+        static_cast<ssize_t>(reply.size()));
+  });
+  const auto slow_start = chrono::steady_clock::now();
+  result = terminal.query(slave, 20ms);
+  CHECK(chrono::steady_clock::now() - slow_start < 100ms);
+  slow_emulator.join();
+  CHECK(result.device_attributes.empty());
+  pollfd poll_file_desc{slave, POLLIN, 0};
+  CHECK(poll(&poll_file_desc, 1U, 0) == 0);
+  close(slave);
+  close(master);
+}
+
+TEST_CASE("Cached width") {
+  using namespace chrono_literals;
+
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  REQUIRE(master >= 0);
+  REQUIRE(grantpt(master) == 0);
+  REQUIRE(unlockpt(master) == 0);
+  const int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+  REQUIRE(slave >= 0);
+
+  const auto resize = [slave] (unsigned short columns) {
+    struct winsize size{};
+    size.ws_col = columns;
+    REQUIRE(ioctl(slave, TIOCSWINSZ, &size) == 0);
+    // Terminal isn't controlling, so emulate the notification.
+    raise(SIGWINCH);
+  };
+  resize(80U);
+  Terminal::watch_width(slave);
+  CHECK(Terminal::get_cached_width() == 80U);
+
+  // Listeners are called in order of subscription, so
+  // the progress gets new width before the test listener.
+  Progress progress({}, true, numeric_limits<unsigned short>::max());
+  progress.set_auto_width(true);
+  CHECK(progress.is_auto_width());
+  CHECK(progress.get_width() == 80U);
+
+  // Frames of it are drawn by the test.
+  ostringstream oss;
+  Progress drawn({}, true, oss);
+  drawn.set_driver(Progress::Driver::EXTERNAL);
+  drawn.set_auto_width(true);
+  drawn.show();
+  const auto draw = [&oss, &drawn] {
+    oss.str({});
+    drawn.render_once(chrono::steady_clock::now());
+    return oss.str();
+  };
+
+  mutex mut;
+  condition_variable cv;
+  unsigned short notified_width = 0U;
+  const auto id = Terminal::subscribe_width(
+      [&] (unsigned short width) {
+    lock_guard lock(mut);
+    notified_width = width;
+    cv.notify_one();
+  });
+  const auto wait_for_width = [&] (unsigned short width) {
+    unique_lock lock(mut);
+    return cv.wait_for(lock, 1s, [&] { return notified_width == width; });
+  };
+
+  resize(120U);
+  CHECK(wait_for_width(120U));
+  CHECK(Terminal::get_cached_width() == 120U);
+  // Width is limited by progress.
+  CHECK(progress.get_width() == 100U);
+  static_cast<void>(draw());
+  resize(50U);
+  CHECK(wait_for_width(50U));
+  CHECK(progress.get_width() == 50U);
+
+  // The printed line of 100 columns is wrapped into two rows.
+  constexpr string_view CLEAR_ROWS = "\r\033[2K\033[1A\r\033[2K";
+  const auto output = draw();
+  CHECK(output.substr(0U, CLEAR_ROWS.size()) == CLEAR_ROWS);
+  CHECK(output.find("\033[1A", CLEAR_ROWS.size()) == string::npos);
+  // Frame isn't drawn while it can't fit the terminal.
+  resize(5U);
+  CHECK(wait_for_width(5U));
+  // The line of 50 columns is wrapped into ten rows.
+  string erase = "\r\033[2K";
+  for (int i = 0; i != 9; ++i) {
+    erase += "\033[1A\r\033[2K";
+  }
+  CHECK(draw() == erase);
+  CHECK(draw().empty());
+  // Deadline of externally driven frames moves while the terminal is narrow.
+  const auto later = chrono::steady_clock::now() + 2h;
+  drawn.render_once(later);
+  CHECK(drawn.next_deadline() > later);
+  CHECK_FALSE(drawn.step(later));
+  resize(50U);
+  CHECK(wait_for_width(50U));
+  CHECK(draw().find("\033[1A") == string::npos);
+  progress.set_auto_width(false);
+  resize(60U);
+  CHECK(wait_for_width(60U));
+  CHECK(progress.get_width() == 50U);
+
+  Terminal::unsubscribe_width(id);
+  Terminal::watch_width(-1);
+  CHECK(Terminal::get_cached_width() == 0U);
+  close(slave);
+  close(master);
+  Terminal::watch_width();
+}
@@ -36,3 +36,23 @@ TEST_CASE("Format string") {
   Text::set_message_prefix(Text::Message::ERROR, "prefix ");
   CHECK("test"_err == "prefix test");
 }
+
+TEST_CASE("Visible width") {
+  CHECK(Text::visible_width("") == 0U);
+  CHECK(Text::visible_width("plain ASCII text that is longer than a block")
+      == 44U);
+  // Escape sequences and control characters.
+  CHECK(Text::visible_width("\033[1;31mred\033[0m\t\033]0;title\a!") == 4U);
+  // Combining acute accent, CJK and emoji.
+  CHECK(Text::visible_width("e\u0301\u4E2D\u6587\U0001F600") == 7U);
+  // Each invalid byte is shown as the replacement character.
+  CHECK(Text::visible_width("\xFF\xC0\x80") == 3U);
+
+  CHECK(Text::truncate_to_width("abcdef", 3U) == "abc");
+  CHECK(Text::truncate_to_width("abc", 5U) == "abc");
+  // Wide character isn't split.
+  CHECK(Text::truncate_to_width("a\u4E2D", 2U) == "a");
+  // Combining characters and escape sequences stay with the prefix.
+  CHECK(Text::truncate_to_width("e\u0301\033[0mx", 1U) == "e\u0301\033[0m");
+  CHECK(Text::truncate_to_width("\u00E9\u00E9", 1U) == "\u00E9");
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "doctest/doctest.h"
+#include "fcli/transfer.hpp"
+
+using namespace fcli;
+using namespace std;
+
+TEST_CASE("Size formatting") {
+  CHECK(format_size(0U) == "0 B");
+  CHECK(format_size(1023U) == "1023 B");
+  CHECK(format_size(1024U) == "1.0 KiB");
+  CHECK(format_size(1536U) == "1.5 KiB");
+  CHECK(format_size(5U * 1024U * 1024U) == "5.0 MiB");
+}
+
+TEST_CASE("File copying") {
+  const auto directory = filesystem::temp_directory_path() /
+      ("fcli-transfer-" + to_string(getpid()));
+  filesystem::create_directories(directory);
+  const auto from = directory / "from", to = directory / "to";
+
+  string content;
+  for (int i = 0; content.size() < 3U * 1024U * 1024U; ++i) {
+    content += to_string(i) + '\n';
+  }
+  ofstream(from, ios::binary) << content;
+
+  ostringstream oss;
+  Progress progress("Copying", false, oss);
+  CHECK(copy_file(from, to, progress) == content.size());
+  CHECK(progress.is_determined());
+  CHECK(progress.get_percents() == doctest::Approx(100.0));
+  // Text isn't extended again by the next copying.
+  CHECK(copy_file(from, to, progress) == content.size());
+  CHECK(progress.get_text() == "Copying");
+
+  ifstream copy(to, ios::binary);
+  CHECK(string(istreambuf_iterator<char>(copy), {}) == content);
+
+  CHECK_THROWS_AS(copy_file(directory / "missing", to, progress),
+      filesystem::filesystem_error);
+  filesystem::remove_all(directory);
+}
+
+TEST_CASE("Byte progress") {
+  ostringstream oss;
+  Progress progress("Sending", false, oss);
+  {
+    ByteProgress byte_progress(progress, 10U);
+    byte_progress.add(10U);
+    CHECK(progress.get_text().rfind("Sending (10 B / 10 B", 0U) == 0U);
+    CHECK(progress.get_percents() == doctest::Approx(100.0));
+  }
+  CHECK(progress.get_text() == "Sending");
+}
+
+TEST_CASE("Stream buffer") {
+  ostringstream oss;
+  Progress progress("Writing", false, oss);
+  const string large(100U * 1024U, 'x');
+
+  stringbuf storage;
+  {
+    ProgressStreambuf buffer(storage, progress, 2U + large.size());
+    ostream stream(&buffer);
+    stream << 'a';
+    stream.write(large.data(), static_cast<streamsize>(large.size()));
+    stream << 'b';
+    stream.flush();
+    CHECK(buffer.get_bytes() == large.size() + 2U);
+  }
+  CHECK(storage.str() == 'a' + large + 'b');
+  CHECK(progress.get_percents() == doctest::Approx(100.0));
+
+  progress.set_text("Reading");
+  ProgressStreambuf buffer(storage, progress);
+  istream stream(&buffer);
+  CHECK(stream.get() == 'a');
+  string read(large.size(), '\0');
+  stream.read(read.data(), static_cast<streamsize>(read.size()));
+  CHECK(read == large);
+  CHECK(stream.get() == 'b');
+  CHECK(stream.get() == char_traits<char>::eof());
+  CHECK(buffer.get_bytes() == large.size() + 2U);
+  CHECK_FALSE(progress.is_determined());
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright © 2021 Nikita Dudko. All rights reserved.
+ * Contacts: <nikita.dudko.95@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Displays progresses that are published by the Exporter class.
+ * Usage: fcli-top [-1] [FILE]...
+ * Without files, all default files of the shared memory directory are read.
+ * The -1 option prints progresses once instead of refreshing them.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fcli/exporter.hpp"
+#include "fcli/progress.hpp"
+#include "fcli/terminal.hpp"
+#include "fcli/text.hpp"
+
+using namespace fcli;
+using namespace std;
+using namespace chrono_literals;
+
+namespace {
+  constexpr auto REFRESH_INTERVAL = 500ms;
+  constexpr unsigned short DEFAULT_WIDTH = 80U;
+
+  auto find_files() -> vector<string> {
+    const filesystem::path prefix(Exporter::DEFAULT_PATH_PREFIX);
+    const auto name_prefix = prefix.filename().string();
+    vector<string> files;
+    error_code error;
+
+    for (const auto& entry :
+        filesystem::directory_iterator(prefix.parent_path(), error)) {
+      if (entry.path().filename().string().rfind(name_prefix, 0U) == 0U) {
+        files.push_back(entry.path().string());
+      }
+    }
+    sort(files.begin(), files.end());
+    return files;
+  }
+
+  auto format_state(Progress::State state) -> string {
+    switch (state) {
+      case Progress::State::RUNNING:
+        return "~b~running<r>";
+      case Progress::State::SUCCEEDED:
+        return "~g~done<r>   ";
+      case Progress::State::FAILED:
+        return "~r~failed<r> ";
+    }
+    return {};
+  }
+
+  auto draw(const vector<string>& files, unsigned short width) -> string {
+    ostringstream oss;
+    oss << Text::format_copy("<b>    PID STATE    RATE/S PROGRESS<r>\n");
+    constexpr size_t PREFIX_SIZE = 25U;
+    const auto progress_width = static_cast<unsigned short>(max<int>(
+        width - static_cast<int>(PREFIX_SIZE), Progress().get_width()));
+
+    for (const auto& file : files) {
+      vector<Exporter::Record> records;
+      try {
+        records = Exporter::read(file);
+      } catch (const exception& e) {
+        oss << Text::format_message(Text::Message::WARNING,
+            file + ": " + e.what()) << '\n';
+        continue;
+      }
+
+      for (const auto& r : records) {
+        Progress progress(r.text, r.determined, progress_width);
+        progress.set_append_dots(false);
+        progress.set_percents(r.percents);
+
+        oss << setw(7) << r.pid << ' ' << Text::format_copy(
+            format_state(r.state)) << ' ' << fixed << setprecision(2) <<
+            setw(7) << r.rate << "% " << progress.render_frame() <<
+            Text::format_copy("<r>") << '\n';
+      }
+    }
+    return oss.str();
+  }
+} // Namespace.
+
+auto main(int argc, char* argv[]) -> int {
+  bool once = false;
+  vector<string> files;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-1") == 0) {
+      once = true;
+    } else {
+      files.emplace_back(argv[i]);
+    }
+  }
+
+  const Terminal terminal;
+  if (const auto colors = terminal.find_out_supported_colors()) {
+    Terminal::cache_colors_support(*colors);
+  }
+
+  while (true) {
+    auto width = Terminal::get_cached_width();
+    if (width == 0U) {
+      width = DEFAULT_WIDTH;
+    }
+
+    const auto output = draw(files.empty() ? find_files() : files, width);
+    if (once) {
+      cout << output << flush;
+      return 0;
+    }
+    // Move cursor home and clear the screen.
+    cout << "\033[H\033[2J" << output << flush;
+    this_thread::sleep_for(REFRESH_INTERVAL);
+  }
+}